@@ -269,6 +269,11 @@ struct _GdkWindow
 
   GdkFrameClock *frame_clock; /* NULL to use from parent or default */
   GdkWindowInvalidateHandlerFunc invalidate_handler;
+
+  GdkWindowRenderFunc render_func;
+  gpointer render_data;
+  GDestroyNotify render_data_destroy;
+  gpointer render_job; /* GdkWindowRenderJob being rendered */
 };
 
 #define GDK_WINDOW_TYPE(d) ((((GdkWindow *)(d)))->window_type)
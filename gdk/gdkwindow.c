@@ -483,6 +483,9 @@ gdk_window_finalize (GObject *object)
 
   gdk_window_drop_cairo_surface (window);
 
+  if (window->render_data_destroy)
+    window->render_data_destroy (window->render_data);
+
   if (window->impl)
     {
       g_object_unref (window->impl);
@@ -3328,6 +3331,216 @@ gdk_window_schedule_update (GdkWindow *window)
                                    GDK_FRAME_CLOCK_PHASE_PAINT);
 }
 
+/* Windows with a render function get the area they need to paint
+ * split into tiles of this size, which are drawn in parallel */
+#define RENDER_TILE_SIZE 128
+
+typedef struct _GdkWindowRenderJob GdkWindowRenderJob;
+typedef struct _GdkWindowRenderTile GdkWindowRenderTile;
+
+struct _GdkWindowRenderJob {
+  GdkWindow *window;
+  GdkWindowRenderFunc func;
+  gpointer user_data;
+
+  GdkWindowRenderTile *tiles;
+  guint n_tiles;
+
+  GMutex lock;
+  GCond done;
+  guint n_pending;
+};
+
+struct _GdkWindowRenderTile {
+  GdkWindowRenderJob *job;
+  cairo_region_t *region;       /* in window coordinates */
+  cairo_rectangle_int_t area;   /* extents of region */
+  cairo_surface_t *surface;     /* NULL if not rendered by a worker */
+};
+
+static GThreadPool *render_pool = NULL;
+
+static void
+gdk_window_render_tile (GdkWindowRenderTile *tile,
+                        cairo_t             *cr)
+{
+  gdk_cairo_region (cr, tile->region);
+  cairo_clip (cr);
+
+  tile->job->func (tile->job->window, cr, tile->job->user_data);
+}
+
+/* Runs in a worker thread, so must not use anything but cairo */
+static void
+gdk_window_render_tile_thread (gpointer data,
+                               gpointer unused)
+{
+  GdkWindowRenderTile *tile = data;
+  GdkWindowRenderJob *job = tile->job;
+  cairo_t *cr;
+
+  cr = cairo_create (tile->surface);
+  cairo_translate (cr, -tile->area.x, -tile->area.y);
+  gdk_window_render_tile (tile, cr);
+  cairo_destroy (cr);
+
+  g_mutex_lock (&job->lock);
+  job->n_pending--;
+  if (job->n_pending == 0)
+    g_cond_signal (&job->done);
+  g_mutex_unlock (&job->lock);
+}
+
+static GThreadPool *
+gdk_window_get_render_pool (void)
+{
+  guint n_threads;
+
+  if (render_pool == NULL)
+    {
+      n_threads = g_get_num_processors ();
+      if (n_threads > 1)
+        render_pool = g_thread_pool_new (gdk_window_render_tile_thread,
+                                         NULL,
+                                         n_threads,
+                                         FALSE,
+                                         NULL);
+    }
+
+  return render_pool;
+}
+
+/* Splits @region of @window into tiles and, if there is more than
+ * one, starts rendering them with the render function on the worker
+ * pool. The workers run while the expose event gets handled. */
+static GdkWindowRenderJob *
+gdk_window_render_begin (GdkWindow      *window,
+                         cairo_region_t *region)
+{
+  GdkWindowRenderJob *job;
+  GdkRectangle extents;
+  GThreadPool *pool;
+  guint i, n_tiles;
+  int x, y;
+
+  job = g_slice_new0 (GdkWindowRenderJob);
+  job->window = g_object_ref (window);
+  job->func = window->render_func;
+  job->user_data = window->render_data;
+  g_mutex_init (&job->lock);
+  g_cond_init (&job->done);
+
+  cairo_region_get_extents (region, &extents);
+
+  n_tiles = ((extents.width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE) *
+            ((extents.height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE);
+  job->tiles = g_new0 (GdkWindowRenderTile, MAX (n_tiles, 1));
+
+  for (y = extents.y; y < extents.y + extents.height; y += RENDER_TILE_SIZE)
+    for (x = extents.x; x < extents.x + extents.width; x += RENDER_TILE_SIZE)
+      {
+        GdkWindowRenderTile *tile = &job->tiles[job->n_tiles];
+        cairo_rectangle_int_t r;
+
+        r.x = x;
+        r.y = y;
+        r.width = MIN (RENDER_TILE_SIZE, extents.x + extents.width - x);
+        r.height = MIN (RENDER_TILE_SIZE, extents.y + extents.height - y);
+
+        tile->job = job;
+        tile->region = cairo_region_copy (region);
+        cairo_region_intersect_rectangle (tile->region, &r);
+        if (cairo_region_is_empty (tile->region))
+          {
+            cairo_region_destroy (tile->region);
+            continue;
+          }
+        cairo_region_get_extents (tile->region, &tile->area);
+
+        job->n_tiles++;
+      }
+
+  window->render_job = job;
+
+  pool = job->n_tiles > 1 ? gdk_window_get_render_pool () : NULL;
+  if (pool == NULL)
+    return job;
+
+  job->n_pending = job->n_tiles;
+  for (i = 0; i < job->n_tiles; i++)
+    {
+      job->tiles[i].surface =
+        gdk_window_create_similar_image_surface (window,
+                                                 CAIRO_FORMAT_ARGB32,
+                                                 job->tiles[i].area.width,
+                                                 job->tiles[i].area.height,
+                                                 0);
+      g_thread_pool_push (pool, &job->tiles[i], NULL);
+    }
+
+  return job;
+}
+
+static void
+gdk_window_render_wait (GdkWindowRenderJob *job)
+{
+  g_mutex_lock (&job->lock);
+  while (job->n_pending > 0)
+    g_cond_wait (&job->done, &job->lock);
+  g_mutex_unlock (&job->lock);
+}
+
+/* Waits for the workers of @job and composites their results onto
+ * the window, rendering tiles that had no worker directly. */
+static void
+gdk_window_render_finish (GdkWindowRenderJob *job)
+{
+  cairo_t *cr;
+  guint i;
+
+  gdk_window_render_wait (job);
+  job->window->render_job = NULL;
+
+  if (!job->window->destroyed)
+    cr = gdk_cairo_create (job->window);
+  else
+    cr = NULL;
+
+  for (i = 0; i < job->n_tiles; i++)
+    {
+      GdkWindowRenderTile *tile = &job->tiles[i];
+
+      if (cr)
+        {
+          cairo_save (cr);
+          if (tile->surface)
+            {
+              gdk_cairo_region (cr, tile->region);
+              cairo_clip (cr);
+              cairo_set_source_surface (cr, tile->surface,
+                                        tile->area.x, tile->area.y);
+              cairo_paint (cr);
+            }
+          else if (job->func)
+            gdk_window_render_tile (tile, cr);
+          cairo_restore (cr);
+        }
+
+      if (tile->surface)
+        cairo_surface_destroy (tile->surface);
+      cairo_region_destroy (tile->region);
+    }
+
+  if (cr)
+    cairo_destroy (cr);
+
+  g_mutex_clear (&job->lock);
+  g_cond_clear (&job->done);
+  g_object_unref (job->window);
+  g_free (job->tiles);
+  g_slice_free (GdkWindowRenderJob, job);
+}
+
 static void
 _gdk_window_process_updates_recurse_helper (GdkWindow *window,
                                             cairo_region_t *expose_region,
@@ -3335,6 +3548,7 @@ _gdk_window_process_updates_recurse_helper (GdkWindow *window,
 {
   GdkWindow *child;
   cairo_region_t *clipped_expose_region;
+  GdkWindowRenderJob *render_job = NULL;
   GdkRectangle clip_box;
   GList *l, *children;
 
@@ -3362,6 +3576,9 @@ _gdk_window_process_updates_recurse_helper (GdkWindow *window,
 
   /* Paint the window before the children, clipped to the window region */
 
+  if (window->render_func)
+    render_job = gdk_window_render_begin (window, clipped_expose_region);
+
   /* While gtk+ no longer handles exposes on anything but native
      window we still have to send them to all windows that have the
      event mask set for backwards compat. We also need to send
@@ -3384,6 +3601,9 @@ _gdk_window_process_updates_recurse_helper (GdkWindow *window,
       g_object_unref (window);
     }
 
+  if (render_job)
+    gdk_window_render_finish (render_job);
+
   /* Make this reentrancy safe for expose handlers freeing windows */
   children = g_list_copy (window->children);
   g_list_foreach (children, (GFunc)g_object_ref, NULL);
@@ -3794,6 +4014,54 @@ gdk_window_set_invalidate_handler (GdkWindow                      *window,
   window->invalidate_handler = handler;
 }
 
+/**
+ * gdk_window_set_render_func:
+ * @window: a #GdkWindow
+ * @func: (allow-none): a #GdkWindowRenderFunc, or %NULL to unset it
+ * @user_data: data to pass to @func
+ * @notify: (allow-none): function to free @user_data when it is
+ *   no longer needed, or %NULL
+ *
+ * Sets a function that draws the contents of @window. Whenever a
+ * part of @window gets exposed, @func is called after the expose
+ * event for @window has been handled and draws on top of whatever
+ * the event handler drew, but below any child windows.
+ *
+ * Large exposed areas are split into tiles, and the tiles are drawn
+ * in parallel on a pool of worker threads, one per processor. The
+ * results are composited onto @window before painting the frame
+ * finishes. So @func must be safe to call from any thread, see
+ * #GdkWindowRenderFunc.
+ *
+ * Since: 3.10
+ **/
+void
+gdk_window_set_render_func (GdkWindow           *window,
+                            GdkWindowRenderFunc  func,
+                            gpointer             user_data,
+                            GDestroyNotify       notify)
+{
+  g_return_if_fail (GDK_IS_WINDOW (window));
+
+  /* Called from an expose handler, don't free data the workers use */
+  if (window->render_job)
+    {
+      GdkWindowRenderJob *job = window->render_job;
+
+      gdk_window_render_wait (job);
+      job->func = NULL;
+    }
+
+  if (window->render_data_destroy)
+    window->render_data_destroy (window->render_data);
+
+  window->render_func = func;
+  window->render_data = user_data;
+  window->render_data_destroy = notify;
+
+  gdk_window_invalidate_rect (window, NULL, FALSE);
+}
+
 static void
 draw_ugly_color (GdkWindow       *window,
 		 const cairo_region_t *region)
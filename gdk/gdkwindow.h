@@ -699,6 +699,28 @@ GDK_AVAILABLE_IN_3_10
 void gdk_window_set_invalidate_handler (GdkWindow                      *window,
 					GdkWindowInvalidateHandlerFunc  handler);
 
+/**
+ * GdkWindowRenderFunc:
+ * @window: the #GdkWindow being rendered
+ * @cr: a cairo context to draw with, in the coordinate space of @window
+ * @user_data: user data passed to gdk_window_set_render_func()
+ *
+ * Draws part of @window. This function may be called from a thread
+ * other than the main thread and concurrently with itself, so it must
+ * not use any GDK or GTK+ API or touch data that the main thread may
+ * modify while drawing.
+ *
+ * Since: 3.10
+ */
+typedef void (*GdkWindowRenderFunc) (GdkWindow *window,
+                                     cairo_t   *cr,
+                                     gpointer   user_data);
+GDK_AVAILABLE_IN_3_10
+void gdk_window_set_render_func (GdkWindow           *window,
+                                 GdkWindowRenderFunc  func,
+                                 gpointer             user_data,
+                                 GDestroyNotify       notify);
+
 GDK_AVAILABLE_IN_ALL
 gboolean      gdk_window_has_native         (GdkWindow       *window);
 GDK_AVAILABLE_IN_ALL
@@ -3620,6 +3620,33 @@ gtk_cell_area_request_renderer (GtkCellArea        *area,
   *natural_size += focus_line_width;
 }
 
+/* Returns the model column that the "text" property of @renderer is
+ * mapped to, or -1 if @renderer gets any other attributes, has a data
+ * function, or @area has ::apply-attributes handlers that may set it
+ * up differently.
+ */
+gint
+_gtk_cell_area_get_text_column (GtkCellArea     *area,
+                                GtkCellRenderer *renderer)
+{
+  CellInfo      *info;
+  CellAttribute *attribute;
+
+  if (g_signal_has_handler_pending (area, cell_area_signals[SIGNAL_APPLY_ATTRIBUTES], 0, FALSE))
+    return -1;
+
+  info = g_hash_table_lookup (area->priv->cell_info, renderer);
+  if (info == NULL || info->func != NULL ||
+      info->attributes == NULL || info->attributes->next != NULL)
+    return -1;
+
+  attribute = info->attributes->data;
+  if (strcmp (attribute->attribute, "text") != 0)
+    return -1;
+
+  return attribute->column;
+}
+
 void
 _gtk_cell_area_set_cell_data_func_with_proxy (GtkCellArea           *area,
 					      GtkCellRenderer       *cell,
@@ -524,6 +524,9 @@ void                 _gtk_cell_area_set_cell_data_func_with_proxy  (GtkCellArea
 								    GDestroyNotify         destroy,
 								    gpointer               proxy);
 
+gint                 _gtk_cell_area_get_text_column                (GtkCellArea           *area,
+                                                                    GtkCellRenderer       *renderer);
+
 G_END_DECLS
 
 #endif /* __GTK_CELL_AREA_H__ */
@@ -2277,3 +2277,28 @@ gtk_cell_renderer_text_get_aligned_area (GtkCellRenderer       *cell,
 
   g_object_unref (layout);
 }
+
+/* Returns the font that @celltext lays out its text with, on top of
+ * the font of the widget, if that and the text are all its size
+ * depends on. Returns %NULL if any other property, like a wrap width,
+ * a scale or extra attributes, affects its size.
+ */
+const PangoFontDescription *
+_gtk_cell_renderer_text_get_plain_font (GtkCellRendererText *celltext)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+
+  if (priv->extra_attrs ||
+      priv->placeholder_text ||
+      priv->single_paragraph ||
+      priv->language_set ||
+      priv->rise_set ||
+      (priv->scale_set && priv->font_scale != 1.0) ||
+      (priv->ellipsize_set && priv->ellipsize != PANGO_ELLIPSIZE_NONE) ||
+      priv->wrap_width != -1 ||
+      priv->width_chars > 0 ||
+      priv->max_width_chars > 0)
+    return NULL;
+
+  return priv->font;
+}
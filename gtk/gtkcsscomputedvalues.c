@@ -19,6 +19,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "gtkprivate.h"
 #include "gtkcsscomputedvaluesprivate.h"
 
@@ -39,25 +41,47 @@
 
 G_DEFINE_TYPE (GtkCssComputedValues, _gtk_css_computed_values, G_TYPE_OBJECT)
 
+static void
+gtk_css_computed_values_free_animated_values (GtkCssValue **animated_values,
+                                              guint         n_values)
+{
+  guint i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      if (animated_values[i])
+        _gtk_css_value_unref (animated_values[i]);
+    }
+
+  g_free (animated_values);
+}
+
 static void
 gtk_css_computed_values_dispose (GObject *object)
 {
   GtkCssComputedValues *values = GTK_CSS_COMPUTED_VALUES (object);
+  guint i;
 
-  if (values->values)
+  if (values->animated_values)
     {
-      g_ptr_array_unref (values->values);
-      values->values = NULL;
+      gtk_css_computed_values_free_animated_values (values->animated_values, values->n_values);
+      values->animated_values = NULL;
     }
-  if (values->sections)
+  if (values->values)
     {
-      g_ptr_array_unref (values->sections);
+      for (i = 0; i < values->n_values; i++)
+        {
+          if (values->values[i])
+            _gtk_css_value_unref (values->values[i]);
+          if (values->sections[i])
+            gtk_css_section_unref (values->sections[i]);
+        }
+
+      /* sections are part of the same allocation */
+      g_free (values->values);
+      values->values = NULL;
       values->sections = NULL;
-    }
-  if (values->animated_values)
-    {
-      g_ptr_array_unref (values->animated_values);
-      values->animated_values = NULL;
+      values->n_values = 0;
     }
 
   g_slist_free_full (values->animations, g_object_unref);
@@ -91,23 +115,53 @@ _gtk_css_computed_values_class_init (GtkCssComputedValuesClass *klass)
 static void
 _gtk_css_computed_values_init (GtkCssComputedValues *values)
 {
+  /* Values and sections share one allocation so that computing a full
+   * set of values doesn't need to grow arrays one property at a time. */
+  values->n_values = _gtk_css_style_property_get_n_properties ();
+  values->values = g_new0 (GtkCssValue *, 2 * values->n_values);
+  values->sections = (GtkCssSection **) (values->values + values->n_values);
+
   values->depends_on_parent = _gtk_bitmask_new ();
   values->equals_parent = _gtk_bitmask_new ();
   values->depends_on_color = _gtk_bitmask_new ();
   values->depends_on_font_size = _gtk_bitmask_new ();
 }
 
-GtkCssComputedValues *
-_gtk_css_computed_values_new (void)
+/* Custom properties registered by theming engines after @values was
+ * created don't fit into our arrays, so make room for them. */
+static void
+gtk_css_computed_values_ensure_size (GtkCssComputedValues *values,
+                                     guint                 id)
 {
-  return g_object_new (GTK_TYPE_CSS_COMPUTED_VALUES, NULL);
+  GtkCssValue **new_values;
+  guint n_values;
+
+  if (G_LIKELY (id < values->n_values))
+    return;
+
+  n_values = MAX (id + 1, _gtk_css_style_property_get_n_properties ());
+
+  new_values = g_new0 (GtkCssValue *, 2 * n_values);
+  memcpy (new_values, values->values, sizeof (GtkCssValue *) * values->n_values);
+  memcpy (new_values + n_values, values->sections, sizeof (GtkCssSection *) * values->n_values);
+  g_free (values->values);
+  values->values = new_values;
+  values->sections = (GtkCssSection **) (new_values + n_values);
+
+  if (values->animated_values)
+    {
+      values->animated_values = g_renew (GtkCssValue *, values->animated_values, n_values);
+      memset (values->animated_values + values->n_values, 0,
+              sizeof (GtkCssValue *) * (n_values - values->n_values));
+    }
+
+  values->n_values = n_values;
 }
 
-static void
-maybe_unref_section (gpointer section)
+GtkCssComputedValues *
+_gtk_css_computed_values_new (void)
 {
-  if (section)
-    gtk_css_section_unref (section);
+  return g_object_new (GTK_TYPE_CSS_COMPUTED_VALUES, NULL);
 }
 
 void
@@ -159,15 +213,14 @@ _gtk_css_computed_values_set_animated_value (GtkCssComputedValues *values,
   gtk_internal_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
   gtk_internal_return_if_fail (value != NULL);
 
-  if (values->animated_values == NULL)
-    values->animated_values = g_ptr_array_new_with_free_func ((GDestroyNotify)_gtk_css_value_unref);
-  if (id >= values->animated_values->len)
-   g_ptr_array_set_size (values->animated_values, id + 1);
+  gtk_css_computed_values_ensure_size (values, id);
 
-  if (g_ptr_array_index (values->animated_values, id))
-    _gtk_css_value_unref (g_ptr_array_index (values->animated_values, id));
-  g_ptr_array_index (values->animated_values, id) = _gtk_css_value_ref (value);
+  if (values->animated_values == NULL)
+    values->animated_values = g_new0 (GtkCssValue *, values->n_values);
 
+  if (values->animated_values[id])
+    _gtk_css_value_unref (values->animated_values[id]);
+  values->animated_values[id] = _gtk_css_value_ref (value);
 }
 
 void
@@ -179,15 +232,12 @@ _gtk_css_computed_values_set_value (GtkCssComputedValues *values,
 {
   gtk_internal_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
 
-  if (values->values == NULL)
-    values->values = g_ptr_array_new_full (_gtk_css_style_property_get_n_properties (),
-					   (GDestroyNotify)_gtk_css_value_unref);
-  if (id >= values->values->len)
-   g_ptr_array_set_size (values->values, id + 1);
+  gtk_css_computed_values_ensure_size (values, id);
 
-  if (g_ptr_array_index (values->values, id))
-    _gtk_css_value_unref (g_ptr_array_index (values->values, id));
-  g_ptr_array_index (values->values, id) = _gtk_css_value_ref (value);
+  _gtk_css_value_ref (value);
+  if (values->values[id])
+    _gtk_css_value_unref (values->values[id]);
+  values->values[id] = value;
 
   if (dependencies & (GTK_CSS_DEPENDS_ON_PARENT | GTK_CSS_EQUALS_PARENT))
     values->depends_on_parent = _gtk_bitmask_set (values->depends_on_parent, id, TRUE);
@@ -198,20 +248,13 @@ _gtk_css_computed_values_set_value (GtkCssComputedValues *values,
   if (dependencies & (GTK_CSS_DEPENDS_ON_FONT_SIZE))
     values->depends_on_font_size = _gtk_bitmask_set (values->depends_on_font_size, id, TRUE);
 
-  if (values->sections && values->sections->len > id && g_ptr_array_index (values->sections, id))
-    {
-      gtk_css_section_unref (g_ptr_array_index (values->sections, id));
-      g_ptr_array_index (values->sections, id) = NULL;
-    }
-
-  if (section)
+  if (values->sections[id] != section)
     {
-      if (values->sections == NULL)
-        values->sections = g_ptr_array_new_with_free_func (maybe_unref_section);
-      if (values->sections->len <= id)
-        g_ptr_array_set_size (values->sections, id + 1);
-
-      g_ptr_array_index (values->sections, id) = gtk_css_section_ref (section);
+      if (section)
+        gtk_css_section_ref (section);
+      if (values->sections[id])
+        gtk_css_section_unref (values->sections[id]);
+      values->sections[id] = section;
     }
 }
 
@@ -222,9 +265,9 @@ _gtk_css_computed_values_get_value (GtkCssComputedValues *values,
   gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), NULL);
 
   if (values->animated_values &&
-      id < values->animated_values->len &&
-      g_ptr_array_index (values->animated_values, id))
-    return g_ptr_array_index (values->animated_values, id);
+      id < values->n_values &&
+      values->animated_values[id])
+    return values->animated_values[id];
 
   return _gtk_css_computed_values_get_intrinsic_value (values, id);
 }
@@ -235,11 +278,10 @@ _gtk_css_computed_values_get_intrinsic_value (GtkCssComputedValues *values,
 {
   gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), NULL);
 
-  if (values->values == NULL ||
-      id >= values->values->len)
+  if (id >= values->n_values)
     return NULL;
 
-  return g_ptr_array_index (values->values, id);
+  return values->values[id];
 }
 
 GtkCssSection *
@@ -248,11 +290,10 @@ _gtk_css_computed_values_get_section (GtkCssComputedValues *values,
 {
   gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), NULL);
 
-  if (values->sections == NULL ||
-      id >= values->sections->len)
+  if (id >= values->n_values)
     return NULL;
 
-  return g_ptr_array_index (values->sections, id);
+  return values->sections[id];
 }
 
 GtkBitmask *
@@ -262,15 +303,14 @@ _gtk_css_computed_values_get_difference (GtkCssComputedValues *values,
   GtkBitmask *result;
   guint i, len;
 
-  len = MIN (values->values->len, other->values->len);
+  len = MIN (values->n_values, other->n_values);
   result = _gtk_bitmask_new ();
-  if (values->values->len != other->values->len)
-    result = _gtk_bitmask_invert_range (result, len, MAX (values->values->len, other->values->len));
+  if (values->n_values != other->n_values)
+    result = _gtk_bitmask_invert_range (result, len, MAX (values->n_values, other->n_values));
   
   for (i = 0; i < len; i++)
     {
-      if (!_gtk_css_value_equal (g_ptr_array_index (values->values, i),
-                                 g_ptr_array_index (other->values, i)))
+      if (!_gtk_css_value_equal0 (values->values[i], other->values[i]))
         result = _gtk_bitmask_set (result, i, TRUE);
     }
 
@@ -529,7 +569,8 @@ _gtk_css_computed_values_advance (GtkCssComputedValues *values,
                                   gint64                timestamp)
 {
   GtkBitmask *changed;
-  GPtrArray *old_computed_values;
+  GtkCssValue **old_computed_values;
+  guint old_n_values;
   GSList *list;
   guint i;
 
@@ -538,6 +579,7 @@ _gtk_css_computed_values_advance (GtkCssComputedValues *values,
 
   values->current_time = timestamp;
   old_computed_values = values->animated_values;
+  old_n_values = values->n_values;
   values->animated_values = NULL;
 
   list = values->animations;
@@ -565,15 +607,15 @@ _gtk_css_computed_values_advance (GtkCssComputedValues *values,
     {
       GtkCssValue *old_animated, *new_animated;
 
-      old_animated = old_computed_values && i < old_computed_values->len ? g_ptr_array_index (old_computed_values, i) : NULL;
-      new_animated = values->animated_values && i < values->animated_values->len ? g_ptr_array_index (values->animated_values, i) : NULL;
+      old_animated = old_computed_values ? old_computed_values[i] : NULL;
+      new_animated = values->animated_values ? values->animated_values[i] : NULL;
 
       if (!_gtk_css_value_equal0 (old_animated, new_animated))
         changed = _gtk_bitmask_set (changed, i, TRUE);
     }
 
   if (old_computed_values)
-    g_ptr_array_unref (old_computed_values);
+    gtk_css_computed_values_free_animated_values (old_computed_values, old_n_values);
 
   return changed;
 }
@@ -594,6 +636,50 @@ _gtk_css_computed_values_is_static (GtkCssComputedValues *values)
   return TRUE;
 }
 
+/**
+ * _gtk_css_computed_values_can_animate:
+ * @values: the values to check
+ *
+ * Checks if _gtk_css_computed_values_create_animations() could ever
+ * add an animation or transition to @values. If this returns %FALSE,
+ * @values will not change after it has been computed and can safely
+ * be shared between style contexts.
+ *
+ * Returns: %TRUE if @values might get animated
+ **/
+gboolean
+_gtk_css_computed_values_can_animate (GtkCssComputedValues *values)
+{
+  GtkCssValue *array;
+  guint i;
+
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), TRUE);
+
+  array = _gtk_css_computed_values_get_value (values, GTK_CSS_PROPERTY_ANIMATION_NAME);
+  for (i = 0; i < _gtk_css_array_value_get_n_values (array); i++)
+    {
+      if (g_ascii_strcasecmp (_gtk_css_ident_value_get (_gtk_css_array_value_get_nth (array, i)), "none") != 0)
+        return TRUE;
+    }
+
+  /* A transition is only created if duration + delay != 0 */
+  array = _gtk_css_computed_values_get_value (values, GTK_CSS_PROPERTY_TRANSITION_DURATION);
+  for (i = 0; i < _gtk_css_array_value_get_n_values (array); i++)
+    {
+      if (_gtk_css_number_value_get (_gtk_css_array_value_get_nth (array, i), 100) != 0.0)
+        return TRUE;
+    }
+
+  array = _gtk_css_computed_values_get_value (values, GTK_CSS_PROPERTY_TRANSITION_DELAY);
+  for (i = 0; i < _gtk_css_array_value_get_n_values (array); i++)
+    {
+      if (_gtk_css_number_value_get (_gtk_css_array_value_get_nth (array, i), 100) != 0.0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 void
 _gtk_css_computed_values_cancel_animations (GtkCssComputedValues *values)
 {
@@ -601,7 +687,7 @@ _gtk_css_computed_values_cancel_animations (GtkCssComputedValues *values)
 
   if (values->animated_values)
     {
-      g_ptr_array_unref (values->animated_values);
+      gtk_css_computed_values_free_animated_values (values->animated_values, values->n_values);
       values->animated_values = NULL;
     }
 
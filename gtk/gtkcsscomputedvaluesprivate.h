@@ -42,10 +42,11 @@ struct _GtkCssComputedValues
 {
   GObject parent;
 
-  GPtrArray             *values;               /* the unanimated (aka intrinsic) values */
-  GPtrArray             *sections;             /* sections the values are defined in */
+  guint                  n_values;             /* size of the values, sections and animated_values arrays */
+  GtkCssValue          **values;               /* the unanimated (aka intrinsic) values */
+  GtkCssSection        **sections;             /* sections the values are defined in, allocated with values */
 
-  GPtrArray             *animated_values;      /* NULL or array of animated values/NULL if not animated */
+  GtkCssValue          **animated_values;      /* NULL or array of animated values/NULL if not animated */
   gint64                 current_time;         /* the current time in our world */
   GSList                *animations;           /* the running animations, least important one first */
 
@@ -101,6 +102,7 @@ GtkBitmask *            _gtk_css_computed_values_advance              (GtkCssCom
                                                                        gint64                    timestamp);
 void                    _gtk_css_computed_values_cancel_animations    (GtkCssComputedValues     *values);
 gboolean                _gtk_css_computed_values_is_static            (GtkCssComputedValues     *values);
+gboolean                _gtk_css_computed_values_can_animate          (GtkCssComputedValues     *values);
 
 G_END_DECLS
 
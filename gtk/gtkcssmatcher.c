@@ -19,7 +19,9 @@
 
 #include "gtkcssmatcherprivate.h"
 
-#include "gtkwidgetpath.h"
+#include <string.h>
+
+#include "gtkwidgetpathprivate.h"
 
 /* GTK_CSS_MATCHER_WIDGET_PATH */
 
@@ -35,6 +37,8 @@ gtk_css_matcher_widget_path_get_parent (GtkCssMatcher       *matcher,
   matcher->path.state_flags = 0;
   matcher->path.index = child->path.index - 1;
   matcher->path.sibling_index = gtk_widget_path_iter_get_sibling_index (matcher->path.path, matcher->path.index);
+  /* The ancestors of our parent are a subset of our ancestors */
+  matcher->path.ancestors = child->path.ancestors;
 
   return TRUE;
 }
@@ -51,6 +55,7 @@ gtk_css_matcher_widget_path_get_previous (GtkCssMatcher       *matcher,
   matcher->path.state_flags = 0;
   matcher->path.index = next->path.index;
   matcher->path.sibling_index = next->path.sibling_index - 1;
+  matcher->path.ancestors = next->path.ancestors;
 
   return TRUE;
 }
@@ -173,6 +178,14 @@ gtk_css_matcher_widget_path_has_position (const GtkCssMatcher *matcher,
   return x / a > 0;
 }
 
+static gboolean
+gtk_css_matcher_widget_path_ancestors_may_have (const GtkCssMatcher *matcher,
+                                                GtkCssBloomKind      kind,
+                                                gsize                value)
+{
+  return _gtk_css_bloom_filter_may_contain (&matcher->path.ancestors, kind, value);
+}
+
 static const GtkCssMatcherClass GTK_CSS_MATCHER_WIDGET_PATH = {
   gtk_css_matcher_widget_path_get_parent,
   gtk_css_matcher_widget_path_get_previous,
@@ -183,6 +196,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_WIDGET_PATH = {
   gtk_css_matcher_widget_path_has_regions,
   gtk_css_matcher_widget_path_has_region,
   gtk_css_matcher_widget_path_has_position,
+  gtk_css_matcher_widget_path_ancestors_may_have,
   FALSE
 };
 
@@ -191,6 +205,8 @@ _gtk_css_matcher_init (GtkCssMatcher       *matcher,
                        const GtkWidgetPath *path,
                        GtkStateFlags        state)
 {
+  guint i;
+
   if (gtk_widget_path_length (path) == 0)
     return FALSE;
 
@@ -200,6 +216,10 @@ _gtk_css_matcher_init (GtkCssMatcher       *matcher,
   matcher->path.index = gtk_widget_path_length (path) - 1;
   matcher->path.sibling_index = gtk_widget_path_iter_get_sibling_index (path, matcher->path.index);
 
+  memset (&matcher->path.ancestors, 0, sizeof (GtkCssBloomFilter));
+  for (i = 0; i < matcher->path.index; i++)
+    _gtk_widget_path_iter_add_to_bloom_filter (path, i, &matcher->path.ancestors);
+
   return TRUE;
 }
 
@@ -277,6 +297,14 @@ gtk_css_matcher_any_has_position (const GtkCssMatcher *matcher,
   return TRUE;
 }
 
+static gboolean
+gtk_css_matcher_any_ancestors_may_have (const GtkCssMatcher *matcher,
+                                        GtkCssBloomKind      kind,
+                                        gsize                value)
+{
+  return TRUE;
+}
+
 static const GtkCssMatcherClass GTK_CSS_MATCHER_ANY = {
   gtk_css_matcher_any_get_parent,
   gtk_css_matcher_any_get_previous,
@@ -287,6 +315,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_ANY = {
   gtk_css_matcher_any_has_regions,
   gtk_css_matcher_any_has_region,
   gtk_css_matcher_any_has_position,
+  gtk_css_matcher_any_ancestors_may_have,
   TRUE
 };
 
@@ -396,6 +425,15 @@ gtk_css_matcher_superset_has_position (const GtkCssMatcher *matcher,
     return TRUE;
 }
 
+static gboolean
+gtk_css_matcher_superset_ancestors_may_have (const GtkCssMatcher *matcher,
+                                             GtkCssBloomKind      kind,
+                                             gsize                value)
+{
+  /* our parents are any matchers */
+  return TRUE;
+}
+
 static const GtkCssMatcherClass GTK_CSS_MATCHER_SUPERSET = {
   gtk_css_matcher_superset_get_parent,
   gtk_css_matcher_superset_get_previous,
@@ -406,6 +444,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_SUPERSET = {
   gtk_css_matcher_superset_has_regions,
   gtk_css_matcher_superset_has_region,
   gtk_css_matcher_superset_has_position,
+  gtk_css_matcher_superset_ancestors_may_have,
   FALSE
 };
 
@@ -25,10 +25,26 @@
 G_BEGIN_DECLS
 
 typedef union _GtkCssMatcher GtkCssMatcher;
+typedef struct _GtkCssBloomFilter GtkCssBloomFilter;
 typedef struct _GtkCssMatcherSuperset GtkCssMatcherSuperset;
 typedef struct _GtkCssMatcherWidgetPath GtkCssMatcherWidgetPath;
 typedef struct _GtkCssMatcherClass GtkCssMatcherClass;
 
+typedef enum {
+  GTK_CSS_BLOOM_TYPE,
+  GTK_CSS_BLOOM_ID,
+  GTK_CSS_BLOOM_CLASS,
+  GTK_CSS_BLOOM_REGION
+} GtkCssBloomKind;
+
+#define GTK_CSS_BLOOM_FILTER_BITS 256
+
+/* A set of types, ids, classes and regions that can only give false
+ * positives. Used to quickly check if an ancestor could match. */
+struct _GtkCssBloomFilter {
+  guint32 bits[GTK_CSS_BLOOM_FILTER_BITS / 32];
+};
+
 struct _GtkCssMatcherClass {
   gboolean        (* get_parent)                  (GtkCssMatcher          *matcher,
                                                    const GtkCssMatcher    *child);
@@ -50,6 +66,9 @@ struct _GtkCssMatcherClass {
                                                    gboolean               forward,
                                                    int                    a,
                                                    int                    b);
+  gboolean        (* ancestors_may_have)          (const GtkCssMatcher   *matcher,
+                                                   GtkCssBloomKind        kind,
+                                                   gsize                  value);
   gboolean is_any;
 };
 
@@ -59,6 +78,7 @@ struct _GtkCssMatcherWidgetPath {
   GtkStateFlags             state_flags;
   guint                     index;
   guint                     sibling_index;
+  GtkCssBloomFilter         ancestors;
 };
 
 struct _GtkCssMatcherSuperset {
@@ -82,6 +102,40 @@ void              _gtk_css_matcher_superset_init  (GtkCssMatcher          *match
                                                    GtkCssChange            relevant);
 
 
+static inline guint
+_gtk_css_bloom_filter_hash (GtkCssBloomKind kind,
+                            gsize           value)
+{
+  /* multiplicative hashing, so use the high bits */
+  return ((guint) value ^ ((guint) kind << 28)) * 2654435761u;
+}
+
+static inline void
+_gtk_css_bloom_filter_add (GtkCssBloomFilter *filter,
+                           GtkCssBloomKind    kind,
+                           gsize              value)
+{
+  guint hash = _gtk_css_bloom_filter_hash (kind, value);
+  guint a = hash >> 24;
+  guint b = (hash >> 16) & 0xff;
+
+  filter->bits[a / 32] |= 1u << (a % 32);
+  filter->bits[b / 32] |= 1u << (b % 32);
+}
+
+static inline gboolean
+_gtk_css_bloom_filter_may_contain (const GtkCssBloomFilter *filter,
+                                   GtkCssBloomKind          kind,
+                                   gsize                    value)
+{
+  guint hash = _gtk_css_bloom_filter_hash (kind, value);
+  guint a = hash >> 24;
+  guint b = (hash >> 16) & 0xff;
+
+  return (filter->bits[a / 32] & (1u << (a % 32))) &&
+         (filter->bits[b / 32] & (1u << (b % 32)));
+}
+
 static inline gboolean
 _gtk_css_matcher_get_parent (GtkCssMatcher       *matcher,
                              const GtkCssMatcher *child)
@@ -147,6 +201,14 @@ _gtk_css_matcher_has_position (const GtkCssMatcher *matcher,
   return matcher->klass->has_position (matcher, forward, a, b);
 }
 
+static inline gboolean
+_gtk_css_matcher_ancestors_may_have (const GtkCssMatcher *matcher,
+                                     GtkCssBloomKind      kind,
+                                     gsize                value)
+{
+  return matcher->klass->ancestors_may_have (matcher, kind, value);
+}
+
 static inline gboolean
 _gtk_css_matcher_matches_any (const GtkCssMatcher *matcher)
 {
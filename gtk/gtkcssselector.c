@@ -232,12 +232,18 @@ gtk_css_selector_descendant_print (const GtkCssSelector *selector,
   g_string_append_c (string, ' ');
 }
 
+static gboolean gtk_css_selector_may_match_ancestor (const GtkCssSelector *selector,
+                                                     const GtkCssMatcher  *matcher);
+
 static gboolean
 gtk_css_selector_descendant_match (const GtkCssSelector *selector,
                                    const GtkCssMatcher  *matcher)
 {
   GtkCssMatcher ancestor;
 
+  if (!gtk_css_selector_may_match_ancestor (gtk_css_selector_previous (selector), matcher))
+    return FALSE;
+
   while (_gtk_css_matcher_get_parent (&ancestor, matcher))
     {
       matcher = &ancestor;
@@ -254,18 +260,30 @@ gtk_css_selector_descendant_tree_match (const GtkCssSelectorTree *tree,
 					const GtkCssMatcher  *matcher,
 					GHashTable *res)
 {
+  const GtkCssSelectorTree *prev;
   GtkCssMatcher ancestor;
+  const GtkCssMatcher *current;
 
-  while (_gtk_css_matcher_get_parent (&ancestor, matcher))
+  for (prev = gtk_css_selector_tree_get_previous (tree);
+       prev != NULL;
+       prev = gtk_css_selector_tree_get_sibling (prev))
     {
-      matcher = &ancestor;
+      /* Don't walk up the path if no ancestor can match */
+      if (!gtk_css_selector_may_match_ancestor (&prev->selector, matcher))
+        continue;
 
-      gtk_css_selector_tree_match_previous (tree, matcher, res);
+      current = matcher;
+      while (_gtk_css_matcher_get_parent (&ancestor, current))
+        {
+          current = &ancestor;
 
-      /* any matchers are dangerous here, as we may loop forever, but
-	 we can terminate now as all possible matches have already been added */
-      if (_gtk_css_matcher_matches_any (matcher))
-	break;
+          gtk_css_selector_tree_match (prev, current, res);
+
+          /* any matchers are dangerous here, as we may loop forever, but
+             we can terminate now as all possible matches have already been added */
+          if (_gtk_css_matcher_matches_any (current))
+            break;
+        }
     }
 }
 
@@ -1094,6 +1112,51 @@ static const GtkCssSelectorClass GTK_CSS_SELECTOR_ID = {
   TRUE, FALSE, FALSE, TRUE, FALSE
 };
 
+/* ANCESTOR PRECHECK */
+
+/* Checks the bloom filter of @matcher's ancestors to see if @selector can
+ * possibly match any of them. If this returns FALSE, none of them match,
+ * so descendant selectors don't need to walk up the path at all.
+ * We only look at the first simple selector, which is enough to reject
+ * the vast majority of rules that don't apply.
+ */
+static gboolean
+gtk_css_selector_may_match_ancestor (const GtkCssSelector *selector,
+                                     const GtkCssMatcher  *matcher)
+{
+  GQuark quark;
+  GType type;
+
+  if (selector == NULL)
+    return TRUE;
+
+  if (selector->class == &GTK_CSS_SELECTOR_NAME)
+    {
+      type = ((TypeReference *) selector->data)->type;
+      /* g_type_is_a() is TRUE for implemented interfaces, which we don't track */
+      if (G_TYPE_IS_INTERFACE (type))
+        return TRUE;
+
+      return _gtk_css_matcher_ancestors_may_have (matcher, GTK_CSS_BLOOM_TYPE, type);
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_CLASS)
+    {
+      return _gtk_css_matcher_ancestors_may_have (matcher, GTK_CSS_BLOOM_CLASS, GPOINTER_TO_UINT (selector->data));
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_ID)
+    {
+      quark = g_quark_try_string (selector->data);
+      return quark != 0 && _gtk_css_matcher_ancestors_may_have (matcher, GTK_CSS_BLOOM_ID, quark);
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_REGION)
+    {
+      quark = g_quark_try_string (selector->data);
+      return quark != 0 && _gtk_css_matcher_ancestors_may_have (matcher, GTK_CSS_BLOOM_REGION, quark);
+    }
+
+  return TRUE;
+}
+
 /* PSEUDOCLASS FOR STATE */
 
 static void
@@ -30,11 +30,28 @@
 #include "gtkpango.h"
 
 #include <math.h>
+#include <string.h>
 
 /* The blur of _gtk_cairo_blur_surface only approximately ends at radius,
    so we add an extra pixel to make the clips less dramatic */
 #define CLIP_RADIUS_EXTRA 4
 
+/* Blurred masks of outset box shadows are cached up to this size,
+   so identical widgets don't blur the same shadow on every draw */
+#define MAX_SHADOW_MASK_SIZE (256 * 256)
+#define MAX_SHADOW_MASK_CACHE_SIZE (1024 * 1024)
+
+typedef struct _GtkShadowMask GtkShadowMask;
+
+struct _GtkShadowMask {
+  /* key, box is relative to the pixel grid */
+  GtkRoundedBox box;
+  double radius;
+
+  cairo_surface_t *surface;
+  GList link;
+};
+
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
   guint inset :1;
@@ -482,6 +499,121 @@ _gtk_css_shadow_value_get_geometry (const GtkCssValue *shadow,
     *spread = _gtk_css_number_value_get (shadow->spread, 0);
 }
 
+static GHashTable *shadow_masks = NULL;
+static GQueue shadow_masks_lru = G_QUEUE_INIT;
+static gsize shadow_masks_size = 0;
+
+static guint
+gtk_shadow_mask_hash (gconstpointer data)
+{
+  const GtkShadowMask *mask = data;
+  const double *values = (const double *) &mask->box;
+  guint i, hash;
+
+  hash = g_double_hash (&mask->radius);
+  for (i = 0; i < sizeof (GtkRoundedBox) / sizeof (double); i++)
+    hash = hash * 33 + g_double_hash (&values[i]);
+
+  return hash;
+}
+
+static gboolean
+gtk_shadow_mask_equal (gconstpointer a,
+                       gconstpointer b)
+{
+  const GtkShadowMask *mask_a = a;
+  const GtkShadowMask *mask_b = b;
+
+  return mask_a->radius == mask_b->radius &&
+         memcmp (&mask_a->box, &mask_b->box, sizeof (GtkRoundedBox)) == 0;
+}
+
+static gsize
+gtk_shadow_mask_get_size (GtkShadowMask *mask)
+{
+  return cairo_image_surface_get_stride (mask->surface) *
+         cairo_image_surface_get_height (mask->surface);
+}
+
+static void
+gtk_shadow_mask_free (GtkShadowMask *mask)
+{
+  cairo_surface_destroy (mask->surface);
+  g_slice_free (GtkShadowMask, mask);
+}
+
+/* Returns the blurred alpha mask of @box filled, positioned at @x, @y,
+ * or %NULL if @box is too large to cache. */
+static cairo_surface_t *
+gtk_css_shadow_value_get_mask (const GtkRoundedBox *box,
+                               double               radius,
+                               double              *x,
+                               double              *y)
+{
+  GtkShadowMask key, *mask;
+  double origin_x, origin_y;
+  int pad, width, height;
+  cairo_t *mask_cr;
+
+  pad = ceil (radius + CLIP_RADIUS_EXTRA);
+  origin_x = floor (box->box.x);
+  origin_y = floor (box->box.y);
+
+  key.box = *box;
+  key.box.box.x -= origin_x;
+  key.box.box.y -= origin_y;
+  key.radius = radius;
+
+  width = ceil (key.box.box.x + key.box.box.width) + 2 * pad;
+  height = ceil (key.box.box.y + key.box.box.height) + 2 * pad;
+  if ((gint64) width * height > MAX_SHADOW_MASK_SIZE)
+    return NULL;
+
+  *x = origin_x - pad;
+  *y = origin_y - pad;
+
+  if (shadow_masks == NULL)
+    shadow_masks = g_hash_table_new (gtk_shadow_mask_hash, gtk_shadow_mask_equal);
+
+  mask = g_hash_table_lookup (shadow_masks, &key);
+  if (mask)
+    {
+      g_queue_unlink (&shadow_masks_lru, &mask->link);
+      g_queue_push_head_link (&shadow_masks_lru, &mask->link);
+      return mask->surface;
+    }
+
+  mask = g_slice_new (GtkShadowMask);
+  *mask = key;
+  mask->link.data = mask;
+  mask->link.prev = mask->link.next = NULL;
+  mask->surface = cairo_image_surface_create (CAIRO_FORMAT_A8, width, height);
+
+  mask_cr = cairo_create (mask->surface);
+  cairo_translate (mask_cr, pad, pad);
+  _gtk_rounded_box_path (&mask->box, mask_cr);
+  cairo_fill (mask_cr);
+  cairo_destroy (mask_cr);
+
+  _gtk_cairo_blur_surface (mask->surface, radius);
+
+  g_hash_table_add (shadow_masks, mask);
+  g_queue_push_head_link (&shadow_masks_lru, &mask->link);
+  shadow_masks_size += gtk_shadow_mask_get_size (mask);
+
+  /* Never evicts the mask we just added, it's at the head */
+  while (shadow_masks_size > MAX_SHADOW_MASK_CACHE_SIZE)
+    {
+      GtkShadowMask *old = g_queue_pop_tail_link (&shadow_masks_lru)->data;
+
+      g_hash_table_remove (shadow_masks, old);
+      shadow_masks_size -= gtk_shadow_mask_get_size (old);
+      gtk_shadow_mask_free (old);
+    }
+
+  return mask->surface;
+}
+
 static gboolean
 has_empty_clip (cairo_t *cr)
 {
@@ -570,6 +702,21 @@ _gtk_css_shadow_value_paint_box (const GtkCssValue   *shadow,
   else /* Outset */
     _gtk_rounded_box_grow (&box, spread, spread, spread, spread);
 
+  if (!shadow->inset && radius != 0)
+    {
+      cairo_surface_t *mask;
+      double mask_x, mask_y;
+
+      mask = gtk_css_shadow_value_get_mask (&box, radius, &mask_x, &mask_y);
+      if (mask)
+        {
+          gdk_cairo_set_source_rgba (cr, _gtk_css_rgba_value_get_rgba (shadow->color));
+          cairo_mask_surface (cr, mask, mask_x, mask_y);
+          cairo_restore (cr);
+          return;
+        }
+    }
+
   clip_box = *padding_box;
   _gtk_rounded_box_shrink (&clip_box, -clip_radius, -clip_radius, -clip_radius, -clip_radius);
 
@@ -27,6 +27,7 @@
 #include "gtkintl.h"
 #include "gtkbuildable.h"
 #include "gtkbuilderprivate.h"
+#include "gtkmarshalers.h"
 
 
 /**
@@ -201,10 +202,20 @@ struct _GtkListStorePrivate
 
   guint columns_dirty : 1;
 
+  gint bulk_update_count;
+
   gpointer default_sort_data;
   gpointer seq;         /* head of the list */
 };
 
+enum {
+  BEGIN_BULK_UPDATE,
+  END_BULK_UPDATE,
+  LAST_SIGNAL
+};
+
+static guint list_store_signals[LAST_SIGNAL] = { 0 };
+
 #define GTK_LIST_STORE_IS_SORTED(list) (((GtkListStore*)(list))->priv->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
 static void         gtk_list_store_tree_model_init (GtkTreeModelIface *iface);
 static void         gtk_list_store_drag_source_init(GtkTreeDragSourceIface *iface);
@@ -328,6 +339,48 @@ gtk_list_store_class_init (GtkListStoreClass *class)
   object_class = (GObjectClass*) class;
 
   object_class->finalize = gtk_list_store_finalize;
+
+  /**
+   * GtkListStore::begin-bulk-update:
+   * @list_store: the object which received the signal
+   *
+   * The ::begin-bulk-update signal is emitted before
+   * gtk_list_store_insert_rows(), gtk_list_store_remove_rows() or
+   * gtk_list_store_replace_rows() change the store. The individual
+   * rows are still announced with the usual #GtkTreeModel signals,
+   * but views can postpone their relayout until
+   * #GtkListStore::end-bulk-update is emitted.
+   *
+   * Since: 3.10
+   */
+  list_store_signals[BEGIN_BULK_UPDATE] =
+    g_signal_new (I_("begin-bulk-update"),
+                  G_OBJECT_CLASS_TYPE (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _gtk_marshal_VOID__VOID,
+                  G_TYPE_NONE,
+                  0);
+
+  /**
+   * GtkListStore::end-bulk-update:
+   * @list_store: the object which received the signal
+   *
+   * The ::end-bulk-update signal is emitted once the changes
+   * announced by #GtkListStore::begin-bulk-update are complete.
+   *
+   * Since: 3.10
+   */
+  list_store_signals[END_BULK_UPDATE] =
+    g_signal_new (I_("end-bulk-update"),
+                  G_OBJECT_CLASS_TYPE (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _gtk_marshal_VOID__VOID,
+                  G_TYPE_NONE,
+                  0);
 }
 
 static void
@@ -568,14 +621,22 @@ gtk_list_store_set_column_type (GtkListStore *list_store,
   priv->column_headers[column] = type;
 }
 
+static void
+gtk_list_store_free_row (gpointer data,
+                         gpointer user_data)
+{
+  GtkListStorePrivate *priv = user_data;
+
+  _gtk_tree_data_row_free (data, priv->n_columns, priv->column_headers);
+}
+
 static void
 gtk_list_store_finalize (GObject *object)
 {
   GtkListStore *list_store = GTK_LIST_STORE (object);
   GtkListStorePrivate *priv = list_store->priv;
 
-  g_sequence_foreach (priv->seq,
-		      (GFunc) _gtk_tree_data_list_free, priv->column_headers);
+  g_sequence_foreach (priv->seq, gtk_list_store_free_row, priv);
 
   g_sequence_free (priv->seq);
 
@@ -681,23 +742,19 @@ gtk_list_store_get_value (GtkTreeModel *tree_model,
 {
   GtkListStore *list_store = GTK_LIST_STORE (tree_model);
   GtkListStorePrivate *priv = list_store->priv;
-  GtkTreeDataList *list;
-  gint tmp_column = column;
+  GtkTreeDataCell *row;
 
   g_return_if_fail (column < priv->n_columns);
   g_return_if_fail (iter_is_valid (iter, list_store));
 		    
-  list = g_sequence_get (iter->user_data);
-
-  while (tmp_column-- > 0 && list)
-    list = list->next;
+  row = g_sequence_get (iter->user_data);
 
-  if (list == NULL)
+  if (row == NULL)
     g_value_init (value, priv->column_headers[column]);
   else
-    _gtk_tree_data_list_node_to_value (list,
-				       priv->column_headers[column],
-				       value);
+    _gtk_tree_data_cell_to_value (&row[column],
+                                  priv->column_headers[column],
+                                  value);
 }
 
 static gboolean
@@ -831,9 +888,7 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
 			       gboolean      sort)
 {
   GtkListStorePrivate *priv = list_store->priv;
-  GtkTreeDataList *list;
-  GtkTreeDataList *prev;
-  gint old_column = column;
+  GtkTreeDataCell *row;
   GValue real_value = G_VALUE_INIT;
   gboolean converted = FALSE;
   gboolean retval = FALSE;
@@ -862,60 +917,24 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
       converted = TRUE;
     }
 
-  prev = list = g_sequence_get (iter->user_data);
-
-  while (list != NULL)
-    {
-      if (column == 0)
-	{
-	  if (converted)
-	    _gtk_tree_data_list_value_to_node (list, &real_value);
-	  else
-	    _gtk_tree_data_list_value_to_node (list, value);
-	  retval = TRUE;
-	  if (converted)
-	    g_value_unset (&real_value);
-         if (sort && GTK_LIST_STORE_IS_SORTED (list_store))
-            gtk_list_store_sort_iter_changed (list_store, iter, old_column);
-	  return retval;
-	}
-
-      column--;
-      prev = list;
-      list = list->next;
-    }
-
-  if (g_sequence_get (iter->user_data) == NULL)
-    {
-      list = _gtk_tree_data_list_alloc();
-      g_sequence_set (iter->user_data, list);
-      list->next = NULL;
-    }
-  else
-    {
-      list = prev->next = _gtk_tree_data_list_alloc ();
-      list->next = NULL;
-    }
-
-  while (column != 0)
+  row = g_sequence_get (iter->user_data);
+  if (row == NULL)
     {
-      list->next = _gtk_tree_data_list_alloc ();
-      list = list->next;
-      list->next = NULL;
-      column --;
+      row = _gtk_tree_data_row_new (priv->n_columns);
+      g_sequence_set (iter->user_data, row);
     }
 
   if (converted)
-    _gtk_tree_data_list_value_to_node (list, &real_value);
+    _gtk_tree_data_cell_set_value (&row[column], &real_value);
   else
-    _gtk_tree_data_list_value_to_node (list, value);
+    _gtk_tree_data_cell_set_value (&row[column], value);
 
   retval = TRUE;
   if (converted)
     g_value_unset (&real_value);
 
   if (sort && GTK_LIST_STORE_IS_SORTED (list_store))
-    gtk_list_store_sort_iter_changed (list_store, iter, old_column);
+    gtk_list_store_sort_iter_changed (list_store, iter, column);
 
   return retval;
 }
@@ -1222,7 +1241,7 @@ gtk_list_store_remove (GtkListStore *list_store,
   ptr = iter->user_data;
   next = g_sequence_iter_next (ptr);
   
-  _gtk_tree_data_list_free (g_sequence_get (ptr), priv->column_headers);
+  _gtk_tree_data_row_free (g_sequence_get (ptr), priv->n_columns, priv->column_headers);
   g_sequence_remove (iter->user_data);
 
   priv->length--;
@@ -1243,6 +1262,93 @@ gtk_list_store_remove (GtkListStore *list_store,
     }
 }
 
+/* Bulk updates nest, only the outermost pair is signalled */
+static void
+gtk_list_store_begin_bulk_update (GtkListStore *list_store)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+
+  priv->bulk_update_count++;
+  if (priv->bulk_update_count == 1)
+    g_signal_emit (list_store, list_store_signals[BEGIN_BULK_UPDATE], 0);
+}
+
+static void
+gtk_list_store_end_bulk_update (GtkListStore *list_store)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+
+  g_return_if_fail (priv->bulk_update_count > 0);
+
+  if (priv->bulk_update_count == 1)
+    g_signal_emit (list_store, list_store_signals[END_BULK_UPDATE], 0);
+  priv->bulk_update_count--;
+}
+
+/**
+ * gtk_list_store_remove_rows:
+ * @list_store: A #GtkListStore
+ * @position: the position of the first row to remove
+ * @n_rows: the number of rows to remove, or -1 for all rows
+ *     from @position to the end
+ *
+ * Removes up to @n_rows rows starting at @position. This is
+ * equivalent to calling gtk_list_store_remove() on each of them,
+ * except that the removals are grouped by #GtkListStore::begin-bulk-update
+ * and #GtkListStore::end-bulk-update.
+ *
+ * The number of rows is determined before the first row is removed;
+ * rows added by #GtkTreeModel::row-deleted handlers are not removed.
+ *
+ * Since: 3.10
+ */
+void
+gtk_list_store_remove_rows (GtkListStore *list_store,
+                            gint          position,
+                            gint          n_rows)
+{
+  GtkListStorePrivate *priv;
+  GtkTreePath *path;
+  GSequenceIter *ptr;
+  gint length;
+
+  g_return_if_fail (GTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (position >= 0);
+
+  priv = list_store->priv;
+
+  length = g_sequence_get_length (priv->seq);
+  if (position >= length)
+    return;
+  if (n_rows < 0 || n_rows > length - position)
+    n_rows = length - position;
+
+  gtk_list_store_begin_bulk_update (list_store);
+
+  path = gtk_tree_path_new_from_indices (position, -1);
+
+  /* Remove from the front of the range, so every row-deleted is
+   * emitted for the same path. Like gtk_list_store_clear() we look
+   * the row up again every time, handlers may have changed the store.
+   * That costs O(log n) per row.
+   */
+  for (; n_rows > 0 && position < g_sequence_get_length (priv->seq); n_rows--)
+    {
+      ptr = g_sequence_get_iter_at_pos (priv->seq, position);
+
+      _gtk_tree_data_row_free (g_sequence_get (ptr), priv->n_columns, priv->column_headers);
+      g_sequence_remove (ptr);
+
+      priv->length--;
+
+      gtk_tree_model_row_deleted (GTK_TREE_MODEL (list_store), path);
+    }
+
+  gtk_tree_path_free (path);
+
+  gtk_list_store_end_bulk_update (list_store);
+}
+
 /**
  * gtk_list_store_insert:
  * @list_store: A #GtkListStore
@@ -1577,33 +1683,13 @@ gtk_list_store_drag_data_received (GtkTreeDragDest   *drag_dest,
        */
       if (retval)
         {
-          GtkTreeDataList *dl = g_sequence_get (src_iter.user_data);
-          GtkTreeDataList *copy_head = NULL;
-          GtkTreeDataList *copy_prev = NULL;
-          GtkTreeDataList *copy_iter = NULL;
 	  GtkTreePath *path;
-          gint col;
-
-          col = 0;
-          while (dl)
-            {
-              copy_iter = _gtk_tree_data_list_node_copy (dl,
-                                                         priv->column_headers[col]);
-
-              if (copy_head == NULL)
-                copy_head = copy_iter;
-
-              if (copy_prev)
-                copy_prev->next = copy_iter;
-
-              copy_prev = copy_iter;
-
-              dl = dl->next;
-              ++col;
-            }
 
 	  dest_iter.stamp = priv->stamp;
-          g_sequence_set (dest_iter.user_data, copy_head);
+          g_sequence_set (dest_iter.user_data,
+                          _gtk_tree_data_row_copy (g_sequence_get (src_iter.user_data),
+                                                   priv->n_columns,
+                                                   priv->column_headers));
 
 	  path = gtk_list_store_get_path (tree_model, &dest_iter);
 	  gtk_tree_model_row_changed (tree_model, path, &dest_iter);
@@ -2327,6 +2413,189 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
   gtk_tree_path_free (path);
 }
 
+/**
+ * gtk_list_store_insert_rows:
+ * @list_store: A #GtkListStore
+ * @position: position to insert the new rows, or -1 for last
+ * @n_rows: the number of rows to insert
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows * @n_values GValues, holding
+ *     the values of the first row followed by those of the second row
+ *     and so on
+ * @n_values: the length of the @columns array
+ *
+ * Inserts @n_rows new rows at @position, setting the columns listed in
+ * @columns to the corresponding values in @values.
+ *
+ * This is equivalent to calling gtk_list_store_insert_with_valuesv()
+ * @n_rows times with increasing positions, and saves the overhead of
+ * the separate calls. The rows end up in the same order as in @values,
+ * unless the list store is sorted.
+ *
+ * #GtkTreeModel::row-inserted is still emitted once for every row,
+ * between #GtkListStore::begin-bulk-update and
+ * #GtkListStore::end-bulk-update. A #GtkTreeView showing @list_store
+ * directly uses these to do its relayout once for the whole range.
+ *
+ * Since: 3.10
+ */
+void
+gtk_list_store_insert_rows (GtkListStore *list_store,
+                            gint          position,
+                            gint          n_rows,
+                            gint         *columns,
+                            GValue       *values,
+                            gint          n_values)
+{
+  GtkListStorePrivate *priv;
+  GtkTreePath *path;
+  GSequence *seq;
+  GSequenceIter *before;
+  GtkTreeIter iter;
+  gint length;
+  gint i;
+
+  g_return_if_fail (GTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  priv = list_store->priv;
+
+  priv->columns_dirty = TRUE;
+
+  seq = priv->seq;
+
+  length = g_sequence_get_length (seq);
+  if (position > length || position < 0)
+    position = length;
+
+  if (n_rows == 0)
+    return;
+
+  gtk_list_store_begin_bulk_update (list_store);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      gboolean changed = FALSE;
+      gboolean maybe_need_sort = FALSE;
+
+      /* Like gtk_list_store_remove_rows() we look the position up again
+       * every time, at O(log n), row-inserted handlers may have changed
+       * the store.
+       */
+      length = g_sequence_get_length (seq);
+      before = g_sequence_get_iter_at_pos (seq, MIN (position + i, length));
+
+      iter.stamp = priv->stamp;
+      iter.user_data = g_sequence_insert_before (before, NULL);
+
+      priv->length++;
+
+      gtk_list_store_set_vector_internal (list_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + i * n_values, n_values);
+
+      /* Don't emit rows_reordered here */
+      if (maybe_need_sort && GTK_LIST_STORE_IS_SORTED (list_store))
+        g_sequence_sort_changed_iter (iter.user_data,
+                                      gtk_list_store_compare_func,
+                                      list_store);
+
+      path = gtk_list_store_get_path (GTK_TREE_MODEL (list_store), &iter);
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (list_store), path, &iter);
+      gtk_tree_path_free (path);
+    }
+
+  gtk_list_store_end_bulk_update (list_store);
+}
+
+/**
+ * gtk_list_store_replace_rows:
+ * @list_store: A #GtkListStore
+ * @position: the position of the first row to replace
+ * @n_removed: the number of rows to replace, or -1 for all rows
+ *     from @position to the end
+ * @n_added: the number of rows to put in their place
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_added * @n_values GValues, laid
+ *     out as for gtk_list_store_insert_rows()
+ * @n_values: the length of the @columns array
+ *
+ * Replaces @n_removed rows starting at @position with @n_added new
+ * rows, setting the columns listed in @columns to the corresponding
+ * values in @values.
+ *
+ * Rows that exist both before and after the replacement are updated
+ * in place and only emit #GtkTreeModel::row-changed, so replacing a
+ * range with one of the same size keeps selections and expansions
+ * that refer to it. The remaining rows are removed or inserted as by
+ * gtk_list_store_remove_rows() and gtk_list_store_insert_rows(). If
+ * the list store is sorted, all @n_removed rows are removed and the
+ * new rows are inserted at their sorted positions.
+ *
+ * All changes are emitted between a single
+ * #GtkListStore::begin-bulk-update and #GtkListStore::end-bulk-update.
+ *
+ * Since: 3.10
+ */
+void
+gtk_list_store_replace_rows (GtkListStore *list_store,
+                             gint          position,
+                             gint          n_removed,
+                             gint          n_added,
+                             gint         *columns,
+                             GValue       *values,
+                             gint          n_values)
+{
+  GtkListStorePrivate *priv;
+  gint length;
+  gint n_kept;
+  gint i;
+
+  g_return_if_fail (GTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (position >= 0);
+  g_return_if_fail (n_added >= 0);
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  priv = list_store->priv;
+
+  length = g_sequence_get_length (priv->seq);
+  if (position > length)
+    position = length;
+  if (n_removed < 0 || n_removed > length - position)
+    n_removed = length - position;
+
+  if (GTK_LIST_STORE_IS_SORTED (list_store))
+    n_kept = 0;
+  else
+    n_kept = MIN (n_removed, n_added);
+
+  gtk_list_store_begin_bulk_update (list_store);
+
+  for (i = 0; i < n_kept; i++)
+    {
+      GtkTreeIter iter;
+
+      /* Handlers may have shrunk the store */
+      if (position + i >= g_sequence_get_length (priv->seq))
+        break;
+
+      iter.stamp = priv->stamp;
+      iter.user_data = g_sequence_get_iter_at_pos (priv->seq, position + i);
+
+      gtk_list_store_set_valuesv (list_store, &iter,
+                                  columns, values + i * n_values, n_values);
+    }
+
+  if (n_removed > n_kept)
+    gtk_list_store_remove_rows (list_store, position + n_kept, n_removed - n_kept);
+  else if (n_added > n_kept)
+    gtk_list_store_insert_rows (list_store, position + n_kept, n_added - n_kept,
+                                columns, values + n_kept * n_values, n_values);
+
+  gtk_list_store_end_bulk_update (list_store);
+}
+
 /* GtkBuildable custom tag implementation
  *
  * <columns>
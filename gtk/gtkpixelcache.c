@@ -22,36 +22,118 @@
 
 #define BLOW_CACHE_TIMEOUT_SEC 20
 
-/* The extra size of the offscreen surface we allocate
+/* The cache is made up of square tiles of this size, positioned
+   on a grid in canvas coordinates, so they stay valid when scrolling */
+#define TILE_SIZE 256
+
+/* The extra area around the view we keep rendered
    to make scrolling more efficient */
 #define EXTRA_SIZE 64
 
-/* When resizing viewport to smaller we allow this extra
-   size to avoid constantly reallocating when resizing */
-#define ALLOW_LARGER_SIZE 32
+/* Memory we allow for tiles that are not needed to draw the
+   current view, so scrolling back doesn't have to repaint */
+#define MAX_CACHE_SIZE (8 * 1024 * 1024)
 
-struct _GtkPixelCache {
+typedef struct _GtkPixelCacheTile GtkPixelCacheTile;
+
+struct _GtkPixelCacheTile {
+  GList link;                   /* in GtkPixelCache.lru */
   cairo_surface_t *surface;
 
-  /* Valid if surface != NULL */
-  int surface_x;
-  int surface_y;
-  int surface_w;
-  int surface_h;
-  double surface_scale;
+  /* Position in canvas coordinates, a multiple of TILE_SIZE */
+  int x;
+  int y;
+
+  /* In tile coordinates, may be null if not dirty */
+  cairo_region_t *dirty;
+};
+
+struct _GtkPixelCache {
+  GHashTable *tiles;
+  /* Most recently used tiles first */
+  GQueue lru;
 
-  /* may be null if not dirty */
-  cairo_region_t *surface_dirty;
+  /* Valid if there are tiles */
+  cairo_content_t content;
+  int scale;
 
   guint timeout_tag;
 };
 
+static guint
+gtk_pixel_cache_tile_hash (gconstpointer key)
+{
+  const GtkPixelCacheTile *tile = key;
+
+  return (guint) tile->x * 31 + (guint) tile->y;
+}
+
+static gboolean
+gtk_pixel_cache_tile_equal (gconstpointer a,
+                            gconstpointer b)
+{
+  const GtkPixelCacheTile *tile_a = a;
+  const GtkPixelCacheTile *tile_b = b;
+
+  return tile_a->x == tile_b->x && tile_a->y == tile_b->y;
+}
+
+static void
+gtk_pixel_cache_tile_free (GtkPixelCacheTile *tile)
+{
+  cairo_surface_destroy (tile->surface);
+
+  if (tile->dirty != NULL)
+    cairo_region_destroy (tile->dirty);
+
+  g_slice_free (GtkPixelCacheTile, tile);
+}
+
+static void
+gtk_pixel_cache_tile_invalidate (GtkPixelCacheTile *tile)
+{
+  cairo_rectangle_int_t r;
+
+  r.x = 0;
+  r.y = 0;
+  r.width = TILE_SIZE;
+  r.height = TILE_SIZE;
+
+  if (tile->dirty != NULL)
+    cairo_region_destroy (tile->dirty);
+  tile->dirty = cairo_region_create_rectangle (&r);
+}
+
+/* Rounds down to the start of the tile containing @pos */
+static int
+tile_start (int pos)
+{
+  if (pos >= 0)
+    return pos - pos % TILE_SIZE;
+  else
+    return pos - (TILE_SIZE - 1 - (-pos - 1) % TILE_SIZE);
+}
+
+static void
+gtk_pixel_cache_clear (GtkPixelCache *cache)
+{
+  GList *link;
+
+  g_hash_table_remove_all (cache->tiles);
+
+  while ((link = g_queue_pop_head_link (&cache->lru)) != NULL)
+    gtk_pixel_cache_tile_free (link->data);
+}
+
 GtkPixelCache *
 _gtk_pixel_cache_new ()
 {
   GtkPixelCache *cache;
 
   cache = g_new0 (GtkPixelCache, 1);
+  cache->tiles = g_hash_table_new (gtk_pixel_cache_tile_hash,
+                                   gtk_pixel_cache_tile_equal);
+  g_queue_init (&cache->lru);
 
   return cache;
 }
@@ -65,11 +147,8 @@ _gtk_pixel_cache_free (GtkPixelCache *cache)
   if (cache->timeout_tag)
     g_source_remove (cache->timeout_tag);
 
-  if (cache->surface != NULL)
-    cairo_surface_destroy (cache->surface);
-
-  if (cache->surface_dirty != NULL)
-    cairo_region_destroy (cache->surface_dirty);
+  gtk_pixel_cache_clear (cache);
+  g_hash_table_destroy (cache->tiles);
 
   g_free (cache);
 }
@@ -79,220 +158,117 @@ void
 _gtk_pixel_cache_invalidate (GtkPixelCache *cache,
 			     cairo_region_t *region)
 {
-  cairo_rectangle_int_t r;
-  cairo_region_t *free_region = NULL;
+  GList *l;
 
-  if (cache->surface == NULL ||
-      (region != NULL && cairo_region_is_empty (region)))
+  if (region != NULL && cairo_region_is_empty (region))
     return;
 
-  if (region == NULL)
-    {
-      r.x = cache->surface_x;
-      r.y = cache->surface_y;
-      r.width = cache->surface_w;
-      r.height = cache->surface_h;
-
-      free_region = region =
-	cairo_region_create_rectangle (&r);
-    }
-
-  if (cache->surface_dirty == NULL)
-    {
-      cache->surface_dirty = cairo_region_copy (region);
-      cairo_region_translate (cache->surface_dirty,
-			      -cache->surface_x,
-			      -cache->surface_y);
-    }
-  else
+  for (l = cache->lru.head; l; l = l->next)
     {
-      cairo_region_translate (region,
-			      -cache->surface_x,
-			      -cache->surface_y);
-      cairo_region_union (cache->surface_dirty, region);
-      cairo_region_translate (region,
-			      cache->surface_x,
-			      cache->surface_y);
+      GtkPixelCacheTile *tile = l->data;
+      cairo_region_t *tile_region;
+      cairo_rectangle_int_t r;
+
+      if (region == NULL)
+        {
+          gtk_pixel_cache_tile_invalidate (tile);
+          continue;
+        }
+
+      r.x = tile->x;
+      r.y = tile->y;
+      r.width = TILE_SIZE;
+      r.height = TILE_SIZE;
+
+      if (cairo_region_contains_rectangle (region, &r) == CAIRO_REGION_OVERLAP_OUT)
+        continue;
+
+      tile_region = cairo_region_copy (region);
+      cairo_region_intersect_rectangle (tile_region, &r);
+      cairo_region_translate (tile_region, -tile->x, -tile->y);
+
+      if (tile->dirty == NULL)
+        tile->dirty = tile_region;
+      else
+        {
+          cairo_region_union (tile->dirty, tile_region);
+          cairo_region_destroy (tile_region);
+        }
     }
-
-  if (free_region)
-    cairo_region_destroy (free_region);
-
-  r.x = 0;
-  r.y = 0;
-  r.width = cache->surface_w;
-  r.height = cache->surface_h;
-
-  cairo_region_intersect_rectangle (cache->surface_dirty, &r);
 }
 
-static void
-_gtk_pixel_cache_create_surface_if_needed (GtkPixelCache         *cache,
-					   GdkWindow             *window,
-					   cairo_rectangle_int_t *view_rect,
-					   cairo_rectangle_int_t *canvas_rect)
+static cairo_content_t
+gtk_pixel_cache_get_content (GdkWindow *window)
 {
-  cairo_rectangle_int_t rect;
-  int surface_w, surface_h;
-  cairo_content_t content;
   cairo_pattern_t *bg;
   double red, green, blue, alpha;
 
-  content = CAIRO_CONTENT_COLOR_ALPHA;
   bg = gdk_window_get_background_pattern (window);
   if (bg != NULL &&
       cairo_pattern_get_type (bg) == CAIRO_PATTERN_TYPE_SOLID &&
       cairo_pattern_get_rgba (bg, &red, &green, &blue, &alpha) == CAIRO_STATUS_SUCCESS &&
       alpha == 1.0)
-    content = CAIRO_CONTENT_COLOR;
-
-  surface_w = view_rect->width;
-  if (canvas_rect->width > surface_w)
-    surface_w = MIN (surface_w + EXTRA_SIZE, canvas_rect->width);
-
-  surface_h = view_rect->height;
-  if (canvas_rect->height > surface_h)
-    surface_h = MIN (surface_h + EXTRA_SIZE, canvas_rect->height);
-
-  /* If current surface can't fit view_rect or is too large, kill it */
-  if (cache->surface != NULL &&
-      (cairo_surface_get_content (cache->surface) != content ||
-       cache->surface_w < view_rect->width ||
-       cache->surface_w > surface_w + ALLOW_LARGER_SIZE ||
-       cache->surface_h < view_rect->height ||
-       cache->surface_h > surface_h + ALLOW_LARGER_SIZE ||
-       cache->surface_scale != gdk_window_get_scale_factor (window)))
-    {
-      cairo_surface_destroy (cache->surface);
-      cache->surface = NULL;
-      if (cache->surface_dirty)
-	cairo_region_destroy (cache->surface_dirty);
-      cache->surface_dirty = NULL;
-    }
+    return CAIRO_CONTENT_COLOR;
 
-  /* Don't allocate a surface if view >= canvas, as we won't
-     be scrolling then anyway */
-  if (cache->surface == NULL &&
-      (view_rect->width < canvas_rect->width ||
-       view_rect->height < canvas_rect->height))
-    {
-      cache->surface_x = -canvas_rect->x;
-      cache->surface_y = -canvas_rect->y;
-      cache->surface_w = surface_w;
-      cache->surface_h = surface_h;
-      cache->surface_scale = gdk_window_get_scale_factor (window);
-
-      cache->surface =
-	gdk_window_create_similar_surface (window, content,
-					   surface_w, surface_h);
-      rect.x = 0;
-      rect.y = 0;
-      rect.width = surface_w;
-      rect.height = surface_h;
-      cache->surface_dirty =
-	cairo_region_create_rectangle (&rect);
-    }
+  return CAIRO_CONTENT_COLOR_ALPHA;
 }
 
-void
-_gtk_pixel_cache_set_position (GtkPixelCache         *cache,
-			       cairo_rectangle_int_t *view_rect,
-			       cairo_rectangle_int_t *canvas_rect)
+/* Looks up the tile at @x, @y, creating it if needed, and
+   marks it as the most recently used one */
+static GtkPixelCacheTile *
+gtk_pixel_cache_ensure_tile (GtkPixelCache *cache,
+                             GdkWindow     *window,
+                             int            x,
+                             int            y)
 {
-  cairo_rectangle_int_t r, view_pos;
-  cairo_region_t *copy_region;
-  int new_surf_x, new_surf_y;
-  cairo_t *backing_cr;
+  GtkPixelCacheTile key, *tile;
 
-  if (cache->surface == NULL)
-    return;
+  key.x = x;
+  key.y = y;
+  tile = g_hash_table_lookup (cache->tiles, &key);
 
-  /* Position of view inside canvas */
-  view_pos.x = -canvas_rect->x;
-  view_pos.y = -canvas_rect->y;
-  view_pos.width = view_rect->width;
-  view_pos.height = view_rect->height;
-
-  /* Reposition so all is visible */
-  if (view_pos.x < cache->surface_x ||
-      view_pos.x + view_pos.width >
-      cache->surface_x + cache->surface_w ||
-      view_pos.y < cache->surface_y ||
-      view_pos.y + view_pos.height >
-      cache->surface_y + cache->surface_h)
+  if (tile == NULL)
     {
-      new_surf_x = cache->surface_x;
-      if (view_pos.x < cache->surface_x)
-	new_surf_x = MAX (view_pos.x + view_pos.width - cache->surface_w, 0);
-      else if (view_pos.x + view_pos.width >
-	       cache->surface_x + cache->surface_w)
-	new_surf_x = MIN (view_pos.x, canvas_rect->width - cache->surface_w);
-
-      new_surf_y = cache->surface_y;
-      if (view_pos.y < cache->surface_y)
-	new_surf_y = MAX (view_pos.y + view_pos.height - cache->surface_h, 0);
-      else if (view_pos.y + view_pos.height >
-	       cache->surface_y + cache->surface_h)
-	new_surf_y = MIN (view_pos.y, canvas_rect->height - cache->surface_h);
-
-      r.x = 0;
-      r.y = 0;
-      r.width = cache->surface_w;
-      r.height = cache->surface_h;
-      copy_region = cairo_region_create_rectangle (&r);
-
-      if (cache->surface_dirty)
-	{
-	  cairo_region_subtract (copy_region, cache->surface_dirty);
-	  cairo_region_destroy (cache->surface_dirty);
-	  cache->surface_dirty = NULL;
-	}
-
-      cairo_region_translate (copy_region,
-			      cache->surface_x - new_surf_x,
-			      cache->surface_y - new_surf_y);
-      cairo_region_intersect_rectangle (copy_region, &r);
-
-      backing_cr = cairo_create (cache->surface);
-      gdk_cairo_region (backing_cr, copy_region);
-      cairo_set_operator (backing_cr, CAIRO_OPERATOR_SOURCE);
-      cairo_clip (backing_cr);
-      cairo_push_group (backing_cr);
-      cairo_set_source_surface (backing_cr, cache->surface,
-				cache->surface_x - new_surf_x,
-				cache->surface_y - new_surf_y);
-      cairo_paint (backing_cr);
-      cairo_pop_group_to_source (backing_cr);
-      cairo_paint (backing_cr);
-      cairo_destroy (backing_cr);
+      tile = g_slice_new0 (GtkPixelCacheTile);
+      tile->link.data = tile;
+      tile->x = x;
+      tile->y = y;
+      tile->surface =
+	gdk_window_create_similar_surface (window, cache->content,
+					   TILE_SIZE, TILE_SIZE);
+      gtk_pixel_cache_tile_invalidate (tile);
+
+      g_hash_table_add (cache->tiles, tile);
+    }
+  else
+    g_queue_unlink (&cache->lru, &tile->link);
 
-      cache->surface_x = new_surf_x;
-      cache->surface_y = new_surf_y;
+  g_queue_push_head_link (&cache->lru, &tile->link);
 
-      cairo_region_xor_rectangle (copy_region, &r);
-      cache->surface_dirty = copy_region;
-    }
+  return tile;
 }
 
-void
-_gtk_pixel_cache_repaint (GtkPixelCache *cache,
-			  GtkPixelCacheDrawFunc draw,
-			  cairo_rectangle_int_t *view_rect,
-			  cairo_rectangle_int_t *canvas_rect,
-			  gpointer user_data)
+static void
+gtk_pixel_cache_repaint_tile (GtkPixelCache         *cache,
+                              GtkPixelCacheTile     *tile,
+                              GtkPixelCacheDrawFunc  draw,
+                              cairo_rectangle_int_t *view_rect,
+                              cairo_rectangle_int_t *canvas_rect,
+                              gpointer               user_data)
 {
   cairo_t *backing_cr;
 
-  if (cache->surface &&
-      cache->surface_dirty &&
-      !cairo_region_is_empty (cache->surface_dirty))
+  if (tile->dirty == NULL)
+    return;
+
+  if (!cairo_region_is_empty (tile->dirty))
     {
-      backing_cr = cairo_create (cache->surface);
-      gdk_cairo_region (backing_cr, cache->surface_dirty);
+      backing_cr = cairo_create (tile->surface);
+      gdk_cairo_region (backing_cr, tile->dirty);
       cairo_clip (backing_cr);
       cairo_translate (backing_cr,
-		       -cache->surface_x - canvas_rect->x - view_rect->x,
-		       -cache->surface_y - canvas_rect->y - view_rect->y);
+		       -tile->x - canvas_rect->x - view_rect->x,
+		       -tile->y - canvas_rect->y - view_rect->y);
       cairo_set_source_rgba (backing_cr,
 			     0.0, 0, 0, 0.0);
       cairo_set_operator (backing_cr, CAIRO_OPERATOR_SOURCE);
@@ -325,10 +301,27 @@ _gtk_pixel_cache_repaint (GtkPixelCache *cache,
       cairo_destroy (backing_cr);
     }
 
-  if (cache->surface_dirty)
+  cairo_region_destroy (tile->dirty);
+  tile->dirty = NULL;
+}
+
+/* Drops the least recently used tiles that are over budget,
+   but never one of the @n_needed ones used for this draw */
+static void
+gtk_pixel_cache_evict (GtkPixelCache *cache,
+                       guint          n_needed)
+{
+  guint max_tiles;
+
+  max_tiles = MAX_CACHE_SIZE / (TILE_SIZE * TILE_SIZE * 4 * cache->scale * cache->scale);
+  max_tiles = MAX (max_tiles, n_needed);
+
+  while (cache->lru.length > max_tiles)
     {
-      cairo_region_destroy (cache->surface_dirty);
-      cache->surface_dirty = NULL;
+      GtkPixelCacheTile *tile = g_queue_pop_tail_link (&cache->lru)->data;
+
+      g_hash_table_remove (cache->tiles, tile);
+      gtk_pixel_cache_tile_free (tile);
     }
 }
 
@@ -339,14 +332,7 @@ blow_cache_cb  (gpointer user_data)
 
   cache->timeout_tag = 0;
 
-  if (cache->surface)
-    {
-      cairo_surface_destroy (cache->surface);
-      cache->surface = NULL;
-      if (cache->surface_dirty)
-	cairo_region_destroy (cache->surface_dirty);
-      cache->surface_dirty = NULL;
-    }
+  gtk_pixel_cache_clear (cache);
 
   return G_SOURCE_REMOVE;
 }
@@ -363,36 +349,108 @@ _gtk_pixel_cache_draw (GtkPixelCache *cache,
 		       GtkPixelCacheDrawFunc draw,
 		       gpointer user_data)
 {
+  cairo_rectangle_int_t view_pos, area;
+  cairo_content_t content;
+  GtkPixelCacheTile *tile;
+  guint n_needed;
+  int scale, x, y;
+
   if (cache->timeout_tag)
     g_source_remove (cache->timeout_tag);
 
   cache->timeout_tag = g_timeout_add_seconds (BLOW_CACHE_TIMEOUT_SEC,
 					      blow_cache_cb, cache);
 
-  _gtk_pixel_cache_create_surface_if_needed (cache, window,
-					     view_rect, canvas_rect);
-  _gtk_pixel_cache_set_position (cache, view_rect, canvas_rect);
-  _gtk_pixel_cache_repaint (cache, draw, view_rect, canvas_rect, user_data);
+  content = gtk_pixel_cache_get_content (window);
+  scale = gdk_window_get_scale_factor (window);
+  if (cache->content != content || cache->scale != scale)
+    {
+      gtk_pixel_cache_clear (cache);
+      cache->content = content;
+      cache->scale = scale;
+    }
 
-  if (cache->surface &&
-      /* Don't use backing surface if rendering elsewhere */
-      cairo_surface_get_type (cache->surface) == cairo_surface_get_type (cairo_get_target (cr)))
+  /* Don't cache anything if view >= canvas, as we won't
+     be scrolling then anyway */
+  if (view_rect->width >= canvas_rect->width &&
+      view_rect->height >= canvas_rect->height)
     {
-      cairo_save (cr);
-      cairo_set_source_surface (cr, cache->surface,
-				cache->surface_x + view_rect->x + canvas_rect->x,
-				cache->surface_y + view_rect->y + canvas_rect->y);
-      cairo_rectangle (cr, view_rect->x, view_rect->y,
+      gtk_pixel_cache_clear (cache);
+
+      cairo_rectangle (cr,
+		       view_rect->x, view_rect->y,
 		       view_rect->width, view_rect->height);
-      cairo_fill (cr);
-      cairo_restore (cr);
+      cairo_clip (cr);
+      draw (cr, user_data);
+      return;
     }
-  else
+
+  /* Position of view inside canvas */
+  view_pos.x = -canvas_rect->x;
+  view_pos.y = -canvas_rect->y;
+  view_pos.width = view_rect->width;
+  view_pos.height = view_rect->height;
+
+  /* The area we keep rendered, clamped to the canvas */
+  area.x = MAX (view_pos.x - EXTRA_SIZE, 0);
+  area.y = MAX (view_pos.y - EXTRA_SIZE, 0);
+  area.width = MIN (view_pos.x + view_pos.width + EXTRA_SIZE, canvas_rect->width) - area.x;
+  area.height = MIN (view_pos.y + view_pos.height + EXTRA_SIZE, canvas_rect->height) - area.y;
+  area.width = MAX (area.width, view_pos.x + view_pos.width - area.x);
+  area.height = MAX (area.height, view_pos.y + view_pos.height - area.y);
+
+  if (area.width <= 0 || area.height <= 0)
+    return;
+
+  /* Don't use backing surface if rendering elsewhere, and don't
+     repaint the tiles either then */
+  tile = gtk_pixel_cache_ensure_tile (cache, window, tile_start (area.x), tile_start (area.y));
+  if (cairo_surface_get_type (tile->surface) != cairo_surface_get_type (cairo_get_target (cr)))
     {
       cairo_rectangle (cr,
 		       view_rect->x, view_rect->y,
 		       view_rect->width, view_rect->height);
       cairo_clip (cr);
       draw (cr, user_data);
+      return;
     }
+
+  n_needed = 0;
+  for (y = tile_start (area.y); y < area.y + area.height; y += TILE_SIZE)
+    for (x = tile_start (area.x); x < area.x + area.width; x += TILE_SIZE)
+      {
+        tile = gtk_pixel_cache_ensure_tile (cache, window, x, y);
+        gtk_pixel_cache_repaint_tile (cache, tile, draw, view_rect, canvas_rect, user_data);
+        n_needed++;
+      }
+
+  gtk_pixel_cache_evict (cache, n_needed);
+
+  cairo_save (cr);
+  for (y = tile_start (view_pos.y); y < view_pos.y + view_pos.height; y += TILE_SIZE)
+    for (x = tile_start (view_pos.x); x < view_pos.x + view_pos.width; x += TILE_SIZE)
+      {
+        GtkPixelCacheTile key;
+        cairo_rectangle_int_t r;
+
+        key.x = x;
+        key.y = y;
+        tile = g_hash_table_lookup (cache->tiles, &key);
+
+        r.x = x;
+        r.y = y;
+        r.width = TILE_SIZE;
+        r.height = TILE_SIZE;
+        gdk_rectangle_intersect (&r, &view_pos, &r);
+
+        cairo_set_source_surface (cr, tile->surface,
+                                  tile->x + view_rect->x + canvas_rect->x,
+                                  tile->y + view_rect->y + canvas_rect->y);
+        cairo_rectangle (cr,
+                         r.x + view_rect->x + canvas_rect->x,
+                         r.y + view_rect->y + canvas_rect->y,
+                         r.width, r.height);
+        cairo_fill (cr);
+      }
+  cairo_restore (cr);
 }
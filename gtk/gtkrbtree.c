@@ -488,6 +488,86 @@ _gtk_rbtree_insert_after (GtkRBTree *tree,
   return node;
 }
 
+static GtkRBNode *
+gtk_rbtree_build_helper (GtkRBTree *tree,
+                         GtkRBNode *parent,
+                         guint      n_nodes,
+                         guint      depth,
+                         guint      black_depth,
+                         gint       height,
+                         gboolean   valid)
+{
+  GtkRBNode *node;
+  guint n_left;
+
+  if (n_nodes == 0)
+    return (GtkRBNode *) &nil;
+
+  n_left = (n_nodes - 1) / 2;
+
+  node = _gtk_rbnode_new (tree, height);
+  node->parent = parent;
+  node->left = gtk_rbtree_build_helper (tree, node, n_left,
+                                        depth + 1, black_depth, height, valid);
+  node->right = gtk_rbtree_build_helper (tree, node, n_nodes - n_left - 1,
+                                         depth + 1, black_depth, height, valid);
+
+  /* All levels above black_depth are complete, so making them black
+   * and the (partial) last level red gives every path the same number
+   * of black nodes without any red node having a red child.
+   */
+  node->flags = depth < black_depth ? GTK_RBNODE_BLACK : GTK_RBNODE_RED;
+  if (!valid)
+    node->flags |= GTK_RBNODE_INVALID | GTK_RBNODE_DESCENDANTS_INVALID;
+
+  node->count = n_nodes;
+  node->total_count = n_nodes;
+  node->offset = height + node->left->offset + node->right->offset;
+
+  return node;
+}
+
+/**
+ * _gtk_rbtree_build:
+ * @tree: an empty tree
+ * @n_nodes: the number of nodes to create
+ * @height: the height of each node
+ * @valid: whether the nodes should be marked valid
+ *
+ * Fills @tree with @n_nodes nodes in one go. This builds a balanced
+ * tree directly in O(n_nodes) instead of doing @n_nodes inserts each
+ * followed by rebalancing, which matters when a large model is set on
+ * a tree view or a row with many children is expanded.
+ *
+ * Returns: the first node of @tree or %NULL if @n_nodes is 0
+ **/
+GtkRBNode *
+_gtk_rbtree_build (GtkRBTree *tree,
+                   guint      n_nodes,
+                   gint       height,
+                   gboolean   valid)
+{
+  g_return_val_if_fail (_gtk_rbtree_is_nil (tree->root), NULL);
+
+  if (n_nodes == 0)
+    return NULL;
+
+  tree->root = gtk_rbtree_build_helper (tree, (GtkRBNode *) &nil, n_nodes,
+                                        0, g_bit_storage (n_nodes + 1) - 1,
+                                        height, valid);
+
+  /* This also propagates the validity of the new nodes upwards */
+  gtk_rbnode_adjust (tree->parent_tree, tree->parent_node,
+                     0, n_nodes, tree->root->offset);
+
+#ifdef G_ENABLE_DEBUG  
+  if (gtk_get_debug_flags () & GTK_DEBUG_TREE)
+    _gtk_rbtree_test (G_STRLOC, tree);
+#endif /* G_ENABLE_DEBUG */  
+
+  return _gtk_rbtree_first (tree);
+}
+
 GtkRBNode *
 _gtk_rbtree_insert_before (GtkRBTree *tree,
 			   GtkRBNode *current,
@@ -83,6 +83,41 @@ pop_recursion_check (GtkWidget       *widget,
 #endif
 }
 
+#ifdef G_ENABLE_DEBUG
+typedef struct {
+  guint hits;
+  guint misses;
+} SizeRequestStats;
+
+/* Per widget type hit/miss counters of the size request cache,
+ * reported with GTK_DEBUG=size-request.
+ */
+static SizeRequestStats *
+count_cache_lookup (GtkWidget *widget,
+                    gboolean   found_in_cache)
+{
+  static GHashTable *stats_by_type = NULL;
+  SizeRequestStats *stats;
+
+  if (G_UNLIKELY (stats_by_type == NULL))
+    stats_by_type = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  stats = g_hash_table_lookup (stats_by_type, GSIZE_TO_POINTER (G_OBJECT_TYPE (widget)));
+  if (stats == NULL)
+    {
+      stats = g_new0 (SizeRequestStats, 1);
+      g_hash_table_insert (stats_by_type, GSIZE_TO_POINTER (G_OBJECT_TYPE (widget)), stats);
+    }
+
+  if (found_in_cache)
+    stats->hits++;
+  else
+    stats->misses++;
+
+  return stats;
+}
+#endif /* G_ENABLE_DEBUG */
+
 static const char *
 get_vfunc_name (GtkOrientation orientation,
                 gint           for_size)
@@ -340,6 +375,7 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
   g_assert (min_size <= nat_size);
 
   GTK_NOTE (SIZE_REQUEST,
+            SizeRequestStats *stats = count_cache_lookup (widget, found_in_cache);
             g_print ("[%p] %s\t%s: %d is minimum %d and natural: %d",
                      widget, G_OBJECT_TYPE_NAME (widget),
                      orientation == GTK_ORIENTATION_HORIZONTAL ?
@@ -348,8 +384,11 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
 	    if (min_baseline != -1 || nat_baseline != -1)
 	      g_print (", baseline %d/%d",
 		       min_baseline, nat_baseline);
-	    g_print (" (hit cache: %s)\n",
-		     found_in_cache ? "yes" : "no")
+	    g_print (" (hit cache: %s, %u/%u hits for %s, %u cached ranges)\n",
+		     found_in_cache ? "yes" : "no",
+		     stats->hits, stats->hits + stats->misses,
+		     G_OBJECT_TYPE_NAME (widget),
+		     cache->flags[orientation].n_cached_requests)
 	    );
 }
 
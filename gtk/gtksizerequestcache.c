@@ -32,34 +32,38 @@ _gtk_size_request_cache_init (SizeRequestCache *cache)
 }
 
 static void
-free_sizes_x (SizeRequestX **sizes)
+free_sizes_x (SizeRequestX **sizes,
+              guint          n_allocated)
 {
-  gint i;
+  guint i;
 
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
+  for (i = 0; i < n_allocated && sizes[i] != NULL; i++)
     g_slice_free (SizeRequestX, sizes[i]);
 
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  g_free (sizes);
 }
 
 static void
-free_sizes_y (SizeRequestY **sizes)
+free_sizes_y (SizeRequestY **sizes,
+              guint          n_allocated)
 {
-  gint i;
+  guint i;
 
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
+  for (i = 0; i < n_allocated && sizes[i] != NULL; i++)
     g_slice_free (SizeRequestY, sizes[i]);
 
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  g_free (sizes);
 }
 
 void
 _gtk_size_request_cache_free (SizeRequestCache *cache)
 {
   if (cache->requests_x)
-    free_sizes_x (cache->requests_x);
+    free_sizes_x (cache->requests_x,
+                  cache->flags[GTK_ORIENTATION_HORIZONTAL].n_allocated_requests);
   if (cache->requests_y)
-    free_sizes_y (cache->requests_y);
+    free_sizes_y (cache->requests_y,
+                  cache->flags[GTK_ORIENTATION_VERTICAL].n_allocated_requests);
 }
 
 void
@@ -69,6 +73,55 @@ _gtk_size_request_cache_clear (SizeRequestCache *cache)
   _gtk_size_request_cache_init (cache);
 }
 
+/* Picks the slot that the next committed range goes into.
+ *
+ * As long as there is unused room we just append. Once the cache is
+ * full we would have to start evicting entries in a round-robin
+ * fashion, which for a widget that gets queried for more distinct
+ * for_sizes than we have room for means we miss every time. So
+ * instead of evicting we grow the cache (up to
+ * GTK_SIZE_REQUEST_MAX_CACHED_SIZES), which only ever happens for the
+ * few widgets that actually need it.
+ */
+static guint
+allocate_request (SizeRequestCache  *cache,
+                  GtkOrientation     orientation,
+                  gpointer         **requests)
+{
+  guint n_sizes, n_allocated;
+
+  n_sizes = cache->flags[orientation].n_cached_requests;
+  n_allocated = cache->flags[orientation].n_allocated_requests;
+
+  if (n_sizes == n_allocated && n_allocated < GTK_SIZE_REQUEST_MAX_CACHED_SIZES)
+    {
+      guint new_allocated;
+
+      if (n_allocated == 0)
+        new_allocated = GTK_SIZE_REQUEST_CACHED_SIZES;
+      else
+        new_allocated = MIN (n_allocated * 2, GTK_SIZE_REQUEST_MAX_CACHED_SIZES);
+
+      *requests = g_renew (gpointer, *requests, new_allocated);
+      memset (*requests + n_allocated, 0, sizeof (gpointer) * (new_allocated - n_allocated));
+      cache->flags[orientation].n_allocated_requests = new_allocated;
+      n_allocated = new_allocated;
+    }
+
+  if (n_sizes < n_allocated)
+    {
+      cache->flags[orientation].n_cached_requests++;
+      cache->flags[orientation].last_cached_request = n_sizes;
+    }
+  else
+    {
+      if (++cache->flags[orientation].last_cached_request == n_allocated)
+        cache->flags[orientation].last_cached_request = 0;
+    }
+
+  return cache->flags[orientation].last_cached_request;
+}
+
 void
 _gtk_size_request_cache_commit (SizeRequestCache *cache,
                                 GtkOrientation    orientation,
@@ -131,26 +184,13 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	}
 
       /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
-
-      if (cache->requests_x == NULL)
-	cache->requests_x = g_slice_alloc0 (sizeof (SizeRequestX *) * GTK_SIZE_REQUEST_CACHED_SIZES);
+       * will immediately be used to cache the new computed size */
+      i = allocate_request (cache, orientation, (gpointer **) &cache->requests_x);
 
-      if (cache->requests_x[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_x[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestX);
+      if (cache->requests_x[i] == NULL)
+	cache->requests_x[i] = g_slice_new (SizeRequestX);
 
-      cached_size = cache->requests_x[cache->flags[orientation].last_cached_request];
+      cached_size = cache->requests_x[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -176,26 +216,13 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	}
 
       /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
-
-      if (cache->requests_y == NULL)
-	cache->requests_y = g_slice_alloc0 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES);
+       * will immediately be used to cache the new computed size */
+      i = allocate_request (cache, orientation, (gpointer **) &cache->requests_y);
 
-      if (cache->requests_y[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_y[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestY);
+      if (cache->requests_y[i] == NULL)
+	cache->requests_y[i] = g_slice_new (SizeRequestY);
 
-      cached_size = cache->requests_y[cache->flags[orientation].last_cached_request];
+      cached_size = cache->requests_y[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -230,12 +257,17 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 	}
       else
 	{
-	  guint i;
+	  guint i, n_sizes, last;
 
-	  /* Search for an already cached size */
-	  for (i = 0; i < cache->flags[orientation].n_cached_requests; i++)
+	  n_sizes = cache->flags[orientation].n_cached_requests;
+	  last = cache->flags[orientation].last_cached_request;
+
+	  /* Search for an already cached size, starting with the one we
+	   * committed last as that is by far the most likely to be asked
+	   * for again (e.g. during a single allocation pass). */
+	  for (i = 0; i < n_sizes; i++)
 	    {
-	      SizeRequestX *cur = cache->requests_x[i];
+	      SizeRequestX *cur = cache->requests_x[(last + i) % n_sizes];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -268,12 +300,17 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 	}
       else
 	{
-	  guint i;
+	  guint i, n_sizes, last;
+
+	  n_sizes = cache->flags[orientation].n_cached_requests;
+	  last = cache->flags[orientation].last_cached_request;
 
-	  /* Search for an already cached size */
-	  for (i = 0; i < cache->flags[orientation].n_cached_requests; i++)
+	  /* Search for an already cached size, starting with the one we
+	   * committed last as that is by far the most likely to be asked
+	   * for again (e.g. during a single allocation pass). */
+	  for (i = 0; i < n_sizes; i++)
 	    {
-	      SizeRequestY *cur = cache->requests_y[i];
+	      SizeRequestY *cur = cache->requests_y[(last + i) % n_sizes];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
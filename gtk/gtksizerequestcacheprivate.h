@@ -35,8 +35,17 @@ G_BEGIN_DECLS
  * for a said widget to have, if a label can
  * only wrap to 3 lines, only 3 caches will
  * ever be allocated for it.
+ *
+ * Widgets start out with room for
+ * GTK_SIZE_REQUEST_CACHED_SIZES ranges, the
+ * cache only grows (up to
+ * GTK_SIZE_REQUEST_MAX_CACHED_SIZES) once it
+ * would have to evict an entry, i.e. for
+ * widgets that are actually churning through
+ * many different for_sizes.
  */
-#define GTK_SIZE_REQUEST_CACHED_SIZES   (5)
+#define GTK_SIZE_REQUEST_CACHED_SIZES     (5)
+#define GTK_SIZE_REQUEST_MAX_CACHED_SIZES (16)
 
 typedef struct {
   gint minimum_size;
@@ -74,8 +83,9 @@ typedef struct {
   GtkSizeRequestMode request_mode   : 3;
   guint       request_mode_valid    : 1;
   struct {
-    guint       n_cached_requests   : 3;
-    guint       last_cached_request : 3;
+    guint       n_cached_requests   : 5;
+    guint       n_allocated_requests: 5;
+    guint       last_cached_request : 5;
     guint       cached_size_valid   : 1;
   }           flags[2];
 } SizeRequestCache;
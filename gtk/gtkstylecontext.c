@@ -319,6 +319,7 @@ typedef struct GtkStyleInfo GtkStyleInfo;
 typedef struct GtkRegion GtkRegion;
 typedef struct PropertyValue PropertyValue;
 typedef struct StyleData StyleData;
+typedef struct SharedValuesKey SharedValuesKey;
 
 struct GtkRegion
 {
@@ -351,6 +352,21 @@ struct StyleData
   guint ref_count;
 };
 
+/* Computed values are shared between all style contexts that use the
+ * same cascade and end up with the same lookup result, parent values
+ * and scale. Shared values are never modified after they have been
+ * computed, so only values that can not animate are shared.
+ */
+struct SharedValuesKey
+{
+  GHashTable           *table;          /* the table this key lives in */
+  GtkCssComputedValues *values;         /* the shared values, not owned */
+  GtkCssComputedValues *parent_values;
+  gint                  scale;
+  guint                 hash;
+  GtkCssLookupValue    *lookup_values;  /* _gtk_css_style_property_get_n_properties() values */
+};
+
 struct _GtkStyleContextPrivate
 {
   GdkScreen *screen;
@@ -369,6 +385,7 @@ struct _GtkStyleContextPrivate
   guint frame_clock_update_id;
 
   GtkCssChange relevant_changes;
+  GtkCssChange descendant_changes; /* superset of relevant_changes of all descendants */
   GtkCssChange pending_changes;
 
   const GtkBitmask *invalidating_context;
@@ -391,6 +408,9 @@ enum {
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+static GQuark quark_shared_values;
+static GQuark quark_shared_values_table;
+
 static void gtk_style_context_finalize (GObject *object);
 
 static void gtk_style_context_impl_set_property (GObject      *object,
@@ -427,6 +447,9 @@ gtk_style_context_class_init (GtkStyleContextClass *klass)
   object_class->set_property = gtk_style_context_impl_set_property;
   object_class->get_property = gtk_style_context_impl_get_property;
 
+  quark_shared_values = g_quark_from_static_string ("gtk-style-context-shared-values");
+  quark_shared_values_table = g_quark_from_static_string ("gtk-style-context-shared-values-table");
+
   klass->changed = gtk_style_context_real_changed;
 
   signals[CHANGED] =
@@ -666,6 +689,187 @@ style_info_equal (gconstpointer elem1,
   return TRUE;
 }
 
+static guint
+shared_values_key_hash (gconstpointer elem)
+{
+  const SharedValuesKey *key = elem;
+
+  return key->hash;
+}
+
+static gboolean
+shared_values_key_equal (gconstpointer elem1,
+                         gconstpointer elem2)
+{
+  const SharedValuesKey *key1 = elem1;
+  const SharedValuesKey *key2 = elem2;
+
+  if (key1->hash != key2->hash ||
+      key1->parent_values != key2->parent_values ||
+      key1->scale != key2->scale)
+    return FALSE;
+
+  return memcmp (key1->lookup_values,
+                 key2->lookup_values,
+                 sizeof (GtkCssLookupValue) * _gtk_css_style_property_get_n_properties ()) == 0;
+}
+
+static void
+shared_values_key_init (SharedValuesKey      *key,
+                        const GtkCssLookup   *lookup,
+                        GtkCssComputedValues *parent_values,
+                        gint                  scale)
+{
+  guint i, n, hash;
+
+  n = _gtk_css_style_property_get_n_properties ();
+
+  hash = GPOINTER_TO_UINT (parent_values) ^ scale;
+  for (i = 0; i < n; i++)
+    {
+      hash = (hash << 5) - hash + GPOINTER_TO_UINT (lookup->values[i].value);
+      hash = (hash << 5) - hash + GPOINTER_TO_UINT (lookup->values[i].computed);
+    }
+
+  key->table = NULL;
+  key->values = NULL;
+  key->parent_values = parent_values;
+  key->scale = scale;
+  key->hash = hash;
+  /* Not copied, only valid as long as the lookup is */
+  key->lookup_values = (GtkCssLookupValue *) lookup->values;
+}
+
+static void
+shared_values_key_free (SharedValuesKey *key)
+{
+  guint i, n;
+
+  n = _gtk_css_style_property_get_n_properties ();
+
+  for (i = 0; i < n; i++)
+    {
+      if (key->lookup_values[i].section)
+        gtk_css_section_unref (key->lookup_values[i].section);
+      if (key->lookup_values[i].value)
+        _gtk_css_value_unref (key->lookup_values[i].value);
+      if (key->lookup_values[i].computed)
+        _gtk_css_value_unref (key->lookup_values[i].computed);
+    }
+  g_free (key->lookup_values);
+
+  if (key->parent_values)
+    g_object_unref (key->parent_values);
+
+  g_slice_free (SharedValuesKey, key);
+}
+
+static void
+shared_values_finalized (gpointer  data,
+                         GObject  *where_the_object_was)
+{
+  SharedValuesKey *key = data;
+
+  g_hash_table_steal (key->table, key);
+  shared_values_key_free (key);
+}
+
+static void
+shared_values_key_destroy (gpointer data)
+{
+  SharedValuesKey *key = data;
+
+  g_object_weak_unref (G_OBJECT (key->values), shared_values_finalized, key);
+  shared_values_key_free (key);
+}
+
+static SharedValuesKey *
+shared_values_key_copy (const SharedValuesKey *key,
+                        GHashTable            *table,
+                        GtkCssComputedValues  *values)
+{
+  SharedValuesKey *copy;
+  guint i, n;
+
+  n = _gtk_css_style_property_get_n_properties ();
+
+  copy = g_slice_new (SharedValuesKey);
+  copy->table = table;
+  copy->values = values;
+  copy->parent_values = key->parent_values ? g_object_ref (key->parent_values) : NULL;
+  copy->scale = key->scale;
+  copy->hash = key->hash;
+  copy->lookup_values = g_memdup (key->lookup_values, sizeof (GtkCssLookupValue) * n);
+
+  /* Keep the lookup results alive so their addresses can't be reused */
+  for (i = 0; i < n; i++)
+    {
+      if (copy->lookup_values[i].section)
+        gtk_css_section_ref (copy->lookup_values[i].section);
+      if (copy->lookup_values[i].value)
+        _gtk_css_value_ref (copy->lookup_values[i].value);
+      if (copy->lookup_values[i].computed)
+        _gtk_css_value_ref (copy->lookup_values[i].computed);
+    }
+
+  g_object_weak_ref (G_OBJECT (values), shared_values_finalized, copy);
+
+  return copy;
+}
+
+static void
+shared_values_table_cascade_changed (GtkStyleCascade *cascade,
+                                     gpointer         unused)
+{
+  g_object_set_qdata (G_OBJECT (cascade), quark_shared_values_table, NULL);
+}
+
+/* Values can depend on the provider in ways the lookup doesn't see,
+ * like symbolic colors, so start from scratch when it changes. This
+ * must be connected before any context connects to @cascade, so the
+ * table is cleared before the contexts look up their new values. */
+static void
+shared_values_table_watch (GtkStyleCascade *cascade)
+{
+  if (!g_signal_handler_find (cascade,
+                              G_SIGNAL_MATCH_FUNC,
+                              0, 0, NULL,
+                              shared_values_table_cascade_changed,
+                              NULL))
+    g_signal_connect (cascade,
+                      "-gtk-private-changed",
+                      G_CALLBACK (shared_values_table_cascade_changed),
+                      NULL);
+}
+
+static GHashTable *
+shared_values_table_get (GtkStyleCascade *cascade)
+{
+  GHashTable *table;
+
+  table = g_object_get_qdata (G_OBJECT (cascade), quark_shared_values_table);
+  if (table)
+    return table;
+
+  table = g_hash_table_new_full (shared_values_key_hash,
+                                 shared_values_key_equal,
+                                 shared_values_key_destroy,
+                                 NULL);
+  g_object_set_qdata_full (G_OBJECT (cascade),
+                           quark_shared_values_table,
+                           table,
+                           (GDestroyNotify) g_hash_table_unref);
+  shared_values_table_watch (cascade);
+
+  return table;
+}
+
+static gboolean
+computed_values_is_shared (GtkCssComputedValues *values)
+{
+  return g_object_get_qdata (G_OBJECT (values), quark_shared_values) != NULL;
+}
+
 static void
 gtk_style_context_cascade_changed (GtkStyleCascade *cascade,
                                    GtkStyleContext *context)
@@ -687,6 +891,7 @@ gtk_style_context_set_cascade (GtkStyleContext *context,
   if (cascade)
     {
       g_object_ref (cascade);
+      shared_values_table_watch (cascade);
       g_signal_connect (cascade,
                         "-gtk-private-changed",
                         G_CALLBACK (gtk_style_context_cascade_changed),
@@ -722,6 +927,7 @@ gtk_style_context_init (GtkStyleContext *style_context)
 
   priv->screen = gdk_screen_get_default ();
   priv->relevant_changes = GTK_CSS_CHANGE_ANY;
+  priv->descendant_changes = GTK_CSS_CHANGE_ANY;
 
   /* Create default info store */
   priv->info = style_info_new ();
@@ -1002,6 +1208,70 @@ build_properties (GtkStyleContext      *context,
   gtk_widget_path_free (path);
 }
 
+static GtkCssComputedValues *
+build_shared_properties (GtkStyleContext *context,
+                         GtkStyleInfo    *info)
+{
+  GtkStyleContextPrivate *priv;
+  GtkCssComputedValues *values, *parent_values;
+  GtkCssMatcher matcher;
+  GtkWidgetPath *path;
+  GtkCssLookup *lookup;
+  SharedValuesKey key, *found;
+  GHashTable *table;
+
+  priv = context->priv;
+
+  parent_values = priv->parent ? style_data_lookup (priv->parent)->store : NULL;
+
+  /* Values computed from a parent that can still change can't be
+   * looked up by that parent, so only share below shared values. */
+  if ((parent_values != NULL && !computed_values_is_shared (parent_values)) ||
+      G_UNLIKELY (gtk_get_debug_flags () & GTK_DEBUG_NO_CSS_CACHE))
+    {
+      values = _gtk_css_computed_values_new ();
+      build_properties (context, values, info, NULL);
+      return values;
+    }
+
+  path = create_query_path (context, info);
+  lookup = _gtk_css_lookup_new (NULL);
+
+  if (_gtk_css_matcher_init (&matcher, path, info->state_flags))
+    _gtk_style_provider_private_lookup (GTK_STYLE_PROVIDER_PRIVATE (priv->cascade),
+                                        &matcher,
+                                        lookup);
+
+  table = shared_values_table_get (priv->cascade);
+  shared_values_key_init (&key, lookup, parent_values, priv->scale);
+
+  found = g_hash_table_lookup (table, &key);
+  if (found)
+    {
+      values = g_object_ref (found->values);
+    }
+  else
+    {
+      values = _gtk_css_computed_values_new ();
+      _gtk_css_lookup_resolve (lookup,
+                               GTK_STYLE_PROVIDER_PRIVATE (priv->cascade),
+                               priv->scale,
+                               values,
+                               parent_values);
+
+      if (!_gtk_css_computed_values_can_animate (values))
+        {
+          g_object_set_qdata (G_OBJECT (values), quark_shared_values, GUINT_TO_POINTER (TRUE));
+          g_hash_table_add (table, shared_values_key_copy (&key, table, values));
+        }
+    }
+
+  _gtk_css_lookup_free (lookup);
+  gtk_widget_path_free (path);
+
+  return values;
+}
+
 static StyleData *
 style_data_lookup (GtkStyleContext *context)
 {
@@ -1026,14 +1296,12 @@ style_data_lookup (GtkStyleContext *context)
     }
 
   data = style_data_new ();
-  data->store = _gtk_css_computed_values_new ();
+  data->store = build_shared_properties (context, info);
   style_info_set_data (info, data);
   g_hash_table_insert (priv->style_data,
                        style_info_copy (info),
                        data);
 
-  build_properties (context, data->store, info, NULL);
-
   return data;
 }
 
@@ -1076,6 +1344,20 @@ gtk_style_context_set_invalid (GtkStyleContext *context,
     }
 }
 
+/* Called when the changes relevant to @context's subtree may have
+ * grown, so ancestors must stop pruning their walks to it. If a
+ * context already has unknown descendant changes, so do all of its
+ * ancestors. */
+static void
+gtk_style_context_reset_descendant_changes (GtkStyleContext *context)
+{
+  while (context && context->priv->descendant_changes != GTK_CSS_CHANGE_ANY)
+    {
+      context->priv->descendant_changes = GTK_CSS_CHANGE_ANY;
+      context = context->priv->parent;
+    }
+}
+
 /* returns TRUE if someone called gtk_style_context_save() but hasn't
  * called gtk_style_context_restore() yet.
  * In those situations we don't invalidate the context when somebody
@@ -1693,6 +1975,7 @@ gtk_style_context_set_parent (GtkStyleContext *context,
       g_object_ref (parent);
       if (priv->invalid)
         gtk_style_context_set_invalid (parent, TRUE);
+      gtk_style_context_reset_descendant_changes (parent);
     }
 
   if (priv->parent)
@@ -2283,6 +2566,27 @@ _gtk_style_context_peek_property (GtkStyleContext *context,
   return _gtk_css_computed_values_get_value (data->store, property_id);
 }
 
+/**
+ * _gtk_style_context_peek_shared_values:
+ * @context: a #GtkStyleContext
+ *
+ * Returns the current values of @context if they are shared with
+ * other contexts. Shared values never change, so they can be used
+ * as a key for caching things derived from them.
+ *
+ * Returns: (transfer none): the values or %NULL if they aren't shared
+ **/
+GtkCssComputedValues *
+_gtk_style_context_peek_shared_values (GtkStyleContext *context)
+{
+  StyleData *data = style_data_lookup (context);
+
+  if (!computed_values_is_shared (data->store))
+    return NULL;
+
+  return data->store;
+}
+
 const GValue *
 _gtk_style_context_peek_style_property (GtkStyleContext *context,
                                         GType            widget_type,
@@ -3117,8 +3421,20 @@ gtk_style_context_update_cache (GtkStyleContext  *context,
 
       changes = _gtk_css_computed_values_compute_dependencies (data->store, parent_changes);
 
-      if (!_gtk_bitmask_is_empty (changes))
-	build_properties (context, data->store, info, changes);
+      if (_gtk_bitmask_is_empty (changes))
+        {
+          /* nothing to do */
+        }
+      else if (computed_values_is_shared (data->store))
+        {
+          /* Shared values must not change, get new ones */
+          GtkCssComputedValues *store = build_shared_properties (context, info);
+
+          g_object_unref (data->store);
+          data->store = store;
+        }
+      else
+        build_properties (context, data->store, info, changes);
 
       _gtk_bitmask_free (changes);
     }
@@ -3224,6 +3540,32 @@ gtk_style_context_should_create_transitions (GtkStyleContext *context)
   return animate;
 }
 
+/* Checks if validating @child and its descendants would be a no-op:
+ * nothing is queued on them, no value they could inherit changed and
+ * no selector matching any of them depends on @change. This keeps
+ * state changes like hovering from walking whole subtrees. */
+static gboolean
+gtk_style_context_child_can_skip (GtkStyleContext  *child,
+                                  GtkCssChange      change,
+                                  const GtkBitmask *parent_changes)
+{
+  GtkStyleContextPrivate *priv = child->priv;
+
+  if (priv->invalid)
+    return FALSE;
+
+  if (!_gtk_bitmask_is_empty (parent_changes))
+    return FALSE;
+
+  if (change & GTK_CSS_CHANGE_FORCE_INVALIDATE)
+    return FALSE;
+
+  if (G_UNLIKELY (gtk_get_debug_flags () & GTK_DEBUG_NO_CSS_CACHE))
+    return FALSE;
+
+  return (change & (priv->relevant_changes | priv->descendant_changes)) == 0;
+}
+
 void
 _gtk_style_context_validate (GtkStyleContext  *context,
                              gint64            timestamp,
@@ -3234,6 +3576,7 @@ _gtk_style_context_validate (GtkStyleContext  *context,
   GtkStyleInfo *info;
   StyleData *current;
   GtkBitmask *changes;
+  GtkCssChange descendant_changes;
   GSList *list;
 
   g_return_if_fail (GTK_IS_STYLE_CONTEXT (context));
@@ -3347,10 +3690,23 @@ _gtk_style_context_validate (GtkStyleContext  *context,
     }
 
   change = _gtk_css_change_for_child (change);
+  descendant_changes = 0;
   for (list = priv->children; list; list = list->next)
     {
-      _gtk_style_context_validate (list->data, timestamp, change, changes);
+      GtkStyleContextPrivate *child_priv = GTK_STYLE_CONTEXT (list->data)->priv;
+
+      if (!gtk_style_context_child_can_skip (list->data, change, changes))
+        _gtk_style_context_validate (list->data, timestamp, change, changes);
+
+      descendant_changes |= child_priv->relevant_changes | child_priv->descendant_changes;
     }
+  priv->descendant_changes = descendant_changes;
+
+  /* We might have been validated on our own, make sure our parent
+   * doesn't skip us for changes we just started caring about. */
+  if (priv->parent &&
+      ((priv->relevant_changes | priv->descendant_changes) & ~priv->parent->priv->descendant_changes))
+    gtk_style_context_reset_descendant_changes (priv->parent);
 
   _gtk_bitmask_free (changes);
 }
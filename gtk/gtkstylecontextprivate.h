@@ -21,6 +21,7 @@
 #include "gtkstylecontext.h"
 #include "gtkstyleproviderprivate.h"
 #include "gtkbitmaskprivate.h"
+#include "gtkcsscomputedvaluesprivate.h"
 #include "gtkcssvalueprivate.h"
 
 G_BEGIN_DECLS
@@ -32,6 +33,8 @@ const GtkBitmask *
 
 GtkCssValue   * _gtk_style_context_peek_property             (GtkStyleContext *context,
                                                               guint            property_id);
+GtkCssComputedValues *
+                _gtk_style_context_peek_shared_values        (GtkStyleContext *context);
 const GValue * _gtk_style_context_peek_style_property        (GtkStyleContext *context,
                                                               GType            widget_type,
                                                               GtkStateFlags    state,
@@ -2315,18 +2315,19 @@ _gtk_text_btree_get_tags (const GtkTextIter *iter,
   return tagInfo.tags;
 }
 
-static void
-copy_segment (GString *string,
-              gboolean include_hidden,
-              gboolean include_nonchars,
-              const GtkTextIter *start,
-              const GtkTextIter *end)
+static gboolean
+chunk_segment (GtkTextBufferChunkFunc  func,
+               gpointer                user_data,
+               gboolean                include_hidden,
+               gboolean                include_nonchars,
+               const GtkTextIter      *start,
+               const GtkTextIter      *end)
 {
   GtkTextLineSegment *end_seg;
   GtkTextLineSegment *seg;
 
   if (gtk_text_iter_equal (start, end))
-    return;
+    return TRUE;
 
   seg = _gtk_text_iter_get_indexable_segment (start);
   end_seg = _gtk_text_iter_get_indexable_segment (end);
@@ -2365,12 +2366,9 @@ copy_segment (GString *string,
         {
           g_assert ((copy_start + copy_bytes) <= seg->byte_count);
 
-          g_string_append_len (string,
-                               seg->body.chars + copy_start,
-                               copy_bytes);
+          return (* func) (seg->body.chars + copy_start, copy_bytes,
+                           user_data);
         }
-
-      /* printf ("  :%s\n", string->str); */
     }
   else if (seg->type == &gtk_text_pixbuf_type ||
            seg->type == &gtk_text_child_type)
@@ -2389,58 +2387,92 @@ copy_segment (GString *string,
 
       if (copy)
         {
-          g_string_append_len (string,
-                               _gtk_text_unknown_char_utf8,
-                               GTK_TEXT_UNKNOWN_CHAR_UTF8_LEN);
-
+          return (* func) (_gtk_text_unknown_char_utf8,
+                           GTK_TEXT_UNKNOWN_CHAR_UTF8_LEN,
+                           user_data);
         }
     }
+
+  return TRUE;
 }
 
-gchar*
-_gtk_text_btree_get_text (const GtkTextIter *start_orig,
-                         const GtkTextIter *end_orig,
-                         gboolean include_hidden,
-                         gboolean include_nonchars)
+/* Passes the text in the range to @func piece by piece, without
+ * copying it: each chunk points into the storage of a segment. Stops
+ * and returns %FALSE as soon as @func does.
+ */
+gboolean
+_gtk_text_btree_foreach_chunk (const GtkTextIter      *start_orig,
+                               const GtkTextIter      *end_orig,
+                               gboolean                include_hidden,
+                               gboolean                include_nonchars,
+                               GtkTextBufferChunkFunc  func,
+                               gpointer                user_data)
 {
   GtkTextLineSegment *seg;
   GtkTextLineSegment *end_seg;
-  GString *retval;
-  gchar *str;
   GtkTextIter iter;
   GtkTextIter start;
   GtkTextIter end;
 
-  g_return_val_if_fail (start_orig != NULL, NULL);
-  g_return_val_if_fail (end_orig != NULL, NULL);
+  g_return_val_if_fail (start_orig != NULL, FALSE);
+  g_return_val_if_fail (end_orig != NULL, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
   g_return_val_if_fail (_gtk_text_iter_get_btree (start_orig) ==
-                        _gtk_text_iter_get_btree (end_orig), NULL);
+                        _gtk_text_iter_get_btree (end_orig), FALSE);
 
   start = *start_orig;
   end = *end_orig;
 
   gtk_text_iter_order (&start, &end);
 
-  retval = g_string_new (NULL);
-
   end_seg = _gtk_text_iter_get_indexable_segment (&end);
   iter = start;
   seg = _gtk_text_iter_get_indexable_segment (&iter);
   while (seg != end_seg)
     {
-      copy_segment (retval, include_hidden, include_nonchars,
-                    &iter, &end);
+      if (!chunk_segment (func, user_data, include_hidden, include_nonchars,
+                          &iter, &end))
+        return FALSE;
 
       _gtk_text_iter_forward_indexable_segment (&iter);
 
       seg = _gtk_text_iter_get_indexable_segment (&iter);
     }
 
-  copy_segment (retval, include_hidden, include_nonchars, &iter, &end);
+  return chunk_segment (func, user_data, include_hidden, include_nonchars,
+                        &iter, &end);
+}
 
-  str = retval->str;
-  g_string_free (retval, FALSE);
-  return str;
+static gboolean
+append_chunk (const gchar *text,
+              gsize        len,
+              gpointer     user_data)
+{
+  g_string_append_len (user_data, text, len);
+
+  return TRUE;
+}
+
+gchar*
+_gtk_text_btree_get_text (const GtkTextIter *start_orig,
+                         const GtkTextIter *end_orig,
+                         gboolean include_hidden,
+                         gboolean include_nonchars)
+{
+  GString *retval;
+
+  g_return_val_if_fail (start_orig != NULL, NULL);
+  g_return_val_if_fail (end_orig != NULL, NULL);
+  g_return_val_if_fail (_gtk_text_iter_get_btree (start_orig) ==
+                        _gtk_text_iter_get_btree (end_orig), NULL);
+
+  retval = g_string_new (NULL);
+
+  _gtk_text_btree_foreach_chunk (start_orig, end_orig,
+                                 include_hidden, include_nonchars,
+                                 append_chunk, retval);
+
+  return g_string_free (retval, FALSE);
 }
 
 gint
@@ -5429,6 +5461,39 @@ _gtk_text_btree_validate_line (GtkTextBTree     *tree,
     }
 }
 
+/**
+ * _gtk_text_btree_resize_line:
+ * @tree: a #GtkTextBTree
+ * @line: a line with valid data for the view
+ * @view_id: view ID for the view
+ * @width: new width of the line
+ * @height: new height of the line
+ *
+ * Changes the size of a line that is already valid for the given view,
+ * e.g. once its real size replaces an estimate, and propagates the
+ * change up through the entire tree.
+ **/
+void
+_gtk_text_btree_resize_line (GtkTextBTree     *tree,
+                             GtkTextLine      *line,
+                             gpointer          view_id,
+                             gint              width,
+                             gint              height)
+{
+  GtkTextLineData *ld;
+
+  g_return_if_fail (tree != NULL);
+  g_return_if_fail (line != NULL);
+
+  ld = _gtk_text_line_get_data (line, view_id);
+  g_return_if_fail (ld != NULL && ld->valid);
+
+  ld->width = width;
+  ld->height = height;
+
+  gtk_text_btree_node_check_valid_upward (line->parent, view_id);
+}
+
 static void
 gtk_text_btree_node_remove_view (BTreeView *view, GtkTextBTreeNode *node, gpointer view_id)
 {
@@ -107,6 +107,11 @@ gboolean     _gtk_text_btree_validate          (GtkTextBTree      *tree,
 void         _gtk_text_btree_validate_line     (GtkTextBTree      *tree,
                                                 GtkTextLine       *line,
                                                 gpointer           view_id);
+void         _gtk_text_btree_resize_line       (GtkTextBTree      *tree,
+                                                GtkTextLine       *line,
+                                                gpointer           view_id,
+                                                gint               width,
+                                                gint               height);
 
 /* Tag */
 
@@ -134,6 +139,12 @@ gchar        *_gtk_text_btree_get_text          (const GtkTextIter *start,
                                                  const GtkTextIter *end,
                                                  gboolean           include_hidden,
                                                  gboolean           include_nonchars);
+gboolean      _gtk_text_btree_foreach_chunk     (const GtkTextIter *start,
+                                                 const GtkTextIter *end,
+                                                 gboolean           include_hidden,
+                                                 gboolean           include_nonchars,
+                                                 GtkTextBufferChunkFunc func,
+                                                 gpointer           user_data);
 gint          _gtk_text_btree_line_count        (GtkTextBTree      *tree);
 gint          _gtk_text_btree_char_count        (GtkTextBTree      *tree);
 gboolean      _gtk_text_btree_char_is_invisible (const GtkTextIter *iter);
@@ -978,6 +978,95 @@ gtk_text_buffer_insert_at_cursor (GtkTextBuffer *buffer,
   gtk_text_buffer_insert (buffer, &iter, text, len);
 }
 
+/**
+ * gtk_text_buffer_append_lines:
+ * @buffer: a #GtkTextBuffer
+ * @lines: (array length=n_lines): lines of UTF-8 text, without terminators
+ * @n_lines: the number of lines, or -1 if @lines is %NULL-terminated
+ * @max_lines: the maximum number of lines to keep in @buffer, or 0
+ *   for no limit
+ *
+ * Appends @lines at the end of the buffer, each one on its own line.
+ * If the last line of the buffer is not empty, a new line is started
+ * first. All the lines are inserted at once, with a single emission
+ * of #GtkTextBuffer::insert-text, which is much cheaper than inserting
+ * them one by one when many lines arrive together, as when following
+ * a log.
+ *
+ * If @max_lines is positive, the buffer is used as a ring: after the
+ * lines are appended, the oldest lines beyond @max_lines are deleted
+ * from the start of the buffer in a single
+ * #GtkTextBuffer::delete-range emission. Lines of @lines which would
+ * be deleted right away are not inserted at all.
+ *
+ * The insertion and the deletion are grouped in one user action, see
+ * gtk_text_buffer_begin_user_action(), so an undo manager sees them as
+ * one change.
+ *
+ * Since: 3.10
+ **/
+void
+gtk_text_buffer_append_lines (GtkTextBuffer       *buffer,
+                              const gchar * const *lines,
+                              gint                 n_lines,
+                              gint                 max_lines)
+{
+  GtkTextIter start;
+  GtkTextIter end;
+  GString *text;
+  gint line_count;
+  gint first;
+  gint i;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (lines != NULL || n_lines == 0);
+
+  if (n_lines < 0)
+    n_lines = g_strv_length ((gchar **) lines);
+
+  if (n_lines == 0)
+    return;
+
+  first = 0;
+  if (max_lines > 0 && n_lines > max_lines)
+    first = n_lines - max_lines;
+
+  gtk_text_buffer_begin_user_action (buffer);
+
+  gtk_text_buffer_get_end_iter (buffer, &end);
+
+  text = g_string_new (NULL);
+
+  if (!gtk_text_iter_starts_line (&end))
+    g_string_append_c (text, '\n');
+
+  for (i = first; i < n_lines; i++)
+    {
+      if (i > first)
+        g_string_append_c (text, '\n');
+
+      g_string_append (text, lines[i]);
+    }
+
+  gtk_text_buffer_insert (buffer, &end, text->str, text->len);
+
+  g_string_free (text, TRUE);
+
+  /* The text still goes through insert-text and delete-range, a path
+   * that appends to the btree directly would be faster but bypass them.
+   */
+  line_count = gtk_text_buffer_get_line_count (buffer);
+
+  if (max_lines > 0 && line_count > max_lines)
+    {
+      gtk_text_buffer_get_start_iter (buffer, &start);
+      gtk_text_buffer_get_iter_at_line (buffer, &end, line_count - max_lines);
+      gtk_text_buffer_delete (buffer, &start, &end);
+    }
+
+  gtk_text_buffer_end_user_action (buffer);
+}
+
 /**
  * gtk_text_buffer_insert_interactive:
  * @buffer: a #GtkTextBuffer
@@ -1892,6 +1981,153 @@ gtk_text_buffer_get_slice (GtkTextBuffer     *buffer,
     return gtk_text_iter_get_visible_slice (start, end);
 }
 
+/**
+ * gtk_text_buffer_foreach_chunk:
+ * @buffer: a #GtkTextBuffer
+ * @start: start of a range
+ * @end: end of a range
+ * @include_hidden_chars: whether to include invisible text
+ * @func: (scope call): function called with each chunk of text
+ * @user_data: user data passed to @func
+ *
+ * Calls @func with the text in the range [@start,@end), in order and
+ * one piece at a time, until @func returns %FALSE. The concatenation
+ * of the chunks is the string gtk_text_buffer_get_text() returns for
+ * the same arguments, but no copy of the text is made: the chunks
+ * point directly into the storage of the buffer. This makes it
+ * possible to save or hash large buffers without doubling their
+ * memory use.
+ *
+ * The buffer must not be modified from @func.
+ *
+ * Return value: %FALSE if @func stopped the iteration, %TRUE otherwise
+ *
+ * Since: 3.10
+ **/
+gboolean
+gtk_text_buffer_foreach_chunk (GtkTextBuffer          *buffer,
+                               const GtkTextIter      *start,
+                               const GtkTextIter      *end,
+                               gboolean                include_hidden_chars,
+                               GtkTextBufferChunkFunc  func,
+                               gpointer                user_data)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (start != NULL, FALSE);
+  g_return_val_if_fail (end != NULL, FALSE);
+  g_return_val_if_fail (gtk_text_iter_get_buffer (start) == buffer, FALSE);
+  g_return_val_if_fail (gtk_text_iter_get_buffer (end) == buffer, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  return _gtk_text_btree_foreach_chunk (start, end, include_hidden_chars,
+                                        FALSE, func, user_data);
+}
+
+/* Segments are often no longer than a line, so small chunks are
+ * gathered before being written to the stream.
+ */
+#define WRITE_BUFFER_SIZE 65536
+
+typedef struct
+{
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError **error;
+  gchar *buffer;
+  gsize len;
+} StreamWriter;
+
+static gboolean
+stream_writer_flush (StreamWriter *writer)
+{
+  gsize len = writer->len;
+
+  writer->len = 0;
+
+  return len == 0 ||
+         g_output_stream_write_all (writer->stream, writer->buffer, len, NULL,
+                                    writer->cancellable, writer->error);
+}
+
+static gboolean
+stream_writer_write (const gchar *text,
+                     gsize        len,
+                     gpointer     user_data)
+{
+  StreamWriter *writer = user_data;
+
+  if (writer->len + len > WRITE_BUFFER_SIZE &&
+      !stream_writer_flush (writer))
+    return FALSE;
+
+  if (len >= WRITE_BUFFER_SIZE)
+    return g_output_stream_write_all (writer->stream, text, len, NULL,
+                                      writer->cancellable, writer->error);
+
+  memcpy (writer->buffer + writer->len, text, len);
+  writer->len += len;
+
+  return TRUE;
+}
+
+/**
+ * gtk_text_buffer_write_to_stream:
+ * @buffer: a #GtkTextBuffer
+ * @start: start of a range
+ * @end: end of a range
+ * @include_hidden_chars: whether to include invisible text
+ * @stream: a #GOutputStream
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes the text in the range [@start,@end) to @stream, as UTF-8.
+ * The text written is the same as the one gtk_text_buffer_get_text()
+ * returns, but it is never copied in full: it is written in chunks
+ * while walking the buffer, using gtk_text_buffer_foreach_chunk(), so
+ * the memory needed does not depend on the size of the range.
+ *
+ * This function blocks until all the text is written; the buffer
+ * must not be modified meanwhile. @stream is not closed.
+ *
+ * Return value: %TRUE on success, %FALSE if there was an error
+ *
+ * Since: 3.10
+ **/
+gboolean
+gtk_text_buffer_write_to_stream (GtkTextBuffer     *buffer,
+                                 const GtkTextIter *start,
+                                 const GtkTextIter *end,
+                                 gboolean           include_hidden_chars,
+                                 GOutputStream     *stream,
+                                 GCancellable      *cancellable,
+                                 GError           **error)
+{
+  StreamWriter writer;
+  gboolean retval;
+
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (start != NULL, FALSE);
+  g_return_val_if_fail (end != NULL, FALSE);
+  g_return_val_if_fail (gtk_text_iter_get_buffer (start) == buffer, FALSE);
+  g_return_val_if_fail (gtk_text_iter_get_buffer (end) == buffer, FALSE);
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  writer.stream = stream;
+  writer.cancellable = cancellable;
+  writer.error = error;
+  writer.buffer = g_malloc (WRITE_BUFFER_SIZE);
+  writer.len = 0;
+
+  retval = _gtk_text_btree_foreach_chunk (start, end, include_hidden_chars,
+                                          FALSE, stream_writer_write, &writer) &&
+           stream_writer_flush (&writer);
+
+  g_free (writer.buffer);
+
+  return retval;
+}
+
 /*
  * Pixbufs
  */
@@ -58,6 +58,25 @@ typedef enum
 
 typedef struct _GtkTextBTree GtkTextBTree;
 
+/**
+ * GtkTextBufferChunkFunc:
+ * @text: (array length=len) (element-type guint8): a piece of the text,
+ *   not nul-terminated
+ * @len: the length of @text in bytes
+ * @user_data: the data passed to gtk_text_buffer_foreach_chunk()
+ *
+ * The type of the function that receives the text of a #GtkTextBuffer
+ * in gtk_text_buffer_foreach_chunk(). @text points into the storage of
+ * the buffer, so it is only valid during the call.
+ *
+ * Returns: %TRUE to continue with the next chunk, %FALSE to stop
+ *
+ * Since: 3.10
+ */
+typedef gboolean (* GtkTextBufferChunkFunc) (const gchar *text,
+                                             gsize        len,
+                                             gpointer     user_data);
+
 #define GTK_TYPE_TEXT_BUFFER            (gtk_text_buffer_get_type ())
 #define GTK_TEXT_BUFFER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_TEXT_BUFFER, GtkTextBuffer))
 #define GTK_TEXT_BUFFER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GTK_TYPE_TEXT_BUFFER, GtkTextBufferClass))
@@ -170,6 +189,11 @@ GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_insert_at_cursor  (GtkTextBuffer *buffer,
                                         const gchar   *text,
                                         gint           len);
+GDK_AVAILABLE_IN_3_10
+void gtk_text_buffer_append_lines      (GtkTextBuffer       *buffer,
+                                        const gchar * const *lines,
+                                        gint                 n_lines,
+                                        gint                 max_lines);
 
 GDK_AVAILABLE_IN_ALL
 gboolean gtk_text_buffer_insert_interactive           (GtkTextBuffer *buffer,
@@ -240,6 +264,23 @@ gchar          *gtk_text_buffer_get_slice           (GtkTextBuffer     *buffer,
                                                      const GtkTextIter *end,
                                                      gboolean           include_hidden_chars);
 
+GDK_AVAILABLE_IN_3_10
+gboolean        gtk_text_buffer_foreach_chunk       (GtkTextBuffer          *buffer,
+                                                     const GtkTextIter      *start,
+                                                     const GtkTextIter      *end,
+                                                     gboolean                include_hidden_chars,
+                                                     GtkTextBufferChunkFunc  func,
+                                                     gpointer                user_data);
+
+GDK_AVAILABLE_IN_3_10
+gboolean        gtk_text_buffer_write_to_stream     (GtkTextBuffer     *buffer,
+                                                     const GtkTextIter *start,
+                                                     const GtkTextIter *end,
+                                                     gboolean           include_hidden_chars,
+                                                     GOutputStream     *stream,
+                                                     GCancellable      *cancellable,
+                                                     GError           **error);
+
 /* Insert a pixbuf */
 GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_insert_pixbuf         (GtkTextBuffer *buffer,
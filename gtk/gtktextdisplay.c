@@ -846,6 +846,8 @@ gtk_text_layout_draw (GtkTextLayout *layout,
   if (line_list == NULL)
     return; /* nothing on the screen */
 
+  _gtk_text_layout_reserve_line_displays (layout, g_slist_length (line_list));
+
   text_renderer = get_text_renderer ();
   text_renderer_begin (text_renderer, widget, cr);
 
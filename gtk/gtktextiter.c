@@ -4848,6 +4848,366 @@ strbreakup (const char *string,
   return str_array;
 }
 
+/* Search of needles that don't span lines
+ *
+ * Most searches are for a single line of text. For those there is no
+ * need to slice the buffer through iterators: the text of each line is
+ * copied straight out of its char segments into a reused buffer and
+ * scanned with the Boyer-Moore-Horspool algorithm, and the byte index
+ * of a match is turned into iterators with a single lookup. Lines are
+ * only sliced the slow way when the match has to be found on casefolded
+ * text, that is for case insensitive searches where the needle or the
+ * line is not plain ASCII, and for lines with pixbufs or child widgets
+ * when those are to be skipped.
+ */
+
+typedef struct _TextSearch TextSearch;
+
+struct _TextSearch
+{
+  GtkTextBTree *tree;
+  const gchar *needle;      /* casefolded and normalized if case insensitive */
+  gsize needle_len;
+  gsize skip[256];          /* shifts when scanning forward */
+  gsize rskip[256];         /* shifts when scanning backward */
+
+  GString *text;            /* text of line, with nonchars as U+FFFC */
+  GtkTextLine *line;
+  gsize line_bytes;         /* bytes in line, including its terminator */
+
+  guint case_insensitive : 1;
+  guint text_only : 1;
+  guint ascii_needle : 1;
+  guint ascii_text : 1;
+  guint text_has_nonchars : 1;
+};
+
+static inline guchar
+text_search_byte (const TextSearch *search,
+                  guchar            c)
+{
+  return search->case_insensitive ? g_ascii_tolower (c) : c;
+}
+
+static void
+text_search_init (TextSearch        *search,
+                  const GtkTextIter *iter,
+                  const gchar       *needle,
+                  gboolean           case_insensitive,
+                  gboolean           text_only)
+{
+  const guchar *n = (const guchar *) needle;
+  gsize m;
+  gsize i;
+
+  search->tree = _gtk_text_iter_get_btree (iter);
+  search->needle = needle;
+  search->needle_len = m = strlen (needle);
+  search->case_insensitive = case_insensitive;
+  search->text_only = text_only;
+  search->text = g_string_sized_new (256);
+  search->line = NULL;
+
+  search->ascii_needle = TRUE;
+  for (i = 0; i < m; i++)
+    if (n[i] >= 0x80)
+      search->ascii_needle = FALSE;
+
+  for (i = 0; i < 256; i++)
+    search->skip[i] = search->rskip[i] = m;
+
+  /* The needle is already lowercase when case insensitive, and
+   * text_search_byte() folds the text to match.
+   */
+  for (i = 0; i + 1 < m; i++)
+    search->skip[n[i]] = m - 1 - i;
+
+  for (i = m - 1; i > 0; i--)
+    search->rskip[n[i]] = i;
+}
+
+static void
+text_search_free (TextSearch *search)
+{
+  g_string_free (search->text, TRUE);
+}
+
+static void
+text_search_load_line (TextSearch  *search,
+                       GtkTextLine *line)
+{
+  GtkTextLineSegment *seg;
+  gsize i;
+
+  if (search->line == line)
+    return;
+
+  search->line = line;
+  search->text_has_nonchars = FALSE;
+  g_string_truncate (search->text, 0);
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->type == &gtk_text_char_type)
+        g_string_append_len (search->text, seg->body.chars, seg->byte_count);
+      else if (seg->type == &gtk_text_pixbuf_type ||
+               seg->type == &gtk_text_child_type)
+        {
+          g_string_append_len (search->text, _gtk_text_unknown_char_utf8,
+                               GTK_TEXT_UNKNOWN_CHAR_UTF8_LEN);
+          search->text_has_nonchars = TRUE;
+        }
+    }
+
+  search->line_bytes = search->text->len;
+
+  /* The last line ends with a newline that is not part of the buffer */
+  if (_gtk_text_line_next_excluding_last (line) == NULL &&
+      search->text->len > 0 &&
+      search->text->str[search->text->len - 1] == '\n')
+    g_string_truncate (search->text, search->text->len - 1);
+
+  search->ascii_text = TRUE;
+  for (i = 0; i < search->text->len; i++)
+    if ((guchar) search->text->str[i] >= 0x80)
+      {
+        search->ascii_text = FALSE;
+        break;
+      }
+}
+
+/* Positions @iter at byte @index of the current line. A match can end
+ * with the line terminator, and the index after it is the start of
+ * the next line.
+ */
+static void
+text_search_get_iter (TextSearch  *search,
+                      GtkTextIter *iter,
+                      gsize        index)
+{
+  if (index < search->line_bytes)
+    _gtk_text_btree_get_iter_at_line (search->tree, iter, search->line, index);
+  else
+    _gtk_text_btree_get_iter_at_line (search->tree, iter,
+                                      _gtk_text_line_next (search->line), 0);
+}
+
+static inline gboolean
+text_search_matches_at (const TextSearch *search,
+                        const gchar      *p)
+{
+  if (search->case_insensitive)
+    return g_ascii_strncasecmp (p, search->needle, search->needle_len) == 0;
+  else
+    return memcmp (p, search->needle, search->needle_len) == 0;
+}
+
+/* Returns the byte index of the first match in [start, end) of the
+ * current line, or -1.
+ */
+static gssize
+text_search_horspool (const TextSearch *search,
+                      gsize             start,
+                      gsize             end)
+{
+  const gchar *text = search->text->str;
+  gsize m = search->needle_len;
+  guchar last = search->needle[m - 1];
+  gsize pos;
+
+  for (pos = start; pos + m <= end; )
+    {
+      guchar c = text_search_byte (search, text[pos + m - 1]);
+
+      if (c == last && text_search_matches_at (search, text + pos))
+        return pos;
+
+      pos += search->skip[c];
+    }
+
+  return -1;
+}
+
+/* Returns the byte index of the last match in [start, end) of the
+ * current line, or -1.
+ */
+static gssize
+text_search_horspool_backward (const TextSearch *search,
+                               gsize             start,
+                               gsize             end)
+{
+  const gchar *text = search->text->str;
+  gsize m = search->needle_len;
+  guchar first = search->needle[0];
+  gsize pos;
+
+  if (end - start < m)
+    return -1;
+
+  pos = end - m;
+
+  while (TRUE)
+    {
+      guchar c = text_search_byte (search, text[pos]);
+
+      if (c == first && text_search_matches_at (search, text + pos))
+        return pos;
+
+      if (pos < start + search->rskip[c])
+        return -1;
+
+      pos -= search->rskip[c];
+    }
+}
+
+/* Finds the needle in the bytes [start, end) of @line, the first
+ * match if @forward and the last one otherwise. @end may be -1 for
+ * the end of the line.
+ */
+static gboolean
+text_search_line (TextSearch  *search,
+                  GtkTextLine *line,
+                  gint         start,
+                  gint         end,
+                  gboolean     forward,
+                  GtkTextIter *match_start,
+                  GtkTextIter *match_end)
+{
+  GtkTextIter begin;
+  GtkTextIter stop;
+  gchar *haystack;
+  const gchar *found;
+  gssize index;
+
+  text_search_load_line (search, line);
+
+  if (end < 0)
+    end = search->text->len;
+
+  if (end - start < (gint) search->needle_len && !search->case_insensitive)
+    return FALSE;
+
+  if (!(search->text_only && search->text_has_nonchars))
+    {
+      if (!search->case_insensitive ||
+          (search->ascii_needle && search->ascii_text))
+        {
+          if (forward)
+            index = text_search_horspool (search, start, end);
+          else
+            index = text_search_horspool_backward (search, start, end);
+
+          if (index < 0)
+            return FALSE;
+
+          text_search_get_iter (search, match_start, index);
+          text_search_get_iter (search, match_end, index + search->needle_len);
+          return TRUE;
+        }
+
+      /* Casefolded ASCII text is still ASCII */
+      if (!search->ascii_needle && search->ascii_text)
+        return FALSE;
+    }
+
+  text_search_get_iter (search, &begin, start);
+
+  if (search->text_only && search->text_has_nonchars)
+    {
+      text_search_get_iter (search, &stop, end);
+      haystack = gtk_text_iter_get_text (&begin, &stop);
+    }
+  else
+    haystack = g_strndup (search->text->str + start, end - start);
+
+  if (!search->case_insensitive)
+    found = forward ? strstr (haystack, search->needle)
+                    : g_strrstr (haystack, search->needle);
+  else
+    found = forward ? utf8_strcasestr (haystack, search->needle)
+                    : utf8_strrcasestr (haystack, search->needle);
+
+  if (found)
+    {
+      *match_start = begin;
+      forward_chars_with_skipping (match_start,
+                                   g_utf8_strlen (haystack, found - haystack),
+                                   FALSE, search->text_only, FALSE);
+
+      *match_end = *match_start;
+      forward_chars_with_skipping (match_end,
+                                   g_utf8_strlen (search->needle, -1),
+                                   FALSE, search->text_only,
+                                   search->case_insensitive);
+    }
+
+  g_free (haystack);
+
+  return found != NULL;
+}
+
+static gboolean
+text_search_forward (TextSearch        *search,
+                     const GtkTextIter *iter,
+                     const GtkTextIter *limit,
+                     GtkTextIter       *match_start,
+                     GtkTextIter       *match_end)
+{
+  GtkTextLine *line;
+  GtkTextLine *limit_line;
+  gint start;
+
+  start = gtk_text_iter_get_line_index (iter);
+  line = _gtk_text_iter_get_text_line (iter);
+  limit_line = limit ? _gtk_text_iter_get_text_line (limit) : NULL;
+
+  while (line != NULL)
+    {
+      if (text_search_line (search, line, start, -1, TRUE,
+                            match_start, match_end))
+        return limit == NULL || gtk_text_iter_compare (match_end, limit) <= 0;
+
+      if (line == limit_line)
+        break;
+
+      line = _gtk_text_line_next_excluding_last (line);
+      start = 0;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+text_search_backward (TextSearch        *search,
+                      const GtkTextIter *iter,
+                      const GtkTextIter *limit,
+                      GtkTextIter       *match_start,
+                      GtkTextIter       *match_end)
+{
+  GtkTextLine *line;
+  GtkTextLine *limit_line;
+  gint end;
+
+  end = gtk_text_iter_get_line_index (iter);
+  line = _gtk_text_iter_get_text_line (iter);
+  limit_line = limit ? _gtk_text_iter_get_text_line (limit) : NULL;
+
+  while (line != NULL)
+    {
+      if (text_search_line (search, line, 0, end, FALSE,
+                            match_start, match_end))
+        return limit == NULL || gtk_text_iter_compare (limit, match_start) <= 0;
+
+      if (line == limit_line)
+        break;
+
+      line = _gtk_text_line_previous (line);
+      end = -1;
+    }
+
+  return FALSE;
+}
+
 /**
  * gtk_text_iter_forward_search:
  * @iter: start of search
@@ -4878,6 +5238,7 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
                               const GtkTextIter *limit)
 {
   gchar **lines = NULL;
+  gint n_lines;
   GtkTextIter match;
   gboolean retval = FALSE;
   GtkTextIter search;
@@ -4919,7 +5280,31 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
 
   /* locate all lines */
 
-  lines = strbreakup (str, "\n", -1, NULL, case_insensitive);
+  lines = strbreakup (str, "\n", -1, &n_lines, case_insensitive);
+
+  if (n_lines == 1 && !visible_only)
+    {
+      TextSearch text_search;
+      GtkTextIter end;
+
+      text_search_init (&text_search, iter, *lines, case_insensitive, !slice);
+
+      if (text_search_forward (&text_search, iter, limit, &match, &end))
+        {
+          retval = TRUE;
+
+          if (match_start)
+            *match_start = match;
+
+          if (match_end)
+            *match_end = end;
+        }
+
+      text_search_free (&text_search);
+      g_strfreev (lines);
+
+      return retval;
+    }
 
   search = *iter;
 
@@ -4961,6 +5346,88 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
   return retval;
 }
 
+/**
+ * gtk_text_iter_forward_search_all:
+ * @iter: start of search
+ * @str: a search string
+ * @flags: flags affecting how the search is done
+ * @limit: (allow-none): location of last possible match end, or %NULL for the end of the buffer
+ *
+ * Finds all the matches of @str between @iter and @limit, in a
+ * single pass over the buffer. The matches are found as by repeated
+ * calls to gtk_text_iter_forward_search(), each one starting at the
+ * end of the previous match, so they do not overlap.
+ *
+ * The matches are returned as pairs of iterators: the element at
+ * index 2 * n is the start of the n-th match, and the one at
+ * index 2 * n + 1 is its end. Like any other iterator, they are
+ * invalidated when the text of the buffer is modified, but applying
+ * tags to the matches does not affect them, so this is suitable to
+ * highlight all the occurrences of @str.
+ *
+ * Returns: (transfer full) (element-type GtkTextIter): a newly
+ *   allocated #GArray of #GtkTextIter, free with g_array_unref()
+ *
+ * Since: 3.10
+ **/
+GArray *
+gtk_text_iter_forward_search_all (const GtkTextIter *iter,
+                                  const gchar       *str,
+                                  GtkTextSearchFlags flags,
+                                  const GtkTextIter *limit)
+{
+  GArray *matches;
+  gchar **lines;
+  gint n_lines;
+  gboolean case_insensitive;
+  GtkTextIter search;
+  GtkTextIter match[2];
+
+  g_return_val_if_fail (iter != NULL, NULL);
+  g_return_val_if_fail (str != NULL, NULL);
+
+  matches = g_array_new (FALSE, FALSE, sizeof (GtkTextIter));
+
+  case_insensitive = (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
+  lines = strbreakup (str, "\n", -1, &n_lines, case_insensitive);
+
+  search = *iter;
+
+  if (n_lines == 1 && (flags & GTK_TEXT_SEARCH_VISIBLE_ONLY) == 0)
+    {
+      TextSearch text_search;
+
+      /* Keep the text of the current line around between matches,
+       * rather than restarting the search for each one.
+       */
+      text_search_init (&text_search, iter, *lines, case_insensitive,
+                        (flags & GTK_TEXT_SEARCH_TEXT_ONLY) != 0);
+
+      while ((limit == NULL || gtk_text_iter_compare (&search, limit) < 0) &&
+             text_search_forward (&text_search, &search, limit,
+                                  &match[0], &match[1]))
+        {
+          g_array_append_vals (matches, match, 2);
+          search = match[1];
+        }
+
+      text_search_free (&text_search);
+    }
+  else
+    {
+      while (gtk_text_iter_forward_search (&search, str, flags,
+                                           &match[0], &match[1], limit))
+        {
+          g_array_append_vals (matches, match, 2);
+          search = match[1];
+        }
+    }
+
+  g_strfreev (lines);
+
+  return matches;
+}
+
 static gboolean
 vectors_equal_ignoring_trailing (gchar    **vec1,
                                  gchar    **vec2,
@@ -5245,6 +5712,32 @@ gtk_text_iter_backward_search (const GtkTextIter *iter,
 
   lines = strbreakup (str, "\n", -1, &n_lines, case_insensitive);
 
+  if (n_lines == 1 && !visible_only)
+    {
+      TextSearch text_search;
+      GtkTextIter start_tmp;
+      GtkTextIter end_tmp;
+
+      text_search_init (&text_search, iter, *lines, case_insensitive, !slice);
+
+      if (text_search_backward (&text_search, iter, limit,
+                                &start_tmp, &end_tmp))
+        {
+          retval = TRUE;
+
+          if (match_start)
+            *match_start = start_tmp;
+
+          if (match_end)
+            *match_end = end_tmp;
+        }
+
+      text_search_free (&text_search);
+      g_strfreev (lines);
+
+      return retval;
+    }
+
   win.n_lines = n_lines;
   win.slice = slice;
   win.visible_only = visible_only;
@@ -89,7 +89,14 @@
 
 #define GTK_TEXT_LAYOUT_GET_PRIVATE(o)  ((GtkTextLayoutPrivate *) gtk_text_layout_get_instance_private ((o)))
 
+/* Number of line displays cached before the first draw tells us
+ * how many lines are visible.
+ */
+#define DISPLAY_CACHE_MIN_SIZE 16
+
 typedef struct _GtkTextLayoutPrivate GtkTextLayoutPrivate;
+typedef struct _LineValidator        LineValidator;
+typedef struct _LineValidateJob      LineValidateJob;
 
 struct _GtkTextLayoutPrivate
 {
@@ -97,6 +104,23 @@ struct _GtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   GtkTextLine *cursor_line;
+
+  /* Cache of recently used line displays, most recently used first,
+   * and an index from each GtkTextLine to its link in the queue.
+   */
+  GQueue display_lru;
+  GHashTable *display_cache;
+  guint display_cache_size;
+
+  /* Threaded validation; lines being measured in a worker thread
+   * map to their job in pending_lines.
+   */
+  LineValidator *validator;
+  GHashTable *pending_lines;
+  gint64 measured_height_sum;
+  guint n_measured_heights;
+  guint in_background_validation : 1;
+  guint validation_throttled : 1;
 };
 
 static GtkTextLineData *gtk_text_layout_real_wrap (GtkTextLayout *layout,
@@ -126,6 +150,13 @@ static void gtk_text_layout_emit_changed           (GtkTextLayout     *layout,
 						    gint               new_height);
 
 static void gtk_text_layout_invalidate_all (GtkTextLayout *layout);
+static void display_cache_clear (GtkTextLayout *layout);
+static void gtk_text_layout_stop_threaded_validation (GtkTextLayout *layout);
+static GtkTextLineDisplay *build_line_display (GtkTextLayout *layout,
+                                               GtkTextLine   *line,
+                                               gboolean       size_only,
+                                               gboolean       shape);
+static void line_display_free (GtkTextLineDisplay *display);
 
 static PangoAttribute *gtk_text_attr_appearance_new (const GtkTextAppearance *appearance);
 
@@ -193,12 +224,8 @@ gtk_text_layout_dispose (GObject *object)
   g_clear_object (&layout->ltr_context);
   g_clear_object (&layout->rtl_context);
 
-  if (layout->one_display_cache)
-    {
-      GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      gtk_text_layout_free_line_display (layout, tmp_display);
-    }
+  display_cache_clear (layout);
+  gtk_text_layout_stop_threaded_validation (layout);
 
   if (layout->preedit_attrs != NULL)
     {
@@ -218,6 +245,9 @@ gtk_text_layout_finalize (GObject *object)
 
   g_free (layout->preedit_string);
 
+  g_hash_table_destroy (GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->display_cache);
+  g_hash_table_destroy (GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->pending_lines);
+
   G_OBJECT_CLASS (gtk_text_layout_parent_class)->finalize (object);
 }
 
@@ -276,7 +306,14 @@ gtk_text_layout_class_init (GtkTextLayoutClass *klass)
 static void
 gtk_text_layout_init (GtkTextLayout *text_layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
   text_layout->cursor_visible = TRUE;
+
+  g_queue_init (&priv->display_lru);
+  priv->display_cache = g_hash_table_new (NULL, NULL);
+  priv->display_cache_size = DISPLAY_CACHE_MIN_SIZE;
+  priv->pending_lines = g_hash_table_new (NULL, NULL);
 }
 
 GtkTextLayout*
@@ -310,6 +347,7 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
     return;
 
   free_style_cache (layout);
+  display_cache_clear (layout);
 
   if (layout->buffer)
     {
@@ -635,18 +673,22 @@ text_layout_changed (GtkTextLayout *layout,
                      gint           new_height,
                      gboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l, *next;
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  for (l = priv->display_lru.head; l != NULL; l = next)
     {
-      GtkTextLine *line = layout->one_display_cache->line;
+      GtkTextLineDisplay *display = l->data;
       gint cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
-						    line, layout);
-      gint cache_height = layout->one_display_cache->height;
+						    display->line, layout);
+
+      next = l->next;
 
-      if (cache_y + cache_height > y && cache_y < y + old_height)
-	gtk_text_layout_invalidate_cache (layout, line, cursors_only);
+      if (cache_y + display->height > y && cache_y < y + old_height)
+	gtk_text_layout_invalidate_cache (layout, display->line, cursors_only);
     }
 
   gtk_text_layout_emit_changed (layout, y, old_height, new_height);
@@ -813,15 +855,129 @@ gtk_text_layout_invalidate_all (GtkTextLayout *layout)
   gtk_text_layout_invalidate (layout, &start, &end);
 }
 
+static GtkTextLineDisplay *
+display_cache_lookup (GtkTextLayout *layout,
+                      GtkTextLine   *line)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache, line);
+
+  return link ? link->data : NULL;
+}
+
+static gboolean
+display_is_cached (GtkTextLayout      *layout,
+                   GtkTextLineDisplay *display)
+{
+  return display_cache_lookup (layout, display->line) == display;
+}
+
+/* Drops @display from the cache and frees it */
+static void
+display_cache_remove (GtkTextLayout      *layout,
+                      GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache, display->line);
+  g_assert (link != NULL && link->data == display);
+
+  g_hash_table_remove (priv->display_cache, display->line);
+  g_queue_delete_link (&priv->display_lru, link);
+
+  gtk_text_layout_free_line_display (layout, display);
+}
+
+static void
+display_cache_clear (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  while (priv->display_lru.head)
+    display_cache_remove (layout, priv->display_lru.head->data);
+}
+
+static void
+display_cache_insert (GtkTextLayout      *layout,
+                      GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  while (priv->display_lru.length >= priv->display_cache_size)
+    display_cache_remove (layout, priv->display_lru.tail->data);
+
+  /* Size-only displays are created while wrapping lines that are
+   * usually offscreen; queue them last so that a validation run
+   * only ever replaces the least recently used display instead of
+   * flushing the displays of the visible lines.
+   */
+  if (display->size_only)
+    {
+      g_queue_push_tail (&priv->display_lru, display);
+      g_hash_table_insert (priv->display_cache, display->line,
+                           priv->display_lru.tail);
+    }
+  else
+    {
+      g_queue_push_head (&priv->display_lru, display);
+      g_hash_table_insert (priv->display_cache, display->line,
+                           priv->display_lru.head);
+    }
+}
+
+static void
+display_cache_touch (GtkTextLayout      *layout,
+                     GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache, display->line);
+  if (link != priv->display_lru.head)
+    {
+      g_queue_unlink (&priv->display_lru, link);
+      g_queue_push_head_link (&priv->display_lru, link);
+    }
+}
+
+/*
+ * _gtk_text_layout_reserve_line_displays:
+ * @layout: a #GtkTextLayout
+ * @n_lines: number of lines being drawn
+ *
+ * Makes sure the line display cache can hold the displays of @n_lines
+ * lines plus a margin, so that redrawing or scrolling the visible area
+ * doesn't lay out the same lines over and over. The cache never
+ * shrinks below the largest area drawn so far.
+ */
+void
+_gtk_text_layout_reserve_line_displays (GtkTextLayout *layout,
+                                        guint          n_lines)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  priv->display_cache_size = MAX (priv->display_cache_size,
+                                  n_lines + n_lines / 2);
+}
+
 static void
 gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
                                   GtkTextLine   *line,
 				  gboolean       cursors_only)
 {
-  if (layout->one_display_cache && line == layout->one_display_cache->line)
-    {
-      GtkTextLineDisplay *display = layout->one_display_cache;
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display;
+
+  /* A size being computed for the old contents is useless now */
+  if (!cursors_only)
+    g_hash_table_remove (priv->pending_lines, line);
 
+  display = display_cache_lookup (layout, line);
+  if (display)
+    {
       if (cursors_only)
 	{
           if (display->cursors)
@@ -831,10 +987,7 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
 	  display->has_block_cursor = FALSE;
 	}
       else
-	{
-	  layout->one_display_cache = NULL;
-	  gtk_text_layout_free_line_display (layout, display);
-	}
+	display_cache_remove (layout, display);
     }
 }
 
@@ -926,32 +1079,29 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
 					 const GtkTextIter *start,
 					 const GtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
-   */
-  if (layout->one_display_cache)
-    {
-      GtkTextIter line_start, line_end;
-      GtkTextLine *line = layout->one_display_cache->line;
-
-      gtk_text_layout_get_iter_at_line (layout, &line_start, line, 0);
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  gint start_line, end_line;
+  GList *l;
 
-      line_end = line_start;
-      if (!gtk_text_iter_ends_line (&line_end))
-	gtk_text_iter_forward_to_line_end (&line_end);
+  start_line = gtk_text_iter_get_line (start);
+  end_line = gtk_text_iter_get_line (end);
+  if (start_line > end_line)
+    {
+      gint tmp = start_line;
+      start_line = end_line;
+      end_line = tmp;
+    }
 
-      if (gtk_text_iter_compare (start, end) > 0)
-	{
-	  const GtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
+   */
+  for (l = priv->display_lru.head; l != NULL; l = l->next)
+    {
+      GtkTextLineDisplay *display = l->data;
+      gint line_number = _gtk_text_line_get_number (display->line);
 
-      if (gtk_text_iter_compare (&line_start, end) <= 0 &&
-	  gtk_text_iter_compare (start, &line_end) <= 0)
-	{
-	  gtk_text_layout_invalidate_cache (layout, line, TRUE);
-	}
+      if (line_number >= start_line && line_number <= end_line)
+	gtk_text_layout_invalidate_cache (layout, display->line, TRUE);
     }
 
   gtk_text_layout_invalidated (layout);
@@ -992,6 +1142,417 @@ update_layout_size (GtkTextLayout *layout)
 				&layout->width, &layout->height);
 }
 
+/*
+ * Threaded validation
+ *
+ * Most of the time spent validating a large buffer goes into shaping
+ * the text of each paragraph. When threaded validation is enabled,
+ * lines validated by gtk_text_layout_validate() are laid out on the
+ * main thread as usual, but the text, its attributes and the paragraph
+ * settings are copied into a job that a worker thread shapes. The line
+ * gets an estimated height until the worker is done, then an idle on
+ * the main thread stores the real size in the line data.
+ *
+ * Pango font maps must not be shared between threads, so each worker
+ * shapes with a font map of its own. Only contexts using the default
+ * font map can be reproduced that way.
+ */
+
+#define LINE_VALIDATE_MAX_PENDING 1024
+#define LINE_VALIDATE_MAX_THREADS 4
+#define LINE_VALIDATE_PRIORITY (GDK_PRIORITY_REDRAW + 5)
+
+struct _LineValidator
+{
+  volatile gint ref_count;
+  volatile gint idle_queued;
+
+  /* Jobs done by the workers */
+  GAsyncQueue *results;
+
+  /* Main thread only; NULL once the layout stopped validating
+   * in threads, so that late results are dropped.
+   */
+  GtkTextLayout *layout;
+};
+
+struct _LineValidateJob
+{
+  LineValidator *validator;
+  GtkTextLine *line;
+
+  /* Snapshot of the paragraph, owned by the job */
+  gchar *text;
+  PangoAttrList *attrs;
+  PangoTabArray *tabs;
+  PangoFontDescription *font_desc;
+  PangoLanguage *language;
+  PangoDirection base_dir;
+  cairo_font_options_t *font_options;
+  gdouble resolution;
+  gint width;
+  gint indent;
+  gint spacing;
+  PangoWrapMode wrap;
+  PangoAlignment alignment;
+  gboolean justify;
+  gboolean auto_dir;
+
+  /* Size of the margins around the text */
+  gint margin_width;
+  gint margin_height;
+
+  /* Filled in by the worker */
+  PangoRectangle extents;
+};
+
+static GThreadPool *line_validate_pool = NULL;
+static GPrivate line_validate_font_map = G_PRIVATE_INIT (g_object_unref);
+
+static LineValidator *
+line_validator_new (GtkTextLayout *layout)
+{
+  LineValidator *validator;
+
+  validator = g_slice_new0 (LineValidator);
+  validator->ref_count = 1;
+  validator->results = g_async_queue_new ();
+  validator->layout = layout;
+
+  return validator;
+}
+
+static LineValidator *
+line_validator_ref (LineValidator *validator)
+{
+  g_atomic_int_inc (&validator->ref_count);
+
+  return validator;
+}
+
+static void
+line_validator_unref (LineValidator *validator)
+{
+  if (g_atomic_int_dec_and_test (&validator->ref_count))
+    {
+      g_async_queue_unref (validator->results);
+      g_slice_free (LineValidator, validator);
+    }
+}
+
+static void
+line_validate_job_free (LineValidateJob *job)
+{
+  g_free (job->text);
+  if (job->attrs)
+    pango_attr_list_unref (job->attrs);
+  if (job->tabs)
+    pango_tab_array_free (job->tabs);
+  pango_font_description_free (job->font_desc);
+  if (job->font_options)
+    cairo_font_options_destroy (job->font_options);
+
+  line_validator_unref (job->validator);
+
+  g_slice_free (LineValidateJob, job);
+}
+
+static void
+line_validate_job_finish (GtkTextLayout   *layout,
+                          LineValidateJob *job)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextBTree *btree;
+  GtkTextLineData *line_data;
+  gint width, height, old_height;
+
+  /* The line was changed, measured on the main thread or freed
+   * while the job was running.
+   */
+  if (g_hash_table_lookup (priv->pending_lines, job->line) != job)
+    return;
+
+  g_hash_table_remove (priv->pending_lines, job->line);
+
+  line_data = _gtk_text_line_get_data (job->line, layout);
+  if (line_data == NULL || !line_data->valid)
+    return;
+
+  width = PIXEL_BOUND (job->extents.width) + job->margin_width;
+  height = PANGO_PIXELS (job->extents.height) + job->margin_height;
+
+  priv->measured_height_sum += height;
+  priv->n_measured_heights++;
+
+  if (width == line_data->width && height == line_data->height)
+    return;
+
+  old_height = line_data->height;
+
+  btree = _gtk_text_buffer_get_btree (layout->buffer);
+  _gtk_text_btree_resize_line (btree, job->line, layout, width, height);
+
+  update_layout_size (layout);
+  gtk_text_layout_emit_changed (layout,
+                                _gtk_text_btree_find_line_top (btree, job->line, layout),
+                                old_height, height);
+}
+
+static gboolean
+line_validator_idle (gpointer data)
+{
+  LineValidator *validator = data;
+  LineValidateJob *job;
+
+  g_atomic_int_set (&validator->idle_queued, FALSE);
+
+  while ((job = g_async_queue_try_pop (validator->results)) != NULL)
+    {
+      if (validator->layout)
+        line_validate_job_finish (validator->layout, job);
+
+      line_validate_job_free (job);
+    }
+
+  if (validator->layout)
+    {
+      GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (validator->layout);
+
+      if (priv->validation_throttled &&
+          g_hash_table_size (priv->pending_lines) < LINE_VALIDATE_MAX_PENDING / 2)
+        {
+          priv->validation_throttled = FALSE;
+          gtk_text_layout_invalidated (validator->layout);
+        }
+    }
+
+  return FALSE;
+}
+
+/* Runs in a worker thread */
+static void
+line_validate_thread (gpointer data,
+                      gpointer user_data)
+{
+  LineValidateJob *job = data;
+  LineValidator *validator;
+  PangoFontMap *font_map;
+  PangoContext *context;
+  PangoLayout *layout;
+
+  /* Once the job is queued the main thread may free it */
+  validator = line_validator_ref (job->validator);
+
+  font_map = g_private_get (&line_validate_font_map);
+  if (font_map == NULL)
+    {
+      font_map = pango_cairo_font_map_new ();
+      g_private_set (&line_validate_font_map, font_map);
+    }
+
+  context = pango_font_map_create_context (font_map);
+  pango_cairo_context_set_font_options (context, job->font_options);
+  pango_cairo_context_set_resolution (context, job->resolution);
+  pango_context_set_font_description (context, job->font_desc);
+  pango_context_set_language (context, job->language);
+  pango_context_set_base_dir (context, job->base_dir);
+
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, job->text, -1);
+  pango_layout_set_attributes (layout, job->attrs);
+  pango_layout_set_tabs (layout, job->tabs);
+  pango_layout_set_width (layout, job->width);
+  pango_layout_set_indent (layout, job->indent);
+  pango_layout_set_spacing (layout, job->spacing);
+  pango_layout_set_wrap (layout, job->wrap);
+  pango_layout_set_alignment (layout, job->alignment);
+  pango_layout_set_justify (layout, job->justify);
+  pango_layout_set_auto_dir (layout, job->auto_dir);
+
+  pango_layout_get_extents (layout, NULL, &job->extents);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+
+  g_async_queue_push (validator->results, job);
+
+  if (g_atomic_int_compare_and_exchange (&validator->idle_queued, FALSE, TRUE))
+    gdk_threads_add_idle_full (LINE_VALIDATE_PRIORITY,
+                               line_validator_idle,
+                               line_validator_ref (validator),
+                               (GDestroyNotify) line_validator_unref);
+
+  line_validator_unref (validator);
+}
+
+/* Starts measuring @line in a worker thread, giving it an estimated
+ * size for now. Returns %FALSE if the line should be measured right
+ * away instead.
+ */
+static gboolean
+gtk_text_layout_wrap_in_thread (GtkTextLayout   *layout,
+                                GtkTextLine     *line,
+                                GtkTextLineData *line_data)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display;
+  PangoContext *context;
+  LineValidateJob *job;
+
+  /* Onscreen lines are measured synchronously, and there must be
+   * some measured lines to base the estimate on. Lines that are
+   * empty or already laid out are cheap to measure.
+   */
+  if (priv->validator == NULL ||
+      !priv->in_background_validation ||
+      priv->n_measured_heights == 0 ||
+      line == priv->cursor_line ||
+      _gtk_text_line_byte_count (line) <= 1 ||
+      display_cache_lookup (layout, line) != NULL)
+    return FALSE;
+
+  if (pango_context_get_font_map (layout->ltr_context) != pango_cairo_font_map_get_default ())
+    return FALSE;
+
+  display = build_line_display (layout, line, TRUE, FALSE);
+  context = pango_layout_get_context (display->layout);
+
+  job = g_slice_new0 (LineValidateJob);
+  job->validator = line_validator_ref (priv->validator);
+  job->line = line;
+
+  job->text = g_strdup (pango_layout_get_text (display->layout));
+  job->attrs = pango_layout_get_attributes (display->layout);
+  if (job->attrs)
+    pango_attr_list_ref (job->attrs);
+  job->tabs = pango_layout_get_tabs (display->layout);
+  job->width = pango_layout_get_width (display->layout);
+  job->indent = pango_layout_get_indent (display->layout);
+  job->spacing = pango_layout_get_spacing (display->layout);
+  job->wrap = pango_layout_get_wrap (display->layout);
+  job->alignment = pango_layout_get_alignment (display->layout);
+  job->justify = pango_layout_get_justify (display->layout);
+  job->auto_dir = pango_layout_get_auto_dir (display->layout);
+
+  job->font_desc = pango_font_description_copy (pango_context_get_font_description (context));
+  job->language = pango_context_get_language (context);
+  job->base_dir = pango_context_get_base_dir (context);
+  if (pango_cairo_context_get_font_options (context))
+    job->font_options = cairo_font_options_copy (pango_cairo_context_get_font_options (context));
+  job->resolution = pango_cairo_context_get_resolution (context);
+
+  job->margin_width = display->left_margin + display->right_margin;
+  job->margin_height = display->height;
+
+  /* Drops the last reference to the attributes other than the job's */
+  line_display_free (display);
+
+  g_hash_table_insert (priv->pending_lines, line, job);
+
+  /* Keep the previous size of lines that were measured before */
+  if (line_data->height == 0)
+    line_data->height = priv->measured_height_sum / priv->n_measured_heights;
+  line_data->valid = TRUE;
+
+  if (line_validate_pool == NULL)
+    line_validate_pool = g_thread_pool_new (line_validate_thread, NULL,
+                                            CLAMP (g_get_num_processors () - 1,
+                                                   1, LINE_VALIDATE_MAX_THREADS),
+                                            FALSE, NULL);
+
+  g_thread_pool_push (line_validate_pool, job, NULL);
+
+  return TRUE;
+}
+
+/* Makes @line invalid again if it is being measured in a worker
+ * thread, so that it gets measured synchronously.
+ */
+static void
+gtk_text_layout_finish_pending_line (GtkTextLayout *layout,
+                                     GtkTextLine   *line)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineData *line_data;
+
+  if (!g_hash_table_remove (priv->pending_lines, line))
+    return;
+
+  line_data = _gtk_text_line_get_data (line, layout);
+  if (line_data)
+    _gtk_text_line_invalidate_wrap (line, line_data);
+}
+
+static void
+gtk_text_layout_stop_threaded_validation (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GHashTableIter iter;
+  gpointer key;
+
+  if (priv->validator == NULL)
+    return;
+
+  priv->validator->layout = NULL;
+  line_validator_unref (priv->validator);
+  priv->validator = NULL;
+  priv->validation_throttled = FALSE;
+
+  if (g_hash_table_size (priv->pending_lines) == 0)
+    return;
+
+  /* The lines still being measured only have an estimated size */
+  g_hash_table_iter_init (&iter, priv->pending_lines);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      GtkTextLine *line = key;
+      GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
+
+      if (line_data)
+        _gtk_text_line_invalidate_wrap (line, line_data);
+    }
+  g_hash_table_remove_all (priv->pending_lines);
+
+  gtk_text_layout_invalidated (layout);
+}
+
+/**
+ * gtk_text_layout_set_threaded_validation:
+ * @layout: a #GtkTextLayout
+ * @setting: whether to measure lines in worker threads
+ *
+ * Sets whether gtk_text_layout_validate() shapes the lines it validates
+ * in worker threads. Lines measured that way have an estimated height
+ * until the worker is done; ::changed is emitted when their real size
+ * is known. Lines validated with gtk_text_layout_validate_yrange() are
+ * always measured right away.
+ *
+ * This needs a thread-safe Pango, and is ignored with Pango versions
+ * older than 1.32.6.
+ */
+void
+gtk_text_layout_set_threaded_validation (GtkTextLayout *layout,
+                                         gboolean       setting)
+{
+  GtkTextLayoutPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  setting = setting != FALSE;
+  if (pango_version () < PANGO_VERSION_ENCODE (1, 32, 6))
+    setting = FALSE;
+
+  if (setting == (priv->validator != NULL))
+    return;
+
+  if (setting)
+    priv->validator = line_validator_new (layout);
+  else
+    gtk_text_layout_stop_threaded_validation (layout);
+}
+
 /**
  * gtk_text_layout_validate_yrange:
  * @layout: a #GtkTextLayout
@@ -1035,7 +1596,11 @@ gtk_text_layout_validate_yrange (GtkTextLayout *layout,
   seen = 0;
   while (line && seen < -y0)
     {
-      GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
+      GtkTextLineData *line_data;
+
+      gtk_text_layout_finish_pending_line (layout, line);
+
+      line_data = _gtk_text_line_get_data (line, layout);
       if (!line_data || !line_data->valid)
         {
           gint old_height, new_height;
@@ -1068,7 +1633,11 @@ gtk_text_layout_validate_yrange (GtkTextLayout *layout,
   seen = 0;
   while (line && seen < y1)
     {
-      GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
+      GtkTextLineData *line_data;
+
+      gtk_text_layout_finish_pending_line (layout, line);
+
+      line_data = _gtk_text_line_get_data (line, layout);
       if (!line_data || !line_data->valid)
         {
           gint old_height, new_height;
@@ -1127,11 +1696,16 @@ void
 gtk_text_layout_validate (GtkTextLayout *layout,
                           gint           max_pixels)
 {
+  GtkTextLayoutPrivate *priv;
   gint y, old_height, new_height;
 
   g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
 
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  priv->in_background_validation = TRUE;
+
   while (max_pixels > 0 &&
+         !priv->validation_throttled &&
          _gtk_text_btree_validate (_gtk_text_buffer_get_btree (layout->buffer),
                                    layout,  max_pixels,
                                    &y, &old_height, &new_height))
@@ -1140,7 +1714,27 @@ gtk_text_layout_validate (GtkTextLayout *layout,
 
       update_layout_size (layout);
       gtk_text_layout_emit_changed (layout, y, old_height, new_height);
+
+      if (priv->validator != NULL &&
+          g_hash_table_size (priv->pending_lines) >= LINE_VALIDATE_MAX_PENDING)
+        priv->validation_throttled = TRUE;
     }
+
+  priv->in_background_validation = FALSE;
+}
+
+/*
+ * _gtk_text_layout_validation_throttled:
+ * @layout: a #GtkTextLayout
+ *
+ * Returns whether gtk_text_layout_validate() stopped early because too
+ * many lines are waiting for worker threads. The layout emits
+ * ::invalidated once validation can continue.
+ */
+gboolean
+_gtk_text_layout_validation_throttled (GtkTextLayout *layout)
+{
+  return GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->validation_throttled;
 }
 
 static GtkTextLineData*
@@ -1149,6 +1743,7 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
                            /* may be NULL */
                            GtkTextLineData *line_data)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
 
   g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), NULL);
@@ -1160,12 +1755,18 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
       _gtk_text_line_add_data (line, line_data);
     }
 
+  if (gtk_text_layout_wrap_in_thread (layout, line, line_data))
+    return line_data;
+
   display = gtk_text_layout_get_line_display (layout, line, TRUE);
   line_data->width = display->width;
   line_data->height = display->height;
   line_data->valid = TRUE;
   gtk_text_layout_free_line_display (layout, display);
 
+  priv->measured_height_sum += line_data->height;
+  priv->n_measured_heights++;
+
   return line_data;
 }
 
@@ -2116,10 +2717,15 @@ tags_array_toggle_tag (GPtrArray  *array,
   return array;
 }
 
-GtkTextLineDisplay *
-gtk_text_layout_get_line_display (GtkTextLayout *layout,
-                                  GtkTextLine   *line,
-                                  gboolean       size_only)
+/* Lays out @line. If @shape is %FALSE, the PangoLayout of the display
+ * is set up but not shaped, the width and height of the display do not
+ * include the text yet, and the display is not cached.
+ */
+static GtkTextLineDisplay *
+build_line_display (GtkTextLayout *layout,
+                    GtkTextLine   *line,
+                    gboolean       size_only,
+                    gboolean       shape)
 {
   GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
@@ -2138,27 +2744,8 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   PangoDirection base_dir;
   GPtrArray *tags;
   gboolean initial_toggle_segments;
-  
-  g_return_val_if_fail (line != NULL, NULL);
-
-  if (layout->one_display_cache)
-    {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
-	{
-	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
-	  return layout->one_display_cache;
-	}
-      else
-        {
-          GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-          layout->one_display_cache = NULL;
-          gtk_text_layout_free_line_display (layout, tmp_display);
-        }
-    }
 
-  DV (g_print ("creating one line display cache (%s)\n", G_STRLOC));
+  DV (g_print ("creating line display (%s)\n", G_STRLOC));
 
   display = g_slice_new0 (GtkTextLineDisplay);
 
@@ -2443,29 +3030,32 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   g_slist_free (cursor_byte_offsets);
   g_slist_free (cursor_segs);
 
-  pango_layout_get_extents (display->layout, NULL, &extents);
+  if (shape)
+    {
+      pango_layout_get_extents (display->layout, NULL, &extents);
 
-  display->width = PIXEL_BOUND (extents.width) + display->left_margin + display->right_margin;
-  display->height += PANGO_PIXELS (extents.height);
+      display->width = PIXEL_BOUND (extents.width) + display->left_margin + display->right_margin;
+      display->height += PANGO_PIXELS (extents.height);
 
-  /* If we aren't wrapping, we need to do the alignment of each
-   * paragraph ourselves.
-   */
-  if (pango_layout_get_width (display->layout) < 0)
-    {
-      gint excess = display->total_width - display->width;
+      /* If we aren't wrapping, we need to do the alignment of each
+       * paragraph ourselves.
+       */
+      if (pango_layout_get_width (display->layout) < 0)
+        {
+          gint excess = display->total_width - display->width;
 
-      switch (pango_layout_get_alignment (display->layout))
-	{
-	case PANGO_ALIGN_LEFT:
-	  break;
-	case PANGO_ALIGN_CENTER:
-	  display->x_offset += excess / 2;
-	  break;
-	case PANGO_ALIGN_RIGHT:
-	  display->x_offset += excess;
-	  break;
-	}
+          switch (pango_layout_get_alignment (display->layout))
+            {
+            case PANGO_ALIGN_LEFT:
+              break;
+            case PANGO_ALIGN_CENTER:
+              display->x_offset += excess / 2;
+              break;
+            case PANGO_ALIGN_RIGHT:
+              display->x_offset += excess;
+              break;
+            }
+        }
     }
   
   /* Free this if we aren't in a loop */
@@ -2477,34 +3067,69 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   if (tags != NULL)
     g_ptr_array_free (tags, TRUE);
 
-  layout->one_display_cache = display;
+  if (shape)
+    {
+      display_cache_insert (layout, display);
 
-  if (saw_widget)
-    allocate_child_widgets (layout, display);
+      if (saw_widget)
+        allocate_child_widgets (layout, display);
+    }
   
   return display;
 }
 
-void
-gtk_text_layout_free_line_display (GtkTextLayout      *layout,
-                                   GtkTextLineDisplay *display)
+GtkTextLineDisplay *
+gtk_text_layout_get_line_display (GtkTextLayout *layout,
+                                  GtkTextLine   *line,
+                                  gboolean       size_only)
 {
-  if (display != layout->one_display_cache)
+  GtkTextLineDisplay *display;
+
+  g_return_val_if_fail (line != NULL, NULL);
+
+  display = display_cache_lookup (layout, line);
+  if (display)
     {
-      if (display->layout)
-        g_object_unref (display->layout);
+      if (size_only || !display->size_only)
+	{
+	  if (!size_only)
+            {
+              display_cache_touch (layout, display);
+              update_text_display_cursors (layout, line, display);
+            }
+	  return display;
+	}
+      else
+        display_cache_remove (layout, display);
+    }
+
+  return build_line_display (layout, line, size_only, TRUE);
+}
 
-      if (display->cursors)
-        g_array_free (display->cursors, TRUE);
+static void
+line_display_free (GtkTextLineDisplay *display)
+{
+  if (display->layout)
+    g_object_unref (display->layout);
 
-      if (display->pg_bg_color)
-        gdk_color_free (display->pg_bg_color);
+  if (display->cursors)
+    g_array_free (display->cursors, TRUE);
 
-      if (display->pg_bg_rgba)
-        gdk_rgba_free (display->pg_bg_rgba);
+  if (display->pg_bg_color)
+    gdk_color_free (display->pg_bg_color);
 
-      g_slice_free (GtkTextLineDisplay, display);
-    }
+  if (display->pg_bg_rgba)
+    gdk_rgba_free (display->pg_bg_rgba);
+
+  g_slice_free (GtkTextLineDisplay, display);
+}
+
+void
+gtk_text_layout_free_line_display (GtkTextLayout      *layout,
+                                   GtkTextLineDisplay *display)
+{
+  if (!display_is_cached (layout, display))
+    line_display_free (display);
 }
 
 /* Functions to convert iter <=> index for the line of a GtkTextLineDisplay
@@ -144,9 +144,7 @@ struct _GtkTextLayout
    * over long runs with the same style. */
   GtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
-   */
+  /* Unused; line displays are cached in the private data */
   GtkTextLineDisplay *one_display_cache;
 
   /* Whether we are allowed to wrap right now */
@@ -259,6 +257,12 @@ struct _GtkTextLineDisplay
 
 #ifdef GTK_COMPILATION
 extern G_GNUC_INTERNAL PangoAttrType gtk_text_attr_appearance_type;
+
+G_GNUC_INTERNAL
+void _gtk_text_layout_reserve_line_displays (GtkTextLayout *layout,
+                                             guint          n_lines);
+G_GNUC_INTERNAL
+gboolean _gtk_text_layout_validation_throttled (GtkTextLayout *layout);
 #endif
 
 GDK_AVAILABLE_IN_ALL
@@ -375,6 +379,9 @@ void     gtk_text_layout_validate_yrange (GtkTextLayout *layout,
 GDK_AVAILABLE_IN_ALL
 void     gtk_text_layout_validate        (GtkTextLayout *layout,
                                           gint           max_pixels);
+GDK_AVAILABLE_IN_3_10
+void     gtk_text_layout_set_threaded_validation (GtkTextLayout *layout,
+                                                  gboolean       setting);
 
 /* This function should return the passed-in line data,
  * OR remove the existing line data from the line, and
@@ -221,6 +221,8 @@ struct _GtkTextViewPrivate
 
   guint accepts_tab : 1;
 
+  guint threaded_validation : 1;
+
   guint width_changed : 1;
 
   /* debug flag - means that we've validated onscreen since the
@@ -294,7 +296,8 @@ enum
   PROP_VSCROLL_POLICY,
   PROP_INPUT_PURPOSE,
   PROP_INPUT_HINTS,
-  PROP_POPULATE_ALL
+  PROP_POPULATE_ALL,
+  PROP_THREADED_VALIDATION
 };
 
 static void gtk_text_view_finalize             (GObject          *object);
@@ -879,6 +882,26 @@ gtk_text_view_class_init (GtkTextViewClass *klass)
                                                          FALSE,
                                                          GTK_PARAM_READWRITE));
 
+  /**
+   * GtkTextView:threaded-validation:
+   *
+   * Whether the sizes of offscreen lines are computed in worker threads.
+   * See gtk_text_view_set_threaded_validation().
+   *
+   * This is always %FALSE if the Pango version in use does not support
+   * it. With a custom font map, lines are measured in the main thread
+   * even if this is %TRUE.
+   *
+   * Since: 3.10
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_THREADED_VALIDATION,
+                                   g_param_spec_boolean ("threaded-validation",
+                                                         P_("Threaded validation"),
+                                                         P_("Whether to measure offscreen lines in worker threads"),
+                                                         FALSE,
+                                                         GTK_PARAM_READWRITE));
+
 
    /* GtkScrollable interface */
    g_object_class_override_property (gobject_class, PROP_HADJUSTMENT,    "hadjustment");
@@ -3294,6 +3317,10 @@ gtk_text_view_set_property (GObject         *object,
       text_view->priv->populate_all = g_value_get_boolean (value);
       break;
 
+    case PROP_THREADED_VALIDATION:
+      gtk_text_view_set_threaded_validation (text_view, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3402,6 +3429,10 @@ gtk_text_view_get_property (GObject         *object,
       g_value_set_boolean (value, priv->populate_all);
       break;
 
+    case PROP_THREADED_VALIDATION:
+      g_value_set_boolean (value, priv->threaded_validation);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3936,7 +3967,11 @@ incremental_validate_callback (gpointer data)
 
   gtk_text_view_update_adjustments (text_view);
   
-  if (gtk_text_layout_is_valid (text_view->priv->layout))
+  /* If the layout is waiting for worker threads, it emits
+   * ::invalidated when we should continue.
+   */
+  if (gtk_text_layout_is_valid (text_view->priv->layout) ||
+      _gtk_text_layout_validation_throttled (text_view->priv->layout))
     {
       text_view->priv->incremental_validate_idle = 0;
       result = FALSE;
@@ -6478,6 +6513,73 @@ gtk_text_view_set_overwrite (GtkTextView *text_view,
     gtk_text_view_toggle_overwrite (text_view);
 }
 
+/**
+ * gtk_text_view_set_threaded_validation:
+ * @text_view: a #GtkTextView
+ * @setting: whether to measure offscreen lines in worker threads
+ *
+ * Sets whether @text_view computes the sizes of the lines that are not
+ * on screen in worker threads. This keeps the main loop responsive and
+ * gets the scrollbars close to their final size much sooner when large
+ * texts are loaded. Offscreen lines have an estimated height until
+ * their real size is known, so the scrollbars may still move a little
+ * while the workers are busy.
+ *
+ * This has no effect if the Pango version in use is older than 1.32.6,
+ * gtk_text_view_get_threaded_validation() keeps returning %FALSE then.
+ * If the text view uses a custom font map, its lines are measured in
+ * the main thread even if this is set.
+ *
+ * Since: 3.10
+ **/
+void
+gtk_text_view_set_threaded_validation (GtkTextView *text_view,
+                                       gboolean     setting)
+{
+  GtkTextViewPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_VIEW (text_view));
+
+  priv = text_view->priv;
+  setting = setting != FALSE;
+
+  /* Older versions of Pango aren't thread-safe */
+  if (pango_version () < PANGO_VERSION_ENCODE (1, 32, 6))
+    setting = FALSE;
+
+  if (priv->threaded_validation != setting)
+    {
+      priv->threaded_validation = setting;
+
+      if (priv->layout)
+        gtk_text_layout_set_threaded_validation (priv->layout, setting);
+
+      g_object_notify (G_OBJECT (text_view), "threaded-validation");
+    }
+}
+
+/**
+ * gtk_text_view_get_threaded_validation:
+ * @text_view: a #GtkTextView
+ *
+ * Returns whether the sizes of offscreen lines are computed in worker
+ * threads. This is %FALSE if the Pango version in use doesn't allow
+ * it. A text view with a custom font map measures its lines in the
+ * main thread even if this returns %TRUE.
+ * See gtk_text_view_set_threaded_validation().
+ *
+ * Return value: %TRUE if lines are measured in worker threads
+ *
+ * Since: 3.10
+ **/
+gboolean
+gtk_text_view_get_threaded_validation (GtkTextView *text_view)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_VIEW (text_view), FALSE);
+
+  return text_view->priv->threaded_validation;
+}
+
 /**
  * gtk_text_view_set_accepts_tab:
  * @text_view: A #GtkTextView
@@ -7068,6 +7170,9 @@ gtk_text_view_ensure_layout (GtkTextView *text_view)
       gtk_text_layout_set_overwrite_mode (priv->layout,
 					  priv->overwrite_mode && priv->editable);
 
+      gtk_text_layout_set_threaded_validation (priv->layout,
+                                               priv->threaded_validation);
+
       ltr_context = gtk_widget_create_pango_context (GTK_WIDGET (text_view));
       pango_context_set_base_dir (ltr_context, PANGO_DIRECTION_LTR);
       rtl_context = gtk_widget_create_pango_context (GTK_WIDGET (text_view));
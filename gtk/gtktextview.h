@@ -353,6 +353,12 @@ void             gtk_text_view_set_input_hints        (GtkTextView      *text_vi
 GDK_AVAILABLE_IN_3_6
 GtkInputHints    gtk_text_view_get_input_hints        (GtkTextView      *text_view);
 
+GDK_AVAILABLE_IN_3_10
+void             gtk_text_view_set_threaded_validation (GtkTextView     *text_view,
+                                                        gboolean         setting);
+GDK_AVAILABLE_IN_3_10
+gboolean         gtk_text_view_get_threaded_validation (GtkTextView     *text_view);
+
 
 G_END_DECLS
 
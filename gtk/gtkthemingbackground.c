@@ -42,6 +42,31 @@
  */
 #include "fallback-c89.c"
 
+/* Backgrounds of widgets with shared style values are rendered once
+   per size and reused, as long as they are at most this large */
+#define MAX_CACHED_BACKGROUND_SIZE (256 * 256)
+#define MAX_BACKGROUND_CACHE_SIZE (4 * 1024 * 1024)
+
+typedef struct _GtkBackgroundCacheEntry GtkBackgroundCacheEntry;
+
+struct _GtkBackgroundCacheEntry {
+  /* key */
+  GtkCssComputedValues *values;
+  double width;
+  double height;
+  double scale;
+  GtkJunctionSides junction;
+  cairo_surface_type_t type;
+
+  cairo_surface_t *surface;
+  gsize size;
+  GList link;
+};
+
+static GHashTable *background_cache = NULL;
+static GQueue background_cache_lru = G_QUEUE_INIT;
+static gsize background_cache_size = 0;
+
 static const GtkRoundedBox *
 gtk_theming_background_get_box (GtkThemingBackground *bg,
                                 GtkCssArea            area)
@@ -274,6 +299,176 @@ _gtk_theming_background_apply_shadow (GtkThemingBackground *bg,
                                     inset);
 }
 
+/* Paints everything inside the border box: the color, the image
+ * layers and the inset shadow */
+static void
+_gtk_theming_background_paint_contents (GtkThemingBackground *bg,
+                                        cairo_t              *cr)
+{
+  gint idx;
+  GtkCssValue *background_image;
+
+  background_image = _gtk_style_context_peek_property (bg->context, GTK_CSS_PROPERTY_BACKGROUND_IMAGE);
+
+  _gtk_theming_background_paint_color (bg, cr, background_image);
+
+  for (idx = _gtk_css_array_value_get_n_values (background_image) - 1; idx >= 0; idx--)
+    {
+      _gtk_theming_background_paint_layer (bg, idx, cr);
+    }
+
+  _gtk_theming_background_apply_shadow (bg, cr, TRUE);  /* Inset shadow */
+}
+
+static guint
+background_cache_entry_hash (gconstpointer data)
+{
+  const GtkBackgroundCacheEntry *entry = data;
+
+  return g_direct_hash (entry->values) ^
+         ((guint) entry->width << 16) ^
+         (guint) entry->height ^
+         ((guint) entry->junction << 8);
+}
+
+static gboolean
+background_cache_entry_equal (gconstpointer a,
+                              gconstpointer b)
+{
+  const GtkBackgroundCacheEntry *entry_a = a;
+  const GtkBackgroundCacheEntry *entry_b = b;
+
+  return entry_a->values == entry_b->values &&
+         entry_a->width == entry_b->width &&
+         entry_a->height == entry_b->height &&
+         entry_a->scale == entry_b->scale &&
+         entry_a->junction == entry_b->junction &&
+         entry_a->type == entry_b->type;
+}
+
+static void
+background_cache_entry_free (GtkBackgroundCacheEntry *entry)
+{
+  g_object_unref (entry->values);
+  cairo_surface_destroy (entry->surface);
+  g_slice_free (GtkBackgroundCacheEntry, entry);
+}
+
+/* We only cache when drawing to pixels at an integer offset, so
+ * the cached rendering is exactly what we would have drawn. */
+static gboolean
+gtk_theming_background_can_cache (cairo_t *cr,
+                                  double  *scale)
+{
+  cairo_surface_t *target;
+  cairo_matrix_t matrix;
+  double scale_x, scale_y;
+
+  target = cairo_get_target (cr);
+  switch ((int) cairo_surface_get_type (target))
+    {
+    case CAIRO_SURFACE_TYPE_PDF:
+    case CAIRO_SURFACE_TYPE_PS:
+    case CAIRO_SURFACE_TYPE_SVG:
+    case CAIRO_SURFACE_TYPE_RECORDING:
+    case CAIRO_SURFACE_TYPE_SCRIPT:
+      return FALSE;
+    default:
+      break;
+    }
+
+  cairo_get_matrix (cr, &matrix);
+  if (matrix.xx != 1.0 || matrix.yy != 1.0 ||
+      matrix.xy != 0.0 || matrix.yx != 0.0 ||
+      matrix.x0 != floor (matrix.x0) ||
+      matrix.y0 != floor (matrix.y0))
+    return FALSE;
+
+  scale_x = scale_y = 1.0;
+#ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
+  cairo_surface_get_device_scale (target, &scale_x, &scale_y);
+#endif
+  if (scale_x != scale_y)
+    return FALSE;
+
+  *scale = scale_x;
+  return TRUE;
+}
+
+static gboolean
+_gtk_theming_background_paint_cached (GtkThemingBackground *bg,
+                                      cairo_t              *cr)
+{
+  GtkBackgroundCacheEntry key, *entry;
+  cairo_t *cache_cr;
+
+  key.values = _gtk_style_context_peek_shared_values (bg->context);
+  if (key.values == NULL)
+    return FALSE;
+
+  if (!gtk_theming_background_can_cache (cr, &key.scale))
+    return FALSE;
+
+  key.width = bg->paint_area.width;
+  key.height = bg->paint_area.height;
+  key.junction = bg->junction;
+  key.type = cairo_surface_get_type (cairo_get_target (cr));
+
+  if (key.width <= 0 || key.height <= 0 ||
+      key.width * key.height * key.scale * key.scale > MAX_CACHED_BACKGROUND_SIZE)
+    return FALSE;
+
+  if (background_cache == NULL)
+    background_cache = g_hash_table_new (background_cache_entry_hash,
+                                         background_cache_entry_equal);
+
+  entry = g_hash_table_lookup (background_cache, &key);
+  if (entry)
+    {
+      g_queue_unlink (&background_cache_lru, &entry->link);
+    }
+  else
+    {
+      entry = g_slice_new (GtkBackgroundCacheEntry);
+      *entry = key;
+      g_object_ref (entry->values);
+      entry->link.data = entry;
+      entry->link.prev = entry->link.next = NULL;
+      /* The size is in user units, the surface inherits the device
+       * scale of the target and gets scaled accordingly */
+      entry->surface = cairo_surface_create_similar (cairo_get_target (cr),
+                                                     CAIRO_CONTENT_COLOR_ALPHA,
+                                                     ceil (key.width),
+                                                     ceil (key.height));
+      entry->size = ceil (key.width * key.scale) * ceil (key.height * key.scale) * 4;
+
+      cache_cr = cairo_create (entry->surface);
+      _gtk_theming_background_paint_contents (bg, cache_cr);
+      cairo_destroy (cache_cr);
+
+      g_hash_table_add (background_cache, entry);
+      background_cache_size += entry->size;
+    }
+
+  g_queue_push_head_link (&background_cache_lru, &entry->link);
+
+  /* Never evicts the entry we use, it's at the head */
+  while (background_cache_size > MAX_BACKGROUND_CACHE_SIZE)
+    {
+      GtkBackgroundCacheEntry *old = g_queue_pop_tail_link (&background_cache_lru)->data;
+
+      g_hash_table_remove (background_cache, old);
+      background_cache_size -= old->size;
+      background_cache_entry_free (old);
+    }
+
+  cairo_set_source_surface (cr, entry->surface, 0, 0);
+  cairo_rectangle (cr, 0, 0, key.width, key.height);
+  cairo_fill (cr);
+
+  return TRUE;
+}
+
 static void
 _gtk_theming_background_init_context (GtkThemingBackground *bg)
 {
@@ -352,24 +547,13 @@ void
 _gtk_theming_background_render (GtkThemingBackground *bg,
                                 cairo_t              *cr)
 {
-  gint idx;
-  GtkCssValue *background_image;
-
-  background_image = _gtk_style_context_peek_property (bg->context, GTK_CSS_PROPERTY_BACKGROUND_IMAGE);
-
   cairo_save (cr);
   cairo_translate (cr, bg->paint_area.x, bg->paint_area.y);
 
   _gtk_theming_background_apply_shadow (bg, cr, FALSE); /* Outset shadow */
 
-  _gtk_theming_background_paint_color (bg, cr, background_image);
-
-  for (idx = _gtk_css_array_value_get_n_values (background_image) - 1; idx >= 0; idx--)
-    {
-      _gtk_theming_background_paint_layer (bg, idx, cr);
-    }
-
-  _gtk_theming_background_apply_shadow (bg, cr, TRUE);  /* Inset shadow */
+  if (!_gtk_theming_background_paint_cached (bg, cr))
+    _gtk_theming_background_paint_contents (bg, cr);
 
   cairo_restore (cr);
 }
@@ -34,6 +34,24 @@ _gtk_tree_data_list_alloc (void)
   return list;
 }
 
+static void cell_copy_data (GtkTreeDataCell *dest,
+                            GtkTreeDataCell *src,
+                            GType            type);
+
+static inline void
+cell_free_data (GtkTreeDataCell *cell,
+                GType            type)
+{
+  if (g_type_is_a (type, G_TYPE_STRING))
+    g_free ((gchar *) cell->v_pointer);
+  else if (g_type_is_a (type, G_TYPE_OBJECT) && cell->v_pointer != NULL)
+    g_object_unref (cell->v_pointer);
+  else if (g_type_is_a (type, G_TYPE_BOXED) && cell->v_pointer != NULL)
+    g_boxed_free (type, (gpointer) cell->v_pointer);
+  else if (g_type_is_a (type, G_TYPE_VARIANT) && cell->v_pointer != NULL)
+    g_variant_unref ((gpointer) cell->v_pointer);
+}
+
 void
 _gtk_tree_data_list_free (GtkTreeDataList *list,
 			  GType           *column_headers)
@@ -46,21 +64,63 @@ _gtk_tree_data_list_free (GtkTreeDataList *list,
   while (tmp)
     {
       next = tmp->next;
-      if (g_type_is_a (column_headers [i], G_TYPE_STRING))
-	g_free ((gchar *) tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_OBJECT) && tmp->data.v_pointer != NULL)
-	g_object_unref (tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_BOXED) && tmp->data.v_pointer != NULL)
-	g_boxed_free (column_headers [i], (gpointer) tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_VARIANT) && tmp->data.v_pointer != NULL)
-	g_variant_unref ((gpointer) tmp->data.v_pointer);
-
+      cell_free_data (&tmp->data, column_headers[i]);
       g_slice_free (GtkTreeDataList, tmp);
       i++;
       tmp = next;
     }
 }
 
+/* Row allocation
+ *
+ * GtkListStore keeps a row as one block of @n_columns cells instead
+ * of a linked list of nodes, so column n of a row is simply row[n].
+ * This saves an allocation and a link pointer per cell and makes
+ * looking up a column O(1).
+ */
+GtkTreeDataCell *
+_gtk_tree_data_row_new (gint n_columns)
+{
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  return g_slice_alloc0 (sizeof (GtkTreeDataCell) * n_columns);
+}
+
+void
+_gtk_tree_data_row_free (GtkTreeDataCell *row,
+                         gint             n_columns,
+                         GType           *column_headers)
+{
+  gint i;
+
+  if (row == NULL)
+    return;
+
+  for (i = 0; i < n_columns; i++)
+    cell_free_data (&row[i], column_headers[i]);
+
+  g_slice_free1 (sizeof (GtkTreeDataCell) * n_columns, row);
+}
+
+GtkTreeDataCell *
+_gtk_tree_data_row_copy (GtkTreeDataCell *row,
+                         gint             n_columns,
+                         GType           *column_headers)
+{
+  GtkTreeDataCell *copy;
+  gint i;
+
+  if (row == NULL)
+    return NULL;
+
+  copy = _gtk_tree_data_row_new (n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    cell_copy_data (&copy[i], &row[i], column_headers[i]);
+
+  return copy;
+}
+
 gboolean
 _gtk_tree_data_list_check_type (GType type)
 {
@@ -117,67 +177,67 @@ get_fundamental_type (GType type)
   return result;
 }
 void
-_gtk_tree_data_list_node_to_value (GtkTreeDataList *list,
-				   GType            type,
-				   GValue          *value)
+_gtk_tree_data_cell_to_value (GtkTreeDataCell *cell,
+                              GType            type,
+                              GValue          *value)
 {
   g_value_init (value, type);
 
   switch (get_fundamental_type (type))
     {
     case G_TYPE_BOOLEAN:
-      g_value_set_boolean (value, (gboolean) list->data.v_int);
+      g_value_set_boolean (value, (gboolean) cell->v_int);
       break;
     case G_TYPE_CHAR:
-      g_value_set_schar (value, (gchar) list->data.v_char);
+      g_value_set_schar (value, (gchar) cell->v_char);
       break;
     case G_TYPE_UCHAR:
-      g_value_set_uchar (value, (guchar) list->data.v_uchar);
+      g_value_set_uchar (value, (guchar) cell->v_uchar);
       break;
     case G_TYPE_INT:
-      g_value_set_int (value, (gint) list->data.v_int);
+      g_value_set_int (value, (gint) cell->v_int);
       break;
     case G_TYPE_UINT:
-      g_value_set_uint (value, (guint) list->data.v_uint);
+      g_value_set_uint (value, (guint) cell->v_uint);
       break;
     case G_TYPE_LONG:
-      g_value_set_long (value, list->data.v_long);
+      g_value_set_long (value, cell->v_long);
       break;
     case G_TYPE_ULONG:
-      g_value_set_ulong (value, list->data.v_ulong);
+      g_value_set_ulong (value, cell->v_ulong);
       break;
     case G_TYPE_INT64:
-      g_value_set_int64 (value, list->data.v_int64);
+      g_value_set_int64 (value, cell->v_int64);
       break;
     case G_TYPE_UINT64:
-      g_value_set_uint64 (value, list->data.v_uint64);
+      g_value_set_uint64 (value, cell->v_uint64);
       break;
     case G_TYPE_ENUM:
-      g_value_set_enum (value, list->data.v_int);
+      g_value_set_enum (value, cell->v_int);
       break;
     case G_TYPE_FLAGS:
-      g_value_set_flags (value, list->data.v_uint);
+      g_value_set_flags (value, cell->v_uint);
       break;
     case G_TYPE_FLOAT:
-      g_value_set_float (value, (gfloat) list->data.v_float);
+      g_value_set_float (value, (gfloat) cell->v_float);
       break;
     case G_TYPE_DOUBLE:
-      g_value_set_double (value, (gdouble) list->data.v_double);
+      g_value_set_double (value, (gdouble) cell->v_double);
       break;
     case G_TYPE_STRING:
-      g_value_set_string (value, (gchar *) list->data.v_pointer);
+      g_value_set_string (value, (gchar *) cell->v_pointer);
       break;
     case G_TYPE_POINTER:
-      g_value_set_pointer (value, (gpointer) list->data.v_pointer);
+      g_value_set_pointer (value, (gpointer) cell->v_pointer);
       break;
     case G_TYPE_BOXED:
-      g_value_set_boxed (value, (gpointer) list->data.v_pointer);
+      g_value_set_boxed (value, (gpointer) cell->v_pointer);
       break;
     case G_TYPE_VARIANT:
-      g_value_set_variant (value, (gpointer) list->data.v_pointer);
+      g_value_set_variant (value, (gpointer) cell->v_pointer);
       break;
     case G_TYPE_OBJECT:
-      g_value_set_object (value, (GObject *) list->data.v_pointer);
+      g_value_set_object (value, (GObject *) cell->v_pointer);
       break;
     default:
       g_warning ("%s: Unsupported type (%s) retrieved.", G_STRLOC, g_type_name (value->g_type));
@@ -186,71 +246,79 @@ _gtk_tree_data_list_node_to_value (GtkTreeDataList *list,
 }
 
 void
-_gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
+_gtk_tree_data_list_node_to_value (GtkTreeDataList *list,
+				   GType            type,
 				   GValue          *value)
+{
+  _gtk_tree_data_cell_to_value (&list->data, type, value);
+}
+
+void
+_gtk_tree_data_cell_set_value (GtkTreeDataCell *cell,
+                               GValue          *value)
 {
   switch (get_fundamental_type (G_VALUE_TYPE (value)))
     {
     case G_TYPE_BOOLEAN:
-      list->data.v_int = g_value_get_boolean (value);
+      cell->v_int = g_value_get_boolean (value);
       break;
     case G_TYPE_CHAR:
-      list->data.v_char = g_value_get_schar (value);
+      cell->v_char = g_value_get_schar (value);
       break;
     case G_TYPE_UCHAR:
-      list->data.v_uchar = g_value_get_uchar (value);
+      cell->v_uchar = g_value_get_uchar (value);
       break;
     case G_TYPE_INT:
-      list->data.v_int = g_value_get_int (value);
+      cell->v_int = g_value_get_int (value);
       break;
     case G_TYPE_UINT:
-      list->data.v_uint = g_value_get_uint (value);
+      cell->v_uint = g_value_get_uint (value);
       break;
     case G_TYPE_LONG:
-      list->data.v_long = g_value_get_long (value);
+      cell->v_long = g_value_get_long (value);
       break;
     case G_TYPE_ULONG:
-      list->data.v_ulong = g_value_get_ulong (value);
+      cell->v_ulong = g_value_get_ulong (value);
       break;
     case G_TYPE_INT64:
-      list->data.v_int64 = g_value_get_int64 (value);
+      cell->v_int64 = g_value_get_int64 (value);
       break;
     case G_TYPE_UINT64:
-      list->data.v_uint64 = g_value_get_uint64 (value);
+      cell->v_uint64 = g_value_get_uint64 (value);
       break;
     case G_TYPE_ENUM:
-      list->data.v_int = g_value_get_enum (value);
+      cell->v_int = g_value_get_enum (value);
       break;
     case G_TYPE_FLAGS:
-      list->data.v_uint = g_value_get_flags (value);
+      cell->v_uint = g_value_get_flags (value);
       break;
     case G_TYPE_POINTER:
-      list->data.v_pointer = g_value_get_pointer (value);
+      cell->v_pointer = g_value_get_pointer (value);
       break;
     case G_TYPE_FLOAT:
-      list->data.v_float = g_value_get_float (value);
+      cell->v_float = g_value_get_float (value);
       break;
     case G_TYPE_DOUBLE:
-      list->data.v_double = g_value_get_double (value);
+      cell->v_double = g_value_get_double (value);
       break;
     case G_TYPE_STRING:
-      g_free (list->data.v_pointer);
-      list->data.v_pointer = g_value_dup_string (value);
+      g_free (cell->v_pointer);
+      cell->v_pointer = g_value_dup_string (value);
       break;
     case G_TYPE_OBJECT:
-      if (list->data.v_pointer)
-	g_object_unref (list->data.v_pointer);
-      list->data.v_pointer = g_value_dup_object (value);
+      if (cell->v_pointer)
+	g_object_unref (cell->v_pointer);
+      cell->v_pointer = g_value_dup_object (value);
       break;
     case G_TYPE_BOXED:
-      if (list->data.v_pointer)
-	g_boxed_free (G_VALUE_TYPE (value), list->data.v_pointer);
-      list->data.v_pointer = g_value_dup_boxed (value);
+      if (cell->v_pointer)
+	g_boxed_free (G_VALUE_TYPE (value), cell->v_pointer);
+      cell->v_pointer = g_value_dup_boxed (value);
       break;
     case G_TYPE_VARIANT:
-      if (list->data.v_pointer)
-	g_variant_unref (list->data.v_pointer);
-      list->data.v_pointer = g_value_dup_variant (value);
+      if (cell->v_pointer)
+	g_variant_unref (cell->v_pointer);
+      cell->v_pointer = g_value_dup_variant (value);
       break;
     default:
       g_warning ("%s: Unsupported type (%s) stored.", G_STRLOC, g_type_name (G_VALUE_TYPE (value)));
@@ -258,17 +326,18 @@ _gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
     }
 }
 
-GtkTreeDataList *
-_gtk_tree_data_list_node_copy (GtkTreeDataList *list,
-                               GType            type)
+void
+_gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
+				   GValue          *value)
 {
-  GtkTreeDataList *new_list;
-
-  g_return_val_if_fail (list != NULL, NULL);
-  
-  new_list = _gtk_tree_data_list_alloc ();
-  new_list->next = NULL;
+  _gtk_tree_data_cell_set_value (&list->data, value);
+}
 
+static void
+cell_copy_data (GtkTreeDataCell *dest,
+                GtkTreeDataCell *src,
+                GType            type)
+{
   switch (get_fundamental_type (type))
     {
     case G_TYPE_BOOLEAN:
@@ -285,33 +354,47 @@ _gtk_tree_data_list_node_copy (GtkTreeDataList *list,
     case G_TYPE_POINTER:
     case G_TYPE_FLOAT:
     case G_TYPE_DOUBLE:
-      new_list->data = list->data;
+      *dest = *src;
       break;
     case G_TYPE_STRING:
-      new_list->data.v_pointer = g_strdup (list->data.v_pointer);
+      dest->v_pointer = g_strdup (src->v_pointer);
       break;
     case G_TYPE_OBJECT:
     case G_TYPE_INTERFACE:
-      new_list->data.v_pointer = list->data.v_pointer;
-      if (new_list->data.v_pointer)
-	g_object_ref (new_list->data.v_pointer);
+      dest->v_pointer = src->v_pointer;
+      if (dest->v_pointer)
+	g_object_ref (dest->v_pointer);
       break;
     case G_TYPE_BOXED:
-      if (list->data.v_pointer)
-	new_list->data.v_pointer = g_boxed_copy (type, list->data.v_pointer);
+      if (src->v_pointer)
+	dest->v_pointer = g_boxed_copy (type, src->v_pointer);
       else
-	new_list->data.v_pointer = NULL;
+	dest->v_pointer = NULL;
       break;
     case G_TYPE_VARIANT:
-      if (list->data.v_pointer)
-	new_list->data.v_pointer = g_variant_ref (list->data.v_pointer);
+      if (src->v_pointer)
+	dest->v_pointer = g_variant_ref (src->v_pointer);
       else
-	new_list->data.v_pointer = NULL;
+	dest->v_pointer = NULL;
       break;
     default:
       g_warning ("Unsupported node type (%s) copied.", g_type_name (type));
       break;
     }
+}
+
+GtkTreeDataList *
+_gtk_tree_data_list_node_copy (GtkTreeDataList *list,
+                               GType            type)
+{
+  GtkTreeDataList *new_list;
+
+  g_return_val_if_fail (list != NULL, NULL);
+  
+  new_list = _gtk_tree_data_list_alloc ();
+  new_list->next = NULL;
+
+  cell_copy_data (&new_list->data, &list->data, type);
 
   return new_list;
 }
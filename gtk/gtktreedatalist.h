@@ -21,24 +21,28 @@
 #include <gtk/gtktreemodel.h>
 #include <gtk/gtktreesortable.h>
 
+typedef union _GtkTreeDataCell GtkTreeDataCell;
+union _GtkTreeDataCell
+{
+  gint           v_int;
+  gint8          v_char;
+  guint8         v_uchar;
+  guint          v_uint;
+  glong          v_long;
+  gulong         v_ulong;
+  gint64         v_int64;
+  guint64        v_uint64;
+  gfloat         v_float;
+  gdouble        v_double;
+  gpointer       v_pointer;
+};
+
 typedef struct _GtkTreeDataList GtkTreeDataList;
 struct _GtkTreeDataList
 {
   GtkTreeDataList *next;
 
-  union {
-    gint	   v_int;
-    gint8          v_char;
-    guint8         v_uchar;
-    guint	   v_uint;
-    glong	   v_long;
-    gulong	   v_ulong;
-    gint64	   v_int64;
-    guint64        v_uint64;
-    gfloat	   v_float;
-    gdouble        v_double;
-    gpointer	   v_pointer;
-  } data;
+  GtkTreeDataCell data;
 };
 
 typedef struct _GtkTreeDataSortHeader
@@ -62,6 +66,20 @@ void             _gtk_tree_data_list_value_to_node  (GtkTreeDataList *list,
 GtkTreeDataList *_gtk_tree_data_list_node_copy      (GtkTreeDataList *list,
                                                      GType            type);
 
+/* Rows of cells, without the list links */
+GtkTreeDataCell *_gtk_tree_data_row_new             (gint             n_columns);
+void             _gtk_tree_data_row_free            (GtkTreeDataCell *row,
+                                                     gint             n_columns,
+                                                     GType           *column_headers);
+GtkTreeDataCell *_gtk_tree_data_row_copy            (GtkTreeDataCell *row,
+                                                     gint             n_columns,
+                                                     GType           *column_headers);
+void             _gtk_tree_data_cell_to_value       (GtkTreeDataCell *cell,
+                                                     GType            type,
+                                                     GValue          *value);
+void             _gtk_tree_data_cell_set_value      (GtkTreeDataCell *cell,
+                                                     GValue          *value);
+
 /* Header code */
 gint                   _gtk_tree_data_list_compare_func (GtkTreeModel *model,
 							 GtkTreeIter  *a,
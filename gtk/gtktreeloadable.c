@@ -0,0 +1,140 @@
+/* gtktreeloadable.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+#include "gtktreeloadable.h"
+#include "gtkintl.h"
+
+
+/**
+ * SECTION:gtktreeloadable
+ * @Short_description: The interface for models which load rows on demand
+ * @Title: GtkTreeLoadable
+ * @See_also:#GtkTreeModel, #GtkTreeView
+ *
+ * #GtkTreeLoadable is an interface to be implemented by tree models whose
+ * rows are expensive to fetch, for example because they come from a
+ * database or over the network. Such a model reports the structure of
+ * the tree (the number of rows and which rows have children) right away
+ * through the #GtkTreeModel interface, but only fetches the contents of
+ * the rows when they are needed.
+ *
+ * #GtkTreeView does not ask for the values of a row for which
+ * gtk_tree_loadable_row_is_loaded() returns %FALSE. It sizes such rows
+ * like the rows it has measured so far and draws them empty. Once it
+ * has drawn unloaded rows, it calls gtk_tree_loadable_load_rows() with
+ * the range of rows it is showing, so that the model can fetch them,
+ * typically asynchronously and in pages. When the contents of a row
+ * become available, the model emits #GtkTreeModel::row-changed for it
+ * and the view measures and draws the row again.
+ */
+
+
+GType
+gtk_tree_loadable_get_type (void)
+{
+  static GType tree_loadable_type = 0;
+
+  if (! tree_loadable_type)
+    {
+      const GTypeInfo tree_loadable_info =
+      {
+        sizeof (GtkTreeLoadableIface), /* class_size */
+        NULL,           /* base_init */
+        NULL,           /* base_finalize */
+        NULL,
+        NULL,           /* class_finalize */
+        NULL,           /* class_data */
+        0,
+        0,
+        NULL
+      };
+
+      tree_loadable_type =
+        g_type_register_static (G_TYPE_INTERFACE, I_("GtkTreeLoadable"),
+                                &tree_loadable_info, 0);
+
+      g_type_interface_add_prerequisite (tree_loadable_type, GTK_TYPE_TREE_MODEL);
+    }
+
+  return tree_loadable_type;
+}
+
+/**
+ * gtk_tree_loadable_row_is_loaded:
+ * @loadable: A #GtkTreeLoadable
+ * @iter: A valid #GtkTreeIter pointing to a row in @loadable
+ *
+ * Returns whether the contents of the row pointed to by @iter are
+ * available. Views only ask for the values of loaded rows. This
+ * function is called for every row that is drawn or measured, so it
+ * should be cheap.
+ *
+ * Return value: %TRUE if the row is loaded
+ *
+ * Since: 3.10
+ **/
+gboolean
+gtk_tree_loadable_row_is_loaded (GtkTreeLoadable *loadable,
+                                 GtkTreeIter     *iter)
+{
+  GtkTreeLoadableIface *iface;
+
+  g_return_val_if_fail (GTK_IS_TREE_LOADABLE (loadable), TRUE);
+  g_return_val_if_fail (iter != NULL, TRUE);
+
+  iface = GTK_TREE_LOADABLE_GET_IFACE (loadable);
+
+  if (iface->row_is_loaded == NULL)
+    return TRUE;
+
+  return (* iface->row_is_loaded) (loadable, iter);
+}
+
+/**
+ * gtk_tree_loadable_load_rows:
+ * @loadable: A #GtkTreeLoadable
+ * @start_path: The first row to load
+ * @end_path: The last row to load
+ *
+ * Asks @loadable to load the contents of the rows from @start_path to
+ * @end_path, inclusive, in the order in which a #GtkTreeView shows
+ * them, that is, including the children of expanded rows in between.
+ *
+ * The model should start loading the rows and return; the rows do not
+ * need to be loaded by the time this function returns. When a row
+ * has been loaded, the model must emit #GtkTreeModel::row-changed for
+ * it. Rows which are already loaded or are being loaded can be ignored.
+ *
+ * Since: 3.10
+ **/
+void
+gtk_tree_loadable_load_rows (GtkTreeLoadable *loadable,
+                             GtkTreePath     *start_path,
+                             GtkTreePath     *end_path)
+{
+  GtkTreeLoadableIface *iface;
+
+  g_return_if_fail (GTK_IS_TREE_LOADABLE (loadable));
+  g_return_if_fail (start_path != NULL);
+  g_return_if_fail (end_path != NULL);
+
+  iface = GTK_TREE_LOADABLE_GET_IFACE (loadable);
+
+  if (iface->load_rows)
+    (* iface->load_rows) (loadable, start_path, end_path);
+}
@@ -0,0 +1,73 @@
+/* gtktreeloadable.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_TREE_LOADABLE_H__
+#define __GTK_TREE_LOADABLE_H__
+
+
+#if !defined (__GTK_H_INSIDE__) && !defined (GTK_COMPILATION)
+#error "Only <gtk/gtk.h> can be included directly."
+#endif
+
+#include <gtk/gtktreemodel.h>
+
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_TREE_LOADABLE            (gtk_tree_loadable_get_type ())
+#define GTK_TREE_LOADABLE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_TREE_LOADABLE, GtkTreeLoadable))
+#define GTK_IS_TREE_LOADABLE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GTK_TYPE_TREE_LOADABLE))
+#define GTK_TREE_LOADABLE_GET_IFACE(obj)  (G_TYPE_INSTANCE_GET_INTERFACE ((obj), GTK_TYPE_TREE_LOADABLE, GtkTreeLoadableIface))
+
+typedef struct _GtkTreeLoadable      GtkTreeLoadable; /* Dummy typedef */
+typedef struct _GtkTreeLoadableIface GtkTreeLoadableIface;
+
+/**
+ * GtkTreeLoadableIface:
+ * @row_is_loaded: Returns whether the contents of a row are available.
+ * @load_rows: Asks the model to load the contents of a range of rows.
+ *
+ * Since: 3.10
+ */
+struct _GtkTreeLoadableIface
+{
+  GTypeInterface g_iface;
+
+  /*< public >*/
+
+  /* virtual table */
+  gboolean (* row_is_loaded) (GtkTreeLoadable *loadable,
+                              GtkTreeIter     *iter);
+  void     (* load_rows)     (GtkTreeLoadable *loadable,
+                              GtkTreePath     *start_path,
+                              GtkTreePath     *end_path);
+};
+
+
+GDK_AVAILABLE_IN_3_10
+GType    gtk_tree_loadable_get_type      (void) G_GNUC_CONST;
+
+GDK_AVAILABLE_IN_3_10
+gboolean gtk_tree_loadable_row_is_loaded (GtkTreeLoadable *loadable,
+                                          GtkTreeIter     *iter);
+GDK_AVAILABLE_IN_3_10
+void     gtk_tree_loadable_load_rows     (GtkTreeLoadable *loadable,
+                                          GtkTreePath     *start_path,
+                                          GtkTreePath     *end_path);
+
+G_END_DECLS
+
+#endif /* __GTK_TREE_LOADABLE_H__ */
@@ -167,6 +167,16 @@
  *       contains an "offset" field which is the offset of the
  *       corresponding node in the child model.
  *
+ * Rows inserted into or deleted from the child model shift the offsets
+ * of all following nodes in the level. Instead of touching every one of
+ * them, a level records one pending shift: the offsets of all nodes from
+ * shift_siter to the end of the sequence are off by offset_shift. When
+ * the next change happens at a different place, only the nodes between
+ * the old and the new starting point are updated. Streams of changes at
+ * one place in a level, like appending to a log while trimming its head,
+ * thus no longer touch the whole level. Always read offsets with
+ * filter_elt_get_offset().
+ *
  * Throughout the code, two kinds of paths relative to the GtkTreeModelFilter
  * (those generated from the sequence positions) are used. There are paths
  * which take non-visible nodes into account (generated from the full
@@ -250,6 +260,7 @@ struct _FilterElt
   gint ref_count;
   gint ext_ref_count;
   gint zero_ref_count;
+  GSequenceIter *siter; /* iter into seq */
   GSequenceIter *visible_siter; /* iter into visible_seq */
 };
 
@@ -260,6 +271,10 @@ struct _FilterLevel
   gint ref_count;
   gint ext_ref_count;
 
+  /* pending offset shift, see above */
+  GSequenceIter *shift_siter;
+  gint offset_shift;
+
   FilterElt *parent_elt;
   FilterLevel *parent_level;
 };
@@ -292,6 +307,10 @@ struct _GtkTreeModelFilterPrivate
   guint in_row_deleted       : 1;
   guint virtual_root_deleted : 1;
 
+  /* incremental refilter */
+  guint refilter_idle;
+  GtkTreeRowReference *refilter_next;
+
   /* signal ids */
   gulong changed_id;
   gulong inserted_id;
@@ -300,6 +319,11 @@ struct _GtkTreeModelFilterPrivate
   gulong reordered_id;
 };
 
+/* How long gtk_tree_model_filter_refilter_incremental() may spend
+ * per main loop iteration, in microseconds.
+ */
+#define REFILTER_TIME_BUDGET 5000
+
 /* properties */
 enum
 {
@@ -332,6 +356,7 @@ enum
 /* general code (object/interface init, properties, etc) */
 static void         gtk_tree_model_filter_tree_model_init                 (GtkTreeModelIface       *iface);
 static void         gtk_tree_model_filter_drag_source_init                (GtkTreeDragSourceIface  *iface);
+static void         gtk_tree_model_filter_cancel_refilter                 (GtkTreeModelFilter      *filter);
 static void         gtk_tree_model_filter_finalize                        (GObject                 *object);
 static void         gtk_tree_model_filter_set_property                    (GObject                 *object,
                                                                            guint                    prop_id,
@@ -584,6 +609,8 @@ gtk_tree_model_filter_finalize (GObject *object)
 {
   GtkTreeModelFilter *filter = (GtkTreeModelFilter *) object;
 
+  gtk_tree_model_filter_cancel_refilter (filter);
+
   if (filter->priv->virtual_root && !filter->priv->virtual_root_deleted)
     {
       gtk_tree_model_filter_unref_path (filter, filter->priv->virtual_root,
@@ -669,24 +696,37 @@ filter_elt_free (gpointer elt)
   g_slice_free (FilterElt, elt);
 }
 
+static gint
+filter_elt_get_offset (FilterLevel     *level,
+                       const FilterElt *elt)
+{
+  /* Elements which are not in level->seq (yet) carry their real offset */
+  if (level->offset_shift != 0 && elt->siter &&
+      g_sequence_iter_compare (elt->siter, level->shift_siter) >= 0)
+    return elt->offset + level->offset_shift;
+
+  return elt->offset;
+}
+
 static gint
 filter_elt_cmp (gconstpointer a,
                 gconstpointer b,
                 gpointer      user_data)
 {
-  const FilterElt *elt_a = a;
-  const FilterElt *elt_b = b;
+  FilterLevel *level = user_data;
+  gint offset_a = filter_elt_get_offset (level, a);
+  gint offset_b = filter_elt_get_offset (level, b);
 
-  if (elt_a->offset > elt_b->offset)
+  if (offset_a > offset_b)
     return +1;
-  else if (elt_a->offset < elt_b->offset)
+  else if (offset_a < offset_b)
     return -1;
   else
     return 0;
 }
 
 static FilterElt *
-lookup_elt_with_offset (GSequence      *seq,
+lookup_elt_with_offset (FilterLevel    *level,
                         gint            offset,
                         GSequenceIter **ret_siter)
 {
@@ -694,7 +734,8 @@ lookup_elt_with_offset (GSequence      *seq,
   FilterElt dummy;
 
   dummy.offset = offset;
-  siter = g_sequence_lookup (seq, &dummy, filter_elt_cmp, NULL);
+  dummy.siter = NULL;
+  siter = g_sequence_lookup (level->seq, &dummy, filter_elt_cmp, level);
 
   if (ret_siter)
     *ret_siter = siter;
@@ -703,25 +744,76 @@ lookup_elt_with_offset (GSequence      *seq,
 }
 
 static void
-increase_offset_iter (gpointer data,
-                      gpointer user_data)
+shift_offset_iter (gpointer data,
+                   gpointer user_data)
 {
   FilterElt *elt = data;
-  gint offset = GPOINTER_TO_INT (user_data);
 
-  if (elt->offset >= offset)
-    elt->offset++;
+  elt->offset += GPOINTER_TO_INT (user_data);
 }
 
+/* Adds @delta to the offsets of all elements from @siter to the end of
+ * the level. Only the elements between the previous and the new start
+ * of the pending shift are touched.
+ */
 static void
-decrease_offset_iter (gpointer data,
-                      gpointer user_data)
+filter_level_shift_offsets (FilterLevel   *level,
+                            GSequenceIter *siter,
+                            gint           delta)
 {
-  FilterElt *elt = data;
-  gint offset = GPOINTER_TO_INT (user_data);
+  if (g_sequence_iter_is_end (siter))
+    return;
+
+  if (level->offset_shift != 0 && siter != level->shift_siter)
+    {
+      if (g_sequence_iter_compare (siter, level->shift_siter) > 0)
+        g_sequence_foreach_range (level->shift_siter, siter,
+                                  shift_offset_iter,
+                                  GINT_TO_POINTER (level->offset_shift));
+      else
+        g_sequence_foreach_range (siter, level->shift_siter,
+                                  shift_offset_iter,
+                                  GINT_TO_POINTER (-level->offset_shift));
+    }
+
+  level->shift_siter = siter;
+  level->offset_shift += delta;
+}
+
+/* Applies the pending shift to the elements, for code which changes
+ * or reorders the offsets of a whole level.
+ */
+static void
+filter_level_flush_offsets (FilterLevel *level)
+{
+  if (level->offset_shift != 0)
+    g_sequence_foreach_range (level->shift_siter,
+                              g_sequence_get_end_iter (level->seq),
+                              shift_offset_iter,
+                              GINT_TO_POINTER (level->offset_shift));
+
+  level->shift_siter = NULL;
+  level->offset_shift = 0;
+}
+
+/* Removes the element at @siter from the level, keeping the pending
+ * shift anchored on an element which stays in the sequence.
+ */
+static void
+filter_level_remove_siter (FilterLevel   *level,
+                           GSequenceIter *siter)
+{
+  if (level->offset_shift != 0 && siter == level->shift_siter)
+    {
+      level->shift_siter = g_sequence_iter_next (siter);
+      if (g_sequence_iter_is_end (level->shift_siter))
+        {
+          level->shift_siter = NULL;
+          level->offset_shift = 0;
+        }
+    }
 
-  if (elt->offset > offset)
-    elt->offset--;
+  g_sequence_remove (siter);
 }
 
 static void
@@ -805,6 +897,8 @@ gtk_tree_model_filter_build_level (GtkTreeModelFilter *filter,
   new_level->ext_ref_count = 0;
   new_level->parent_elt = parent_elt;
   new_level->parent_level = parent_level;
+  new_level->shift_siter = NULL;
+  new_level->offset_shift = 0;
 
   if (parent_elt)
     parent_elt->children = new_level;
@@ -846,7 +940,7 @@ gtk_tree_model_filter_build_level (GtkTreeModelFilter *filter,
           if (GTK_TREE_MODEL_FILTER_CACHE_CHILD_ITERS (filter))
             filter_elt->iter = iter;
 
-          g_sequence_append (new_level->seq, filter_elt);
+          filter_elt->siter = g_sequence_append (new_level->seq, filter_elt);
           filter_elt->visible_siter = g_sequence_append (new_level->visible_seq, filter_elt);
           empty = FALSE;
 
@@ -909,7 +1003,7 @@ gtk_tree_model_filter_build_level (GtkTreeModelFilter *filter,
       if (GTK_TREE_MODEL_FILTER_CACHE_CHILD_ITERS (filter))
         filter_elt->iter = first_node;
 
-      g_sequence_append (new_level->seq, filter_elt);
+      filter_elt->siter = g_sequence_append (new_level->seq, filter_elt);
     }
 
   /* Keep a reference on the first node of this level.  We need this
@@ -1109,6 +1203,8 @@ gtk_tree_model_filter_prune_level (GtkTreeModelFilter *filter,
     }
 
   /* Remove [begin + 1, end] */
+  filter_level_flush_offsets (level);
+
   siter = g_sequence_get_begin_iter (level->seq);
   siter = g_sequence_iter_next (siter);
 
@@ -1174,7 +1270,8 @@ gtk_tree_model_filter_elt_get_path (FilterLevel *level,
 
   while (walker)
     {
-      gtk_tree_path_prepend_index (path, walker2->offset);
+      gtk_tree_path_prepend_index (path,
+                                   filter_elt_get_offset (walker, walker2));
 
       walker2 = walker->parent_elt;
       walker = walker->parent_level;
@@ -1383,7 +1480,7 @@ gtk_tree_model_filter_check_ancestors (GtkTreeModelFilter *filter,
     {
       gboolean requested_state;
 
-      elt = lookup_elt_with_offset (level->seq,
+      elt = lookup_elt_with_offset (level,
                                     gtk_tree_path_get_indices (path)[i], NULL);
 
       requested_state = gtk_tree_model_filter_visible (filter, &c_iter);
@@ -1409,7 +1506,7 @@ gtk_tree_model_filter_check_ancestors (GtkTreeModelFilter *filter,
           /* insert_elt_in_level defaults to FALSE */
           elt->visible_siter = g_sequence_insert_sorted (level->visible_seq,
                                                          elt,
-                                                         filter_elt_cmp, NULL);
+                                                         filter_elt_cmp, level);
 
           c_path = gtk_tree_model_get_path (filter->priv->child_model,
                                             &c_iter);
@@ -1463,7 +1560,7 @@ gtk_tree_model_filter_check_ancestors (GtkTreeModelFilter *filter,
                   GtkTreePath *f_path;
 
                   elt->visible_siter = g_sequence_insert_sorted (level->visible_seq, elt,
-                                                                 filter_elt_cmp, NULL);
+                                                                 filter_elt_cmp, level);
 
                   f_iter.stamp = filter->priv->stamp;
                   f_iter.user_data = level->parent_level;
@@ -1480,7 +1577,7 @@ gtk_tree_model_filter_check_ancestors (GtkTreeModelFilter *filter,
                   GtkTreePath *c_path;
 
                   elt->visible_siter = g_sequence_insert_sorted (level->visible_seq, elt,
-                                                                 filter_elt_cmp, NULL);
+                                                                 filter_elt_cmp, level);
 
                   c_path = gtk_tree_model_get_path (filter->priv->child_model,
                                                     &c_iter);
@@ -1548,10 +1645,17 @@ gtk_tree_model_filter_insert_elt_in_level (GtkTreeModelFilter *filter,
    * not inserted in visible_seq
    */
   elt->visible_siter = NULL;
+  elt->siter = NULL;
 
-  siter = g_sequence_insert_sorted (level->seq, elt, filter_elt_cmp, NULL);
+  siter = g_sequence_insert_sorted (level->seq, elt, filter_elt_cmp, level);
   *index = g_sequence_iter_get_position (siter);
 
+  /* Store the offset relative to a pending shift covering the new node */
+  elt->siter = siter;
+  if (level->offset_shift != 0 &&
+      g_sequence_iter_compare (siter, level->shift_siter) >= 0)
+    elt->offset -= level->offset_shift;
+
   /* If the insert location is zero, we need to move our reference
    * on the old first node to the new first node.
    */
@@ -1687,8 +1791,6 @@ gtk_tree_model_filter_remove_elt_from_level (GtkTreeModelFilter *filter,
    */
   if (length > 1)
     {
-      GSequenceIter *siter;
-
       /* We emit row-deleted, and remove the node from the cache.
        * If it has any children, these will be removed here as well.
        */
@@ -1719,8 +1821,7 @@ gtk_tree_model_filter_remove_elt_from_level (GtkTreeModelFilter *filter,
                                                &iter, FALSE, TRUE);
 
       /* remove the node */
-      lookup_elt_with_offset (level->seq, elt->offset, &siter);
-      g_sequence_remove (siter);
+      filter_level_remove_siter (level, elt->siter);
 
       gtk_tree_model_filter_increment_stamp (filter);
 
@@ -1871,7 +1972,7 @@ find_elt_with_offset (GtkTreeModelFilter *filter,
       if (!level)
         return FALSE;
 
-      elt = lookup_elt_with_offset (level->seq,
+      elt = lookup_elt_with_offset (level,
                                     gtk_tree_path_get_indices (path)[i],
                                     NULL);
 
@@ -1948,7 +2049,7 @@ gtk_tree_model_filter_emit_row_inserted_for_path (GtkTreeModelFilter *filter,
     {
       elt->visible_siter = g_sequence_insert_sorted (level->visible_seq,
                                                      elt, filter_elt_cmp,
-                                                     NULL);
+                                                     level);
     }
 
   /* Check whether the node and all of its parents are visible */
@@ -2262,10 +2363,16 @@ gtk_tree_model_filter_row_inserted (GtkTreeModel *c_model,
    * it becomes visible
    */
   dummy.offset = offset;
-  siter = g_sequence_search (level->seq, &dummy, filter_elt_cmp, NULL);
-  siter = g_sequence_iter_prev (siter);
-  g_sequence_foreach_range (siter, g_sequence_get_end_iter (level->seq),
-                            increase_offset_iter, GINT_TO_POINTER (offset));
+  dummy.siter = NULL;
+  siter = g_sequence_search (level->seq, &dummy, filter_elt_cmp, level);
+  if (!g_sequence_iter_is_begin (siter))
+    {
+      GSequenceIter *prev = g_sequence_iter_prev (siter);
+
+      if (filter_elt_get_offset (level, GET_ELT (prev)) >= offset)
+        siter = prev;
+    }
+  filter_level_shift_offsets (level, siter, 1);
 
   /* only insert when visible */
   if (gtk_tree_model_filter_visible (filter, &real_c_iter))
@@ -2280,7 +2387,7 @@ gtk_tree_model_filter_row_inserted (GtkTreeModel *c_model,
       /* insert_elt_in_level defaults to FALSE */
       felt->visible_siter = g_sequence_insert_sorted (level->visible_seq,
                                                       felt,
-                                                      filter_elt_cmp, NULL);
+                                                      filter_elt_cmp, level);
       emit_row_inserted = TRUE;
     }
 
@@ -2365,7 +2472,7 @@ gtk_tree_model_filter_row_has_child_toggled (GtkTreeModel *c_model,
     {
       elt->visible_siter = g_sequence_insert_sorted (level->visible_seq,
                                                      elt, filter_elt_cmp,
-                                                     NULL);
+                                                     level);
 
       /* Only insert if the parent is visible in the target */
       if (gtk_tree_model_filter_elt_is_visible_in_target (level, elt))
@@ -2526,9 +2633,9 @@ gtk_tree_model_filter_row_deleted_invisible_node (GtkTreeModelFilter *filter,
 
   /* decrease offset of all nodes following the deleted node */
   dummy.offset = offset;
-  siter = g_sequence_search (level->seq, &dummy, filter_elt_cmp, NULL);
-  g_sequence_foreach_range (siter, g_sequence_get_end_iter (level->seq),
-                            decrease_offset_iter, GINT_TO_POINTER (offset));
+  dummy.siter = NULL;
+  siter = g_sequence_search (level->seq, &dummy, filter_elt_cmp, level);
+  filter_level_shift_offsets (level, siter, -1);
 }
 
 static void
@@ -2544,7 +2651,6 @@ gtk_tree_model_filter_row_deleted (GtkTreeModel *c_model,
   GSequenceIter *siter;
   gboolean emit_child_toggled = FALSE;
   gboolean emit_row_deleted = FALSE;
-  gint offset;
   gint orig_level_ext_ref_count;
 
   g_return_if_fail (c_path != NULL);
@@ -2580,7 +2686,6 @@ gtk_tree_model_filter_row_deleted (GtkTreeModel *c_model,
 
   level = FILTER_LEVEL (iter.user_data);
   elt = FILTER_ELT (iter.user_data2);
-  offset = elt->offset;
   orig_level_ext_ref_count = level->ext_ref_count;
 
   if (elt->visible_siter)
@@ -2631,7 +2736,7 @@ gtk_tree_model_filter_row_deleted (GtkTreeModel *c_model,
       GSequenceIter *tmp;
       gboolean is_first;
 
-      lookup_elt_with_offset (level->seq, elt->offset, &siter);
+      siter = elt->siter;
       is_first = g_sequence_get_begin_iter (level->seq) == siter;
 
       if (elt->children)
@@ -2642,9 +2747,8 @@ gtk_tree_model_filter_row_deleted (GtkTreeModel *c_model,
       if (elt->visible_siter)
         g_sequence_remove (elt->visible_siter);
       tmp = g_sequence_iter_next (siter);
-      g_sequence_remove (siter);
-      g_sequence_foreach_range (tmp, g_sequence_get_end_iter (level->seq),
-                                decrease_offset_iter, GINT_TO_POINTER (offset));
+      filter_level_remove_siter (level, siter);
+      filter_level_shift_offsets (level, tmp, -1);
 
       /* Take a reference on the new first node.  The first node previously
        * keeping this reference has been removed above.
@@ -2848,12 +2952,15 @@ gtk_tree_model_filter_rows_reordered (GtkTreeModel *c_model,
 
   old_first_siter = g_sequence_get_iter_at_pos (level->seq, 0);
 
+  /* The elements move to tmp_seq below, so make their offsets absolute */
+  filter_level_flush_offsets (level);
+
   for (i = 0; i < length; i++)
     {
       FilterElt *elt;
       GSequenceIter *siter;
 
-      elt = lookup_elt_with_offset (level->seq, new_order[i], &siter);
+      elt = lookup_elt_with_offset (level, new_order[i], &siter);
       if (elt == NULL)
         continue;
 
@@ -2871,7 +2978,7 @@ gtk_tree_model_filter_rows_reordered (GtkTreeModel *c_model,
   g_warn_if_fail (g_sequence_get_length (level->seq) == 0);
   g_sequence_free (level->seq);
   level->seq = tmp_seq;
-  g_sequence_sort (level->visible_seq, filter_elt_cmp, NULL);
+  g_sequence_sort (level->visible_seq, filter_elt_cmp, level);
 
   /* Transfer the reference from the old item at position 0 to the
    * new item at position 0, unless the old item at position 0 is also
@@ -4077,7 +4184,7 @@ gtk_real_tree_model_filter_convert_child_path_to_path (GtkTreeModelFilter *filte
           return NULL;
         }
 
-      tmp = lookup_elt_with_offset (level->seq, child_indices[i], &siter);
+      tmp = lookup_elt_with_offset (level, child_indices[i], &siter);
       if (tmp)
         {
           gtk_tree_path_append_index (retval, g_sequence_iter_get_position (siter));
@@ -4096,7 +4203,7 @@ gtk_real_tree_model_filter_convert_child_path_to_path (GtkTreeModelFilter *filte
                                                    &j);
 
           /* didn't find the child, let's try to bring it back */
-          if (!tmp || tmp->offset != child_indices[i])
+          if (!tmp || filter_elt_get_offset (level, tmp) != child_indices[i])
             {
               /* not there */
               gtk_tree_path_free (real_path);
@@ -4223,7 +4330,7 @@ gtk_tree_model_filter_convert_path_to_child_path (GtkTreeModelFilter *filter,
       if (elt->children == NULL)
         gtk_tree_model_filter_build_level (filter, level, elt, FALSE);
 
-      gtk_tree_path_append_index (retval, elt->offset);
+      gtk_tree_path_append_index (retval, filter_elt_get_offset (level, elt));
       level = elt->children;
     }
 
@@ -4269,12 +4376,164 @@ gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
 {
   g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
 
+  /* we're going to look at every row anyway */
+  gtk_tree_model_filter_cancel_refilter (filter);
+
   /* S L O W */
   gtk_tree_model_foreach (filter->priv->child_model,
                           gtk_tree_model_filter_refilter_helper,
                           filter);
 }
 
+static void
+gtk_tree_model_filter_cancel_refilter (GtkTreeModelFilter *filter)
+{
+  if (filter->priv->refilter_idle != 0)
+    {
+      g_source_remove (filter->priv->refilter_idle);
+      filter->priv->refilter_idle = 0;
+    }
+
+  if (filter->priv->refilter_next)
+    {
+      gtk_tree_row_reference_free (filter->priv->refilter_next);
+      filter->priv->refilter_next = NULL;
+    }
+}
+
+/* Moves @iter and @path to the next row of the child model in depth
+ * first order, not leaving the part of it below the virtual root.
+ */
+static gboolean
+gtk_tree_model_filter_refilter_next_row (GtkTreeModelFilter *filter,
+                                         GtkTreeIter        *iter,
+                                         GtkTreePath        *path)
+{
+  GtkTreeModel *c_model = filter->priv->child_model;
+  GtkTreeIter tmp;
+  gint root_depth;
+
+  if (gtk_tree_model_iter_children (c_model, &tmp, iter))
+    {
+      *iter = tmp;
+      gtk_tree_path_down (path);
+      return TRUE;
+    }
+
+  if (filter->priv->virtual_root)
+    root_depth = gtk_tree_path_get_depth (filter->priv->virtual_root);
+  else
+    root_depth = 0;
+
+  while (TRUE)
+    {
+      tmp = *iter;
+      if (gtk_tree_model_iter_next (c_model, &tmp))
+        {
+          *iter = tmp;
+          gtk_tree_path_next (path);
+          return TRUE;
+        }
+
+      if (gtk_tree_path_get_depth (path) <= root_depth + 1 ||
+          !gtk_tree_model_iter_parent (c_model, &tmp, iter))
+        return FALSE;
+
+      *iter = tmp;
+      gtk_tree_path_up (path);
+    }
+}
+
+static gboolean
+gtk_tree_model_filter_refilter_idle (gpointer data)
+{
+  GtkTreeModelFilter *filter = GTK_TREE_MODEL_FILTER (data);
+  GtkTreeModel *c_model = filter->priv->child_model;
+  GtkTreePath *path = NULL;
+  GtkTreeIter iter;
+  gint64 end_time;
+
+  end_time = g_get_monotonic_time () + REFILTER_TIME_BUDGET;
+
+  if (filter->priv->refilter_next)
+    {
+      path = gtk_tree_row_reference_get_path (filter->priv->refilter_next);
+      gtk_tree_row_reference_free (filter->priv->refilter_next);
+      filter->priv->refilter_next = NULL;
+    }
+
+  /* Either we are just starting, or the row we were going to continue
+   * with was deleted in the meantime and we don't know where we were.
+   * (Re)start at the top.
+   */
+  if (path == NULL)
+    {
+      if (filter->priv->virtual_root)
+        {
+          path = gtk_tree_path_copy (filter->priv->virtual_root);
+          gtk_tree_path_down (path);
+        }
+      else
+        path = gtk_tree_path_new_first ();
+    }
+
+  if (!gtk_tree_model_get_iter (c_model, &iter, path))
+    goto finished;
+
+  do
+    {
+      gtk_tree_model_filter_row_changed (c_model, path, &iter, filter);
+
+      if (!gtk_tree_model_filter_refilter_next_row (filter, &iter, path))
+        goto finished;
+    }
+  while (g_get_monotonic_time () < end_time);
+
+  filter->priv->refilter_next = gtk_tree_row_reference_new (c_model, path);
+  gtk_tree_path_free (path);
+
+  return G_SOURCE_CONTINUE;
+
+finished:
+  gtk_tree_path_free (path);
+  filter->priv->refilter_idle = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * gtk_tree_model_filter_refilter_incremental:
+ * @filter: A #GtkTreeModelFilter.
+ *
+ * Like gtk_tree_model_filter_refilter(), but instead of re-evaluating
+ * every row before returning, the rows are re-evaluated in small chunks
+ * from an idle handler, so the main loop keeps running while a large
+ * model is being refiltered. Rows are inserted into and removed from
+ * the filter model as their visibility is re-evaluated.
+ *
+ * Calling this function again while a previous incremental refilter is
+ * still in progress restarts it from the first row, e.g. when the
+ * filter criteria change with every keystroke. Calling
+ * gtk_tree_model_filter_refilter() cancels it.
+ *
+ * Since: 3.10
+ */
+void
+gtk_tree_model_filter_refilter_incremental (GtkTreeModelFilter *filter)
+{
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+
+  gtk_tree_model_filter_cancel_refilter (filter);
+
+  if (filter->priv->child_model == NULL)
+    return;
+
+  filter->priv->refilter_idle =
+    gdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                               gtk_tree_model_filter_refilter_idle,
+                               filter, NULL);
+}
+
 /**
  * gtk_tree_model_filter_clear_cache:
  * @filter: A #GtkTreeModelFilter.
@@ -220,6 +220,7 @@
 typedef struct _SortElt SortElt;
 typedef struct _SortLevel SortLevel;
 typedef struct _SortData SortData;
+typedef union _SortKey SortKey;
 
 struct _SortElt
 {
@@ -238,6 +239,7 @@ struct _SortLevel
   gint       ref_count;
   SortElt   *parent_elt;
   SortLevel *parent_level;
+  GList     *cache_link; /* link in unref_levels while ref_count == 0 */
 };
 
 struct _SortData
@@ -249,6 +251,18 @@ struct _SortData
   GtkTreePath *parent_path;
   gint parent_path_depth;
   gint *parent_path_indices;
+
+  /* precomputed keys, indexed by SortElt::old_index */
+  SortKey *keys;
+  GType key_type;
+};
+
+union _SortKey
+{
+  gint64   v_int64;
+  guint64  v_uint64;
+  gdouble  v_double;
+  gchar   *v_string;
 };
 
 /* Properties */
@@ -267,6 +281,13 @@ struct _GtkTreeModelSortPrivate
   GtkTreeModel *child_model;
   gint zero_ref_count;
 
+  /* level cache accounting */
+  GQueue unref_levels;
+  guint n_cached_levels;
+  guint n_cached_elts;
+  gsize cache_limit;
+  guint trim_cache_idle;
+
   /* sort information */
   GList *sort_list;
   gint sort_column_id;
@@ -306,6 +327,12 @@ struct _GtkTreeModelSortPrivate
 
 #define NO_SORT_FUNC ((GtkTreeIterCompareFunc) 0x1)
 
+/* A SortElt also costs one node in its level's GSequence, which is
+ * about four pointers and a counter.
+ */
+#define SORT_ELT_CACHE_SIZE (sizeof (SortElt) + 4 * sizeof (gpointer) + sizeof (gint))
+#define SORT_LEVEL_CACHE_SIZE (sizeof (SortLevel) + sizeof (GList))
+
 #define VALID_ITER(iter, tree_model_sort) ((iter) != NULL && (iter)->user_data != NULL && (iter)->user_data2 != NULL && (tree_model_sort)->priv->stamp == (iter)->stamp)
 
 /* general (object/interface init, etc) */
@@ -442,6 +469,8 @@ static gint         gtk_tree_model_sort_compare_func        (gconstpointer     a
 static gint         gtk_tree_model_sort_offset_compare_func (gconstpointer     a,
                                                              gconstpointer     b,
                                                              gpointer          user_data);
+static void         gtk_tree_model_sort_trim_cache          (GtkTreeModelSort *tree_model_sort);
+static void         gtk_tree_model_sort_queue_trim_cache    (GtkTreeModelSort *tree_model_sort);
 static void         gtk_tree_model_sort_clear_cache_helper  (GtkTreeModelSort *tree_model_sort,
                                                              SortLevel        *level);
 
@@ -467,6 +496,10 @@ gtk_tree_model_sort_init (GtkTreeModelSort *tree_model_sort)
   priv->zero_ref_count = 0;
   priv->root = NULL;
   priv->sort_list = NULL;
+  g_queue_init (&priv->unref_levels);
+  priv->n_cached_levels = 0;
+  priv->n_cached_elts = 0;
+  priv->cache_limit = 0;
 }
 
 static void
@@ -560,6 +593,12 @@ gtk_tree_model_sort_finalize (GObject *object)
 
   gtk_tree_model_sort_set_model (tree_model_sort, NULL);
 
+  if (priv->trim_cache_idle)
+    {
+      g_source_remove (priv->trim_cache_idle);
+      priv->trim_cache_idle = 0;
+    }
+
   if (priv->root)
     gtk_tree_model_sort_free_level (tree_model_sort, priv->root, TRUE);
 
@@ -662,6 +701,8 @@ fill_sort_data (SortData         *data,
   GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
 
   data->tree_model_sort = tree_model_sort;
+  data->keys = NULL;
+  data->key_type = G_TYPE_INVALID;
 
   if (priv->sort_column_id != GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
     {
@@ -705,6 +746,156 @@ free_sort_data (SortData *data)
   gtk_tree_path_free (data->parent_path);
 }
 
+/* Maps a column type onto the SortKey member which can represent it
+ * without changing the outcome of _gtk_tree_data_list_compare_func(),
+ * or G_TYPE_INVALID if the column cannot be keyed.
+ */
+static GType
+get_sort_key_type (GType type)
+{
+  switch (G_TYPE_FUNDAMENTAL (type))
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+    case G_TYPE_ENUM:
+      return G_TYPE_INT64;
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_ULONG:
+    case G_TYPE_UINT64:
+    case G_TYPE_FLAGS:
+      return G_TYPE_UINT64;
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      return G_TYPE_DOUBLE;
+    case G_TYPE_STRING:
+      return G_TYPE_STRING;
+    default:
+      return G_TYPE_INVALID;
+    }
+}
+
+/* When a level is sorted on a plain column with the default compare
+ * function, every comparison fetches and converts two GValues (and
+ * collates two strings) from the child model. Fetching each row's value
+ * once up front and comparing precomputed keys gives the same order at
+ * a fraction of the cost. Returns FALSE when the sort function is
+ * custom or the column type cannot be keyed.
+ */
+static gboolean
+fill_sort_keys (SortData  *data,
+                SortLevel *level)
+{
+  GtkTreeModelSortPrivate *priv = data->tree_model_sort->priv;
+  GSequenceIter *siter, *end_siter;
+  GType type;
+  gint column;
+
+  if (data->sort_func != _gtk_tree_data_list_compare_func)
+    return FALSE;
+
+  column = GPOINTER_TO_INT (data->sort_data);
+  type = gtk_tree_model_get_column_type (priv->child_model, column);
+  data->key_type = get_sort_key_type (type);
+  if (data->key_type == G_TYPE_INVALID)
+    return FALSE;
+
+  data->keys = g_new (SortKey, g_sequence_get_length (level->seq));
+
+  end_siter = g_sequence_get_end_iter (level->seq);
+  for (siter = g_sequence_get_begin_iter (level->seq);
+       siter != end_siter;
+       siter = g_sequence_iter_next (siter))
+    {
+      SortElt *elt = g_sequence_get (siter);
+      SortKey *key = &data->keys[elt->old_index];
+      GValue value = G_VALUE_INIT;
+      GtkTreeIter iter;
+      const gchar *str;
+
+      if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (data->tree_model_sort))
+        iter = elt->iter;
+      else
+        {
+          data->parent_path_indices [data->parent_path_depth-1] = elt->offset;
+          gtk_tree_model_get_iter (priv->child_model, &iter, data->parent_path);
+        }
+
+      gtk_tree_model_get_value (priv->child_model, &iter, column, &value);
+
+      switch (G_TYPE_FUNDAMENTAL (type))
+        {
+        case G_TYPE_BOOLEAN:
+          key->v_int64 = g_value_get_boolean (&value);
+          break;
+        case G_TYPE_CHAR:
+          key->v_int64 = g_value_get_schar (&value);
+          break;
+        case G_TYPE_INT:
+          key->v_int64 = g_value_get_int (&value);
+          break;
+        case G_TYPE_LONG:
+          key->v_int64 = g_value_get_long (&value);
+          break;
+        case G_TYPE_INT64:
+          key->v_int64 = g_value_get_int64 (&value);
+          break;
+        case G_TYPE_ENUM:
+          key->v_int64 = g_value_get_enum (&value);
+          break;
+        case G_TYPE_UCHAR:
+          key->v_uint64 = g_value_get_uchar (&value);
+          break;
+        case G_TYPE_UINT:
+          key->v_uint64 = g_value_get_uint (&value);
+          break;
+        case G_TYPE_ULONG:
+          key->v_uint64 = g_value_get_ulong (&value);
+          break;
+        case G_TYPE_UINT64:
+          key->v_uint64 = g_value_get_uint64 (&value);
+          break;
+        case G_TYPE_FLAGS:
+          key->v_uint64 = g_value_get_flags (&value);
+          break;
+        case G_TYPE_FLOAT:
+          key->v_double = g_value_get_float (&value);
+          break;
+        case G_TYPE_DOUBLE:
+          key->v_double = g_value_get_double (&value);
+          break;
+        case G_TYPE_STRING:
+          /* strcmp() on collation keys matches g_utf8_collate() */
+          str = g_value_get_string (&value);
+          key->v_string = g_utf8_collate_key (str ? str : "", -1);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+
+      g_value_unset (&value);
+    }
+
+  return TRUE;
+}
+
+static void
+free_sort_keys (SortData *data,
+                gint      n_keys)
+{
+  gint i;
+
+  if (data->key_type == G_TYPE_STRING)
+    for (i = 0; i < n_keys; i++)
+      g_free (data->keys[i].v_string);
+
+  g_free (data->keys);
+  data->keys = NULL;
+}
+
 static SortElt *
 lookup_elt_with_offset (GtkTreeModelSort *tree_model_sort,
                         SortLevel        *level,
@@ -1076,6 +1267,7 @@ gtk_tree_model_sort_row_deleted (GtkTreeModel *s_model,
 
   g_sequence_remove (elt->siter);
   elt = NULL;
+  tree_model_sort->priv->n_cached_elts--;
 
   /* The sequence is not ordered on offset, so we traverse the entire
    * sequence.
@@ -1589,6 +1781,12 @@ gtk_tree_model_sort_ref_node (GtkTreeModel *tree_model,
       SortLevel *parent_level = level->parent_level;
       SortElt *parent_elt = level->parent_elt;
 
+      if (level->cache_link)
+        {
+          g_queue_delete_link (&priv->unref_levels, level->cache_link);
+          level->cache_link = NULL;
+        }
+
       /* We were at zero -- time to decrement the zero_ref_count val */
       while (parent_level)
         {
@@ -1647,7 +1845,14 @@ gtk_tree_model_sort_real_unref_node (GtkTreeModel *tree_model,
 	}
 
       if (priv->root != level)
-	priv->zero_ref_count++;
+	{
+	  priv->zero_ref_count++;
+
+	  g_queue_push_head (&priv->unref_levels, level);
+	  level->cache_link = priv->unref_levels.head;
+
+	  gtk_tree_model_sort_queue_trim_cache (tree_model_sort);
+	}
     }
 }
 
@@ -1895,6 +2100,61 @@ gtk_tree_model_sort_offset_compare_func (gconstpointer a,
   return retval;
 }
 
+static gint
+gtk_tree_model_sort_key_compare_func (gconstpointer a,
+                                      gconstpointer b,
+                                      gpointer      user_data)
+{
+  SortData *data = (SortData *)user_data;
+  const SortKey *ka = &data->keys[((const SortElt *)a)->old_index];
+  const SortKey *kb = &data->keys[((const SortElt *)b)->old_index];
+  gint retval;
+
+  switch (data->key_type)
+    {
+    case G_TYPE_INT64:
+      if (ka->v_int64 < kb->v_int64)
+        retval = -1;
+      else if (ka->v_int64 == kb->v_int64)
+        retval = 0;
+      else
+        retval = 1;
+      break;
+    case G_TYPE_UINT64:
+      if (ka->v_uint64 < kb->v_uint64)
+        retval = -1;
+      else if (ka->v_uint64 == kb->v_uint64)
+        retval = 0;
+      else
+        retval = 1;
+      break;
+    case G_TYPE_DOUBLE:
+      if (ka->v_double < kb->v_double)
+        retval = -1;
+      else if (ka->v_double == kb->v_double)
+        retval = 0;
+      else
+        retval = 1;
+      break;
+    case G_TYPE_STRING:
+      retval = strcmp (ka->v_string, kb->v_string);
+      break;
+    default:
+      g_assert_not_reached ();
+      retval = 0;
+    }
+
+  if (data->tree_model_sort->priv->order == GTK_SORT_DESCENDING)
+    {
+      if (retval > 0)
+	retval = -1;
+      else if (retval < 0)
+	retval = 1;
+    }
+
+  return retval;
+}
+
 static void
 gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 				SortLevel        *level,
@@ -1943,6 +2203,12 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
   if (data.sort_func == NO_SORT_FUNC)
     g_sequence_sort (level->seq, gtk_tree_model_sort_offset_compare_func,
                      &data);
+  else if (fill_sort_keys (&data, level))
+    {
+      g_sequence_sort (level->seq, gtk_tree_model_sort_key_compare_func,
+                       &data);
+      free_sort_keys (&data, i);
+    }
   else
     g_sequence_sort (level->seq, gtk_tree_model_sort_compare_func, &data);
 
@@ -2058,6 +2324,7 @@ gtk_tree_model_sort_insert_value (GtkTreeModelSort *tree_model_sort,
   gint offset;
 
   elt = sort_elt_new ();
+  priv->n_cached_elts++;
 
   offset = gtk_tree_path_get_indices (s_path)[gtk_tree_path_get_depth (s_path) - 1];
 
@@ -2515,6 +2782,8 @@ gtk_tree_model_sort_build_level (GtkTreeModelSort *tree_model_sort,
   new_level->ref_count = 0;
   new_level->parent_level = parent_level;
   new_level->parent_elt = parent_elt;
+  new_level->cache_link = NULL;
+  priv->n_cached_levels++;
 
   if (parent_elt)
     parent_elt->children = new_level;
@@ -2531,7 +2800,14 @@ gtk_tree_model_sort_build_level (GtkTreeModelSort *tree_model_sort,
     }
 
   if (new_level != priv->root)
-    priv->zero_ref_count++;
+    {
+      priv->zero_ref_count++;
+
+      g_queue_push_head (&priv->unref_levels, new_level);
+      new_level->cache_link = priv->unref_levels.head;
+
+      gtk_tree_model_sort_queue_trim_cache (tree_model_sort);
+    }
 
   for (i = 0; i < length; i++)
     {
@@ -2578,6 +2854,7 @@ gtk_tree_model_sort_build_level (GtkTreeModelSort *tree_model_sort,
 	}
 
       sort_elt->siter = g_sequence_append (new_level->seq, sort_elt);
+      priv->n_cached_elts++;
     }
 
   /* sort level */
@@ -2625,6 +2902,15 @@ gtk_tree_model_sort_free_level (GtkTreeModelSort *tree_model_sort,
 	priv->zero_ref_count--;
     }
 
+  if (sort_level->cache_link)
+    {
+      g_queue_delete_link (&priv->unref_levels, sort_level->cache_link);
+      sort_level->cache_link = NULL;
+    }
+
+  priv->n_cached_levels--;
+  priv->n_cached_elts -= g_sequence_get_length (sort_level->seq);
+
   if (sort_level->parent_elt)
     {
       if (unref)
@@ -2742,6 +3028,140 @@ gtk_tree_model_sort_clear_cache (GtkTreeModelSort *tree_model_sort)
     gtk_tree_model_sort_clear_cache_helper (tree_model_sort, (SortLevel *)tree_model_sort->priv->root);
 }
 
+/* Frees unreferenced levels until the cache fits within its limit,
+ * or nothing more can be freed.
+ */
+static void
+gtk_tree_model_sort_trim_cache (GtkTreeModelSort *tree_model_sort)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+
+  /* Unreferenced levels never have child levels, since building a
+   * child level references its parent node. Freeing the least recently
+   * released level may release its parent level in turn, which then
+   * becomes a candidate itself.
+   */
+  while (!g_queue_is_empty (&priv->unref_levels) &&
+         gtk_tree_model_sort_get_cache_size (tree_model_sort) > priv->cache_limit)
+    {
+      SortLevel *level = g_queue_peek_tail (&priv->unref_levels);
+
+      g_assert (level->ref_count == 0);
+
+      gtk_tree_model_sort_free_level (tree_model_sort, level, TRUE);
+    }
+}
+
+static gboolean
+gtk_tree_model_sort_trim_cache_idle (gpointer data)
+{
+  GtkTreeModelSort *tree_model_sort = data;
+
+  tree_model_sort->priv->trim_cache_idle = 0;
+  gtk_tree_model_sort_trim_cache (tree_model_sort);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Levels are never freed right away when they become unreferenced or
+ * the cache grows: that may happen while reading the model, or in
+ * the middle of handling a change, and callers may still hold iters
+ * into the unreferenced levels. Trim once control is back in the main
+ * loop instead.
+ */
+static void
+gtk_tree_model_sort_queue_trim_cache (GtkTreeModelSort *tree_model_sort)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+
+  if (priv->cache_limit == 0 || priv->trim_cache_idle != 0)
+    return;
+
+  priv->trim_cache_idle =
+    gdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                               gtk_tree_model_sort_trim_cache_idle,
+                               tree_model_sort, NULL);
+}
+
+/**
+ * gtk_tree_model_sort_set_cache_limit:
+ * @tree_model_sort: A #GtkTreeModelSort
+ * @limit: the maximum size of the cache in bytes, or 0 for no limit
+ *
+ * Sets an upper bound for the memory @tree_model_sort uses to cache
+ * levels of the child model. Levels are built on demand as they are
+ * visited; once the cache grows beyond @limit, levels that have no
+ * referenced nodes are freed, starting with the level which has been
+ * unreferenced the longest. Levels containing referenced nodes are never
+ * freed, so the cache may still exceed @limit.
+ *
+ * Levels are freed right away by this function, and otherwise only
+ * from an idle handler, never while the model is being read or
+ * changed. As with gtk_tree_model_sort_clear_cache(), iters pointing
+ * into a freed level become invalid, so users which keep unreferenced
+ * iters around across main loop iterations should reference the nodes
+ * with gtk_tree_model_ref_node().
+ *
+ * The default is 0, which keeps unreferenced levels around until the
+ * model changes or gtk_tree_model_sort_clear_cache() is called.
+ *
+ * Since: 3.10
+ **/
+void
+gtk_tree_model_sort_set_cache_limit (GtkTreeModelSort *tree_model_sort,
+                                     gsize             limit)
+{
+  g_return_if_fail (GTK_IS_TREE_MODEL_SORT (tree_model_sort));
+
+  tree_model_sort->priv->cache_limit = limit;
+
+  if (limit > 0)
+    gtk_tree_model_sort_trim_cache (tree_model_sort);
+}
+
+/**
+ * gtk_tree_model_sort_get_cache_limit:
+ * @tree_model_sort: A #GtkTreeModelSort
+ *
+ * Returns the limit set with gtk_tree_model_sort_set_cache_limit().
+ *
+ * Returns: the cache limit in bytes, or 0 if the cache is unbounded
+ *
+ * Since: 3.10
+ **/
+gsize
+gtk_tree_model_sort_get_cache_limit (GtkTreeModelSort *tree_model_sort)
+{
+  g_return_val_if_fail (GTK_IS_TREE_MODEL_SORT (tree_model_sort), 0);
+
+  return tree_model_sort->priv->cache_limit;
+}
+
+/**
+ * gtk_tree_model_sort_get_cache_size:
+ * @tree_model_sort: A #GtkTreeModelSort
+ *
+ * Returns an estimate of the memory currently used by the levels
+ * @tree_model_sort has cached, including levels which are
+ * referenced.
+ *
+ * Returns: the approximate size of the cache in bytes
+ *
+ * Since: 3.10
+ **/
+gsize
+gtk_tree_model_sort_get_cache_size (GtkTreeModelSort *tree_model_sort)
+{
+  GtkTreeModelSortPrivate *priv;
+
+  g_return_val_if_fail (GTK_IS_TREE_MODEL_SORT (tree_model_sort), 0);
+
+  priv = tree_model_sort->priv;
+
+  return priv->n_cached_levels * SORT_LEVEL_CACHE_SIZE +
+         priv->n_cached_elts * SORT_ELT_CACHE_SIZE;
+}
+
 static gboolean
 gtk_tree_model_sort_iter_is_valid_helper (GtkTreeIter *iter,
 					  SortLevel   *level)
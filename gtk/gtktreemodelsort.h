@@ -87,6 +87,13 @@ void          gtk_tree_model_sort_clear_cache                (GtkTreeModelSort *
 GDK_AVAILABLE_IN_ALL
 gboolean      gtk_tree_model_sort_iter_is_valid              (GtkTreeModelSort *tree_model_sort,
                                                               GtkTreeIter      *iter);
+GDK_AVAILABLE_IN_3_10
+void          gtk_tree_model_sort_set_cache_limit            (GtkTreeModelSort *tree_model_sort,
+                                                              gsize             limit);
+GDK_AVAILABLE_IN_3_10
+gsize         gtk_tree_model_sort_get_cache_limit            (GtkTreeModelSort *tree_model_sort);
+GDK_AVAILABLE_IN_3_10
+gsize         gtk_tree_model_sort_get_cache_size             (GtkTreeModelSort *tree_model_sort);
 
 
 G_END_DECLS
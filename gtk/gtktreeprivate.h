@@ -25,6 +25,7 @@ G_BEGIN_DECLS
 #include <gtk/gtktreeview.h>
 #include <gtk/gtktreeselection.h>
 #include <gtk/gtkrbtree.h>
+#include <gtk/gtkcellrenderertext.h>
 
 #define TREE_VIEW_DRAG_WIDTH 6
 
@@ -146,6 +147,13 @@ gint              _gtk_tree_view_column_get_requested_width   (GtkTreeViewColumn
 gint              _gtk_tree_view_column_get_drag_x            (GtkTreeViewColumn  *column);
 GtkCellAreaContext *_gtk_tree_view_column_get_context         (GtkTreeViewColumn  *column);
 void              _gtk_tree_view_reset_header_styles       (GtkTreeView        *tree_view);
+GtkCellRenderer  *_gtk_tree_view_column_get_text_cell      (GtkTreeViewColumn  *column,
+                                                            gint               *model_column);
+void              _gtk_tree_view_column_push_cell_width    (GtkTreeViewColumn  *column,
+                                                            gint                minimum_width,
+                                                            gint                natural_width);
+
+const PangoFontDescription *_gtk_cell_renderer_text_get_plain_font (GtkCellRendererText *celltext);
 
 
 G_END_DECLS
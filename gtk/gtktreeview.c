@@ -26,6 +26,8 @@
 #include "gtkadjustment.h"
 #include "gtkrbtree.h"
 #include "gtktreednd.h"
+#include "gtktreeloadable.h"
+#include "gtkliststore.h"
 #include "gtktreeprivate.h"
 #include "gtkcellrenderer.h"
 #include "gtkmarshalers.h"
@@ -157,6 +159,8 @@ enum
   RUBBER_BAND_ACTIVE = 2
 };
 
+typedef struct _RowValidator RowValidator;
+
 typedef enum {
   CLEAR_AND_SELECT = (1 << 0),
   CLAMP_NODE       = (1 << 1),
@@ -239,6 +243,7 @@ typedef enum {
 
 #define GTK_TREE_VIEW_PRIORITY_VALIDATE (GDK_PRIORITY_REDRAW + 5)
 #define GTK_TREE_VIEW_PRIORITY_SCROLL_SYNC (GTK_TREE_VIEW_PRIORITY_VALIDATE + 2)
+#define GTK_TREE_VIEW_PRIORITY_LOAD_ROWS (GTK_TREE_VIEW_PRIORITY_SCROLL_SYNC + 1)
 #define GTK_TREE_VIEW_TIME_MS_PER_IDLE 30
 #define SCROLL_EDGE_SIZE 15
 #define GTK_TREE_VIEW_SEARCH_DIALOG_TIMEOUT 5000
@@ -316,6 +321,19 @@ struct _GtkTreeViewPrivate
   guint presize_handler_tick_cb;
   guint validate_rows_timer;
   guint scroll_sync_timer;
+  guint load_rows_timer;
+
+  /* Rows measured in worker threads, see
+   * gtk_tree_view_set_threaded_validation()
+   */
+  RowValidator *row_validator;
+  guint validate_generation;
+
+  /* Last row inserted at the top level during a GtkListStore
+   * bulk update, see gtk_tree_view_begin_bulk_update()
+   */
+  GtkRBNode *bulk_last_node;
+  gint bulk_last_index;
 
   /* Indentation and expander layout */
   GtkTreeViewColumn *expander_column;
@@ -420,6 +438,13 @@ struct _GtkTreeViewPrivate
   /* fixed height */
   gint fixed_height;
 
+  /* Sum and number of the row heights measured so far. Rows that have
+   * not been validated yet are given the mean as an estimated height,
+   * so the scrollbar is roughly right long before all rows are measured.
+   */
+  guint64 measured_height_sum;
+  guint   n_measured_heights;
+
   /* Scroll-to functionality when unrealized */
   GtkTreeRowReference *scroll_to_path;
   GtkTreeViewColumn *scroll_to_column;
@@ -506,6 +531,10 @@ struct _GtkTreeViewPrivate
 
   /* GtkTreeView flags */
   guint is_list : 1;
+  guint is_loadable : 1;
+  guint in_bulk_update : 1;
+  guint bulk_presize_pending : 1;
+  guint bulk_resize_pending : 1;
   guint show_expanders : 1;
   guint in_column_resize : 1;
   guint arrow_prelit : 1;
@@ -561,7 +590,8 @@ enum {
   PROP_ENABLE_GRID_LINES,
   PROP_ENABLE_TREE_LINES,
   PROP_TOOLTIP_COLUMN,
-  PROP_ACTIVATE_ON_SINGLE_CLICK
+  PROP_ACTIVATE_ON_SINGLE_CLICK,
+  PROP_THREADED_VALIDATION
 };
 
 /* object signals */
@@ -704,6 +734,10 @@ static void gtk_tree_view_rows_reordered                  (GtkTreeModel    *mode
 							   GtkTreeIter     *iter,
 							   gint            *new_order,
 							   gpointer         data);
+static void gtk_tree_view_begin_bulk_update               (GtkListStore    *list_store,
+							   gpointer         data);
+static void gtk_tree_view_end_bulk_update                 (GtkListStore    *list_store,
+							   gpointer         data);
 
 /* Incremental reflow */
 static gboolean validate_row             (GtkTreeView *tree_view,
@@ -716,7 +750,11 @@ static gboolean do_validate_rows         (GtkTreeView *tree_view,
 					  gboolean     queue_resize);
 static gboolean validate_rows            (GtkTreeView *tree_view);
 static void     install_presize_handler  (GtkTreeView *tree_view);
+static void     gtk_tree_view_stop_threaded_validation (GtkTreeView *tree_view);
 static void     install_scroll_sync_handler (GtkTreeView *tree_view);
+static void     install_load_rows_handler   (GtkTreeView *tree_view);
+static gboolean gtk_tree_view_row_is_loaded (GtkTreeView *tree_view,
+                                             GtkTreeIter *iter);
 static void     gtk_tree_view_set_top_row   (GtkTreeView *tree_view,
 					     GtkTreePath *path,
 					     gint         offset);
@@ -1196,6 +1234,25 @@ gtk_tree_view_class_init (GtkTreeViewClass *class)
 							 FALSE,
 							 GTK_PARAM_READWRITE));
 
+  /**
+   * GtkTreeView:threaded-validation:
+   *
+   * Whether the sizes of offscreen rows are computed in worker threads.
+   * See gtk_tree_view_set_threaded_validation().
+   *
+   * This is always %FALSE if the Pango version in use does not support
+   * it.
+   *
+   * Since: 3.10
+   */
+  g_object_class_install_property (o_class,
+                                   PROP_THREADED_VALIDATION,
+                                   g_param_spec_boolean ("threaded-validation",
+							 P_("Threaded validation"),
+							 P_("Whether to measure offscreen rows in worker threads"),
+							 FALSE,
+							 GTK_PARAM_READWRITE));
+
   /* Style properties */
 #define _TREE_VIEW_EXPANDER_SIZE 14
 #define _TREE_VIEW_VERTICAL_SEPARATOR 2
@@ -1751,6 +1808,7 @@ gtk_tree_view_init (GtkTreeView *tree_view)
   tree_view->priv->reorderable = FALSE;
   tree_view->priv->presize_handler_tick_cb = 0;
   tree_view->priv->scroll_sync_timer = 0;
+  tree_view->priv->load_rows_timer = 0;
   tree_view->priv->fixed_height = -1;
   tree_view->priv->fixed_height_mode = FALSE;
   tree_view->priv->fixed_height_check = 0;
@@ -1874,6 +1932,9 @@ gtk_tree_view_set_property (GObject         *object,
     case PROP_ACTIVATE_ON_SINGLE_CLICK:
       gtk_tree_view_set_activate_on_single_click (tree_view, g_value_get_boolean (value));
       break;
+    case PROP_THREADED_VALIDATION:
+      gtk_tree_view_set_threaded_validation (tree_view, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1958,6 +2019,9 @@ gtk_tree_view_get_property (GObject    *object,
     case PROP_ACTIVATE_ON_SINGLE_CLICK:
       g_value_set_boolean (value, tree_view->priv->activate_on_single_click);
       break;
+    case PROP_THREADED_VALIDATION:
+      g_value_set_boolean (value, tree_view->priv->row_validator != NULL);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1967,6 +2031,8 @@ gtk_tree_view_get_property (GObject    *object,
 static void
 gtk_tree_view_finalize (GObject *object)
 {
+  gtk_tree_view_stop_threaded_validation (GTK_TREE_VIEW (object));
+
   G_OBJECT_CLASS (gtk_tree_view_parent_class)->finalize (object);
 }
 
@@ -2009,6 +2075,9 @@ gtk_tree_view_buildable_get_internal_child (GtkBuildable      *buildable,
 static void
 gtk_tree_view_free_rbtree (GtkTreeView *tree_view)
 {
+  tree_view->priv->validate_generation++;
+  tree_view->priv->bulk_last_node = NULL;
+
   _gtk_rbtree_free (tree_view->priv->tree);
   
   tree_view->priv->tree = NULL;
@@ -2405,6 +2474,12 @@ gtk_tree_view_unrealize (GtkWidget *widget)
       priv->scroll_sync_timer = 0;
     }
 
+  if (priv->load_rows_timer != 0)
+    {
+      g_source_remove (priv->load_rows_timer);
+      priv->load_rows_timer = 0;
+    }
+
   if (priv->typeselect_flush_timeout)
     {
       g_source_remove (priv->typeselect_flush_timeout);
@@ -4803,6 +4878,7 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
   gboolean draw_vgrid_lines, draw_hgrid_lines;
   GtkStyleContext *context;
   gboolean parity;
+  gboolean need_load = FALSE;
 
   rtl = (gtk_widget_get_direction (widget) == GTK_TEXT_DIR_RTL);
   context = gtk_widget_get_style_context (widget);
@@ -4908,10 +4984,17 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
       gboolean is_separator = FALSE;
       gboolean is_first = FALSE;
       gboolean is_last = FALSE;
+      gboolean is_loaded;
       gint n_col = 0;
 
       parity = !parity;
-      is_separator = row_is_separator (tree_view, &iter, NULL);
+
+      /* Rows which are not loaded yet are drawn empty */
+      is_loaded = gtk_tree_view_row_is_loaded (tree_view, &iter);
+      if (is_loaded)
+        is_separator = row_is_separator (tree_view, &iter, NULL);
+      else
+        need_load = TRUE;
 
       max_height = gtk_tree_view_get_row_height (tree_view, node);
 
@@ -4935,7 +5018,7 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
        * return a correct value.
        */
       for (list = (rtl ? g_list_last (tree_view->priv->columns) : g_list_first (tree_view->priv->columns));
-	   list;
+	   list && is_loaded;
 	   list = (rtl ? list->prev : list->next))
         {
 	  GtkTreeViewColumn *column = list->data;
@@ -5030,11 +5113,12 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
 	      continue;
 	    }
 
-	  gtk_tree_view_column_cell_set_cell_data (column,
-						   tree_view->priv->model,
-						   &iter,
-						   GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_IS_PARENT),
-						   node->children?TRUE:FALSE);
+	  if (is_loaded)
+	    gtk_tree_view_column_cell_set_cell_data (column,
+						     tree_view->priv->model,
+						     &iter,
+						     GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_IS_PARENT),
+						     node->children?TRUE:FALSE);
 
           /* Select the detail for drawing the cell.  relevant
            * factors are parity, sortedness, and whether to
@@ -5132,7 +5216,7 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
 
                   gtk_style_context_restore (context);
                 }
-	      else
+	      else if (is_loaded)
                 {
                   _gtk_tree_view_column_cell_render (column,
                                                      cr,
@@ -5166,7 +5250,7 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
 
                   gtk_style_context_restore (context);
                 }
-	      else
+	      else if (is_loaded)
 		_gtk_tree_view_column_cell_render (column,
 						   cr,
 						   &background_area,
@@ -5409,6 +5493,9 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
 done:
   gtk_tree_view_draw_grid_lines (tree_view, cr);
 
+  if (need_load)
+    install_load_rows_handler (tree_view);
+
   if (tree_view->priv->rubber_band_status == RUBBER_BAND_ACTIVE)
     gtk_tree_view_paint_rubber_band (tree_view, cr);
 
@@ -6080,69 +6167,225 @@ node_is_visible (GtkTreeView *tree_view,
   return FALSE;
 }
 
+/* Rows of a GtkTreeLoadable model whose contents have not arrived yet
+ * are measured and drawn without asking the model for their values.
+ */
+static gboolean
+gtk_tree_view_row_is_loaded (GtkTreeView *tree_view,
+                             GtkTreeIter *iter)
+{
+  if (!tree_view->priv->is_loadable)
+    return TRUE;
+
+  return gtk_tree_loadable_row_is_loaded (GTK_TREE_LOADABLE (tree_view->priv->model),
+                                          iter);
+}
+
+static gboolean
+load_rows_handler (GtkTreeView *tree_view)
+{
+  GtkTreePath *start_path, *end_path;
+
+  tree_view->priv->load_rows_timer = 0;
+
+  if (tree_view->priv->is_loadable &&
+      gtk_tree_view_get_visible_range (tree_view, &start_path, &end_path))
+    {
+      gtk_tree_loadable_load_rows (GTK_TREE_LOADABLE (tree_view->priv->model),
+                                   start_path, end_path);
+
+      gtk_tree_path_free (start_path);
+      gtk_tree_path_free (end_path);
+    }
+
+  return FALSE;
+}
+
+static void
+install_load_rows_handler (GtkTreeView *tree_view)
+{
+  if (!tree_view->priv->load_rows_timer)
+    {
+      tree_view->priv->load_rows_timer =
+	gdk_threads_add_idle_full (GTK_TREE_VIEW_PRIORITY_LOAD_ROWS, (GSourceFunc) load_rows_handler, tree_view, NULL);
+    }
+}
+
+static gint
+gtk_tree_view_get_estimated_row_height (GtkTreeView *tree_view)
+{
+  if (tree_view->priv->n_measured_heights == 0)
+    return 0;
+
+  return tree_view->priv->measured_height_sum / tree_view->priv->n_measured_heights;
+}
+
+static void
+clear_measured_heights (GtkRBTree *tree)
+{
+  GtkRBNode *node;
+
+  if (tree == NULL)
+    return;
+
+  for (node = _gtk_rbtree_first (tree); node; node = _gtk_rbtree_next (tree, node))
+    {
+      GTK_RBNODE_UNSET_FLAG (node, GTK_RBNODE_HEIGHT_MEASURED);
+
+      if (node->children)
+        clear_measured_heights (node->children);
+    }
+}
+
+/* Forget the heights measured so far.  Needed whenever row heights
+ * change for reasons other than the rows themselves, like a new font
+ * or different columns.
+ */
+static void
+gtk_tree_view_reset_estimated_row_height (GtkTreeView *tree_view)
+{
+  tree_view->priv->validate_generation++;
+  tree_view->priv->measured_height_sum = 0;
+  tree_view->priv->n_measured_heights = 0;
+  clear_measured_heights (tree_view->priv->tree);
+}
+
+/* Everything validate_row() needs that does not depend on the row
+ * itself. Looking up style properties and the first/last visible
+ * columns is a significant part of the cost of validating a row, so
+ * when validating many rows in one go we only do it once per batch.
+ */
+typedef struct
+{
+  GList   *first_column;
+  GList   *last_column;
+  gint     horizontal_separator;
+  gint     vertical_separator;
+  gint     focus_pad;
+  gint     grid_line_width;
+  gint     separator_height;
+  gint     expander_size;
+  gboolean wide_separators;
+  gboolean draw_vgrid_lines;
+  gboolean draw_hgrid_lines;
+  gboolean draw_expanders;
+} ValidateRowMetrics;
+
+static void
+validate_row_metrics_init (GtkTreeView        *tree_view,
+                           ValidateRowMetrics *metrics)
+{
+  GList *list;
+
+  gtk_widget_style_get (GTK_WIDGET (tree_view),
+			"focus-padding", &metrics->focus_pad,
+			"horizontal-separator", &metrics->horizontal_separator,
+			"vertical-separator", &metrics->vertical_separator,
+			"grid-line-width", &metrics->grid_line_width,
+                        "wide-separators",  &metrics->wide_separators,
+                        "separator-height", &metrics->separator_height,
+			NULL);
+
+  metrics->draw_vgrid_lines =
+    tree_view->priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_VERTICAL
+    || tree_view->priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_BOTH;
+  metrics->draw_hgrid_lines =
+    tree_view->priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_HORIZONTAL
+    || tree_view->priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_BOTH;
+  metrics->expander_size = gtk_tree_view_get_expander_size (tree_view);
+  metrics->draw_expanders = gtk_tree_view_draw_expanders (tree_view);
+
+  for (list = g_list_last (tree_view->priv->columns);
+       list &&
+       !(gtk_tree_view_column_get_visible (GTK_TREE_VIEW_COLUMN (list->data)));
+       list = list->prev)
+    ;
+  metrics->last_column = list;
+
+  for (list = g_list_first (tree_view->priv->columns);
+       list &&
+       !(gtk_tree_view_column_get_visible (GTK_TREE_VIEW_COLUMN (list->data)));
+       list = list->next)
+    ;
+  metrics->first_column = list;
+}
+
+/* The space around the cells of the column at @list in rows at @depth
+ */
+static gint
+validate_row_column_padding (GtkTreeView              *tree_view,
+                             const ValidateRowMetrics *metrics,
+                             GList                    *list,
+                             gint                      depth)
+{
+  gint padding = 0;
+
+  if (gtk_tree_view_is_expander_column (tree_view, list->data))
+    {
+      padding += metrics->horizontal_separator + (depth - 1) * tree_view->priv->level_indentation;
+
+      if (metrics->draw_expanders)
+        padding += depth * metrics->expander_size;
+    }
+  else
+    padding += metrics->horizontal_separator;
+
+  if (metrics->draw_vgrid_lines)
+    {
+      if (list->data == metrics->first_column || list->data == metrics->last_column)
+        padding += metrics->grid_line_width / 2.0;
+      else
+        padding += metrics->grid_line_width;
+    }
+
+  return padding;
+}
+
 /* Returns TRUE if it updated the size
  */
 static gboolean
-validate_row (GtkTreeView *tree_view,
-	      GtkRBTree   *tree,
-	      GtkRBNode   *node,
-	      GtkTreeIter *iter,
-	      GtkTreePath *path)
+validate_row_with_metrics (GtkTreeView              *tree_view,
+                           const ValidateRowMetrics *metrics,
+                           GtkRBTree                *tree,
+                           GtkRBNode                *node,
+                           GtkTreeIter              *iter,
+                           GtkTreePath              *path)
 {
   GtkTreeViewColumn *column;
-  GList *list, *first_column, *last_column;
+  GList *list;
   gint height = 0;
-  gint horizontal_separator;
-  gint vertical_separator;
   gint depth = gtk_tree_path_get_depth (path);
   gboolean retval = FALSE;
   gboolean is_separator = FALSE;
-  gboolean draw_vgrid_lines, draw_hgrid_lines;
-  gint focus_pad;
-  gint grid_line_width;
-  gboolean wide_separators;
-  gint separator_height;
-  gint expander_size;
 
   /* double check the row needs validating */
   if (! GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID) &&
       ! GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
     return FALSE;
 
-  is_separator = row_is_separator (tree_view, iter, NULL);
+  if (!gtk_tree_view_row_is_loaded (tree_view, iter))
+    {
+      /* Size the row like the rows measured so far.  The model emits
+       * row-changed once the row is loaded, which invalidates it again.
+       */
+      height = gtk_tree_view_get_estimated_row_height (tree_view);
+      if (height == 0)
+        height = metrics->expander_size + metrics->vertical_separator;
 
-  gtk_widget_style_get (GTK_WIDGET (tree_view),
-			"focus-padding", &focus_pad,
-			"horizontal-separator", &horizontal_separator,
-			"vertical-separator", &vertical_separator,
-			"grid-line-width", &grid_line_width,
-                        "wide-separators",  &wide_separators,
-                        "separator-height", &separator_height,
-			NULL);
-  
-  draw_vgrid_lines =
-    tree_view->priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_VERTICAL
-    || tree_view->priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_BOTH;
-  draw_hgrid_lines =
-    tree_view->priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_HORIZONTAL
-    || tree_view->priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_BOTH;
-  expander_size = gtk_tree_view_get_expander_size (tree_view);
+      if (height != GTK_RBNODE_GET_HEIGHT (node))
+        {
+          retval = TRUE;
+          _gtk_rbtree_node_set_height (tree, node, height);
+        }
+      _gtk_rbtree_node_mark_valid (tree, node);
 
-  for (last_column = g_list_last (tree_view->priv->columns);
-       last_column &&
-       !(gtk_tree_view_column_get_visible (GTK_TREE_VIEW_COLUMN (last_column->data)));
-       last_column = last_column->prev)
-    ;
+      return retval;
+    }
 
-  for (first_column = g_list_first (tree_view->priv->columns);
-       first_column &&
-       !(gtk_tree_view_column_get_visible (GTK_TREE_VIEW_COLUMN (first_column->data)));
-       first_column = first_column->next)
-    ;
+  is_separator = row_is_separator (tree_view, iter, NULL);
 
   for (list = tree_view->priv->columns; list; list = list->next)
     {
-      gint padding = 0;
       gint original_width;
       gint new_width;
       gint row_height;
@@ -6167,46 +6410,40 @@ validate_row (GtkTreeView *tree_view,
 
       if (!is_separator)
 	{
-          row_height += vertical_separator;
+          row_height += metrics->vertical_separator;
 	  height = MAX (height, row_height);
-	  height = MAX (height, expander_size);
+	  height = MAX (height, metrics->expander_size);
 	}
       else
         {
-          if (wide_separators)
-            height = separator_height + 2 * focus_pad;
+          if (metrics->wide_separators)
+            height = metrics->separator_height + 2 * metrics->focus_pad;
           else
-            height = 2 + 2 * focus_pad;
+            height = 2 + 2 * metrics->focus_pad;
         }
 
-      if (gtk_tree_view_is_expander_column (tree_view, column))
-        {
-	  padding += horizontal_separator + (depth - 1) * tree_view->priv->level_indentation;
-
-	  if (gtk_tree_view_draw_expanders (tree_view))
-	    padding += depth * expander_size;
-	}
-      else
-	padding += horizontal_separator;
-
-      if (draw_vgrid_lines)
-        {
-	  if (list->data == first_column || list->data == last_column)
-	    padding += grid_line_width / 2.0;
-	  else
-	    padding += grid_line_width;
-	}
-
       /* Update the padding for the column */
-      _gtk_tree_view_column_push_padding (column, padding);
+      _gtk_tree_view_column_push_padding (column,
+                                          validate_row_column_padding (tree_view, metrics,
+                                                                       list, depth));
       new_width = _gtk_tree_view_column_get_requested_width (column);
 
       if (new_width > original_width)
 	retval = TRUE;
     }
 
-  if (draw_hgrid_lines)
-    height += grid_line_width;
+  if (metrics->draw_hgrid_lines)
+    height += metrics->grid_line_width;
+
+  /* Count every row once, so rows that get validated over and over
+   * again don't outweigh the rest.
+   */
+  if (!GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_HEIGHT_MEASURED))
+    {
+      tree_view->priv->measured_height_sum += height;
+      tree_view->priv->n_measured_heights++;
+      GTK_RBNODE_SET_FLAG (node, GTK_RBNODE_HEIGHT_MEASURED);
+    }
 
   if (height != GTK_RBNODE_GET_HEIGHT (node))
     {
@@ -6218,6 +6455,27 @@ validate_row (GtkTreeView *tree_view,
   return retval;
 }
 
+/* Returns TRUE if it updated the size
+ */
+static gboolean
+validate_row (GtkTreeView *tree_view,
+	      GtkRBTree   *tree,
+	      GtkRBNode   *node,
+	      GtkTreeIter *iter,
+	      GtkTreePath *path)
+{
+  ValidateRowMetrics metrics;
+
+  /* double check the row needs validating */
+  if (! GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID) &&
+      ! GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
+    return FALSE;
+
+  validate_row_metrics_init (tree_view, &metrics);
+
+  return validate_row_with_metrics (tree_view, &metrics, tree, node, iter, path);
+}
+
 
 static void
 validate_visible_area (GtkTreeView *tree_view)
@@ -6233,6 +6491,7 @@ validate_visible_area (GtkTreeView *tree_view)
   gint total_height;
   gint area_above = 0;
   gint area_below = 0;
+  ValidateRowMetrics metrics;
 
   if (tree_view->priv->tree == NULL)
     return;
@@ -6247,6 +6506,8 @@ validate_visible_area (GtkTreeView *tree_view)
   if (total_height == 0)
     return;
 
+  validate_row_metrics_init (tree_view, &metrics);
+
   /* First, we check to see if we need to scroll anywhere
    */
   if (tree_view->priv->scroll_to_path)
@@ -6260,7 +6521,7 @@ validate_visible_area (GtkTreeView *tree_view)
 	      GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
 	    {
 	      _gtk_tree_view_queue_draw_node (tree_view, tree, node, NULL);
-	      if (validate_row (tree_view, tree, node, &iter, path))
+	      if (validate_row_with_metrics (tree_view, &metrics, tree, node, &iter, path))
 		size_changed = TRUE;
 	    }
 
@@ -6373,7 +6634,7 @@ validate_visible_area (GtkTreeView *tree_view)
 	  GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
 	{
 	  _gtk_tree_view_queue_draw_node (tree_view, tree, node, NULL);
-	  if (validate_row (tree_view, tree, node, &iter, path))
+	  if (validate_row_with_metrics (tree_view, &metrics, tree, node, &iter, path))
 	    size_changed = TRUE;
 	}
       area_above = 0;
@@ -6408,7 +6669,7 @@ validate_visible_area (GtkTreeView *tree_view)
 	      GTK_RBNODE_FLAG_SET (tmpnode, GTK_RBNODE_COLUMN_INVALID))
 	    {
 	      _gtk_tree_view_queue_draw_node (tree_view, tmptree, tmpnode, NULL);
-	      if (validate_row (tree_view, tmptree, tmpnode, &tmpiter, tmppath))
+	      if (validate_row_with_metrics (tree_view, &metrics, tmptree, tmpnode, &tmpiter, tmppath))
 		size_changed = TRUE;
 	    }
 
@@ -6480,7 +6741,7 @@ validate_visible_area (GtkTreeView *tree_view)
 	  GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
 	{
 	  _gtk_tree_view_queue_draw_node (tree_view, tree, node, NULL);
-	  if (validate_row (tree_view, tree, node, &iter, path))
+	  if (validate_row_with_metrics (tree_view, &metrics, tree, node, &iter, path))
 	      size_changed = TRUE;
 	}
 
@@ -6521,7 +6782,7 @@ validate_visible_area (GtkTreeView *tree_view)
 	  GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
 	{
 	  _gtk_tree_view_queue_draw_node (tree_view, tree, node, NULL);
-	  if (validate_row (tree_view, tree, node, &iter, above_path))
+	  if (validate_row_with_metrics (tree_view, &metrics, tree, node, &iter, above_path))
 	    size_changed = TRUE;
 	}
       area_above -= gtk_tree_view_get_row_height (tree_view, node);
@@ -6625,49 +6886,675 @@ initialize_fixed_height_mode (GtkTreeView *tree_view)
  * the first invalid node.
  */
 
-static gboolean
-do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
+/* Finds the first row that needs validating. There must be one.
+ */
+static void
+find_first_invalid_node (GtkTreeView  *tree_view,
+                         GtkRBTree   **tree_out,
+                         GtkRBNode   **node_out)
 {
-  static gboolean prevent_recursion_hack = FALSE;
+  GtkRBTree *tree;
+  GtkRBNode *node;
 
-  GtkRBTree *tree = NULL;
-  GtkRBNode *node = NULL;
-  gboolean validated_area = FALSE;
-  gint retval = TRUE;
-  GtkTreePath *path = NULL;
-  GtkTreeIter iter;
-  GTimer *timer;
-  gint i = 0;
+  tree = tree_view->priv->tree;
+  node = tree_view->priv->tree->root;
 
-  gint y = -1;
-  gint prev_height = -1;
-  gboolean fixed_height = TRUE;
+  g_assert (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_DESCENDANTS_INVALID));
 
-  g_assert (tree_view);
+  do
+    {
+      if (!_gtk_rbtree_is_nil (node->left) &&
+          GTK_RBNODE_FLAG_SET (node->left, GTK_RBNODE_DESCENDANTS_INVALID))
+        {
+          node = node->left;
+        }
+      else if (!_gtk_rbtree_is_nil (node->right) &&
+               GTK_RBNODE_FLAG_SET (node->right, GTK_RBNODE_DESCENDANTS_INVALID))
+        {
+          node = node->right;
+        }
+      else if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID) ||
+               GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
+        {
+          break;
+        }
+      else if (node->children != NULL)
+        {
+          tree = node->children;
+          node = tree->root;
+        }
+      else
+        /* RBTree corruption!  All bad */
+        g_assert_not_reached ();
+    }
+  while (TRUE);
 
-  /* prevent infinite recursion via get_preferred_width() */
-  if (prevent_recursion_hack)
-    return FALSE;
+  *tree_out = tree;
+  *node_out = node;
+}
 
-  if (tree_view->priv->tree == NULL)
-      return FALSE;
+/* prevent infinite recursion via get_preferred_width() */
+static gboolean prevent_recursion_hack = FALSE;
 
-  if (tree_view->priv->fixed_height_mode)
-    {
-      if (tree_view->priv->fixed_height < 0)
-        initialize_fixed_height_mode (tree_view);
+/* Updates the scroll adjustments and queues a resize after rows were
+ * validated. @y is the offset of the first row that changed height,
+ * or -1.
+ */
+static void
+gtk_tree_view_rows_validated (GtkTreeView *tree_view,
+                              gint         y,
+                              gboolean     queue_resize)
+{
+  GtkRequisition requisition;
 
-      return FALSE;
-    }
+  /* We temporarily guess a size, under the assumption that it will be the
+   * same when we get our next size_allocate.  If we don't do this, we'll be
+   * in an inconsistent state when we call top_row_to_dy. */
 
-  timer = g_timer_new ();
-  g_timer_start (timer);
+  /* FIXME: This is called from size_request, for some reason it is not infinitely
+   * recursing, we cannot call gtk_widget_get_preferred_size() here because that's
+   * not allowed (from inside ->get_preferred_width/height() implementations, one
+   * should call the vfuncs directly). However what is desired here is the full
+   * size including any margins and limited by any alignment (i.e. after 
+   * GtkWidget:adjust_size_request() is called).
+   *
+   * Currently bypassing this but the real solution is to not update the scroll adjustments
+   * untill we've recieved an allocation (never update scroll adjustments from size-requests).
+   */
+  prevent_recursion_hack = TRUE;
+  gtk_tree_view_get_preferred_width (GTK_WIDGET (tree_view), &requisition.width, NULL);
+  gtk_tree_view_get_preferred_height (GTK_WIDGET (tree_view), &requisition.height, NULL);
+  prevent_recursion_hack = FALSE;
 
-  do
-    {
-      gboolean changed = FALSE;
+  /* If rows above the current position have changed height, this has
+   * affected the current view and thus needs a redraw.
+   */
+  if (y != -1 && y < gtk_adjustment_get_value (tree_view->priv->vadjustment))
+    gtk_widget_queue_draw (GTK_WIDGET (tree_view));
 
-      if (! GTK_RBNODE_FLAG_SET (tree_view->priv->tree->root, GTK_RBNODE_DESCENDANTS_INVALID))
+  gtk_adjustment_set_upper (tree_view->priv->hadjustment,
+                            MAX (gtk_adjustment_get_upper (tree_view->priv->hadjustment), requisition.width));
+  gtk_adjustment_set_upper (tree_view->priv->vadjustment,
+                            MAX (gtk_adjustment_get_upper (tree_view->priv->vadjustment), requisition.height));
+
+  if (queue_resize)
+    gtk_widget_queue_resize_no_redraw (GTK_WIDGET (tree_view));
+}
+
+/*
+ * Threaded validation
+ *
+ * Validating a row asks the cell renderers of every visible column for
+ * their size, and for text cells that means shaping the text with
+ * Pango, which is where most of the time goes. With threaded
+ * validation enabled, validate_rows() copies the texts of a batch of
+ * invalid rows and the fonts of the columns into jobs, and worker
+ * threads shape them. An idle on the main thread then turns the
+ * results into row heights and column widths, the same way
+ * validate_row() would have.
+ *
+ * This is only done for list models whose visible columns all show
+ * plain text, see _gtk_tree_view_column_get_text_cell(); other views
+ * validate their rows on the main thread as before. Pango font maps
+ * must not be shared between threads, so each worker shapes with a
+ * font map of its own, and only views using the default font map can
+ * be measured that way.
+ *
+ * The jobs point to the nodes of the rows they measure. Anything that
+ * may free those nodes, change their contents or change the way
+ * columns are measured bumps validate_generation, and results of an
+ * older generation are dropped.
+ */
+
+#define ROW_VALIDATE_BATCH_SIZE 2048
+#define ROW_VALIDATE_MAX_THREADS 4
+#define ROW_VALIDATE_PRIORITY GTK_TREE_VIEW_PRIORITY_VALIDATE
+
+typedef struct
+{
+  GtkTreeViewColumn *column;
+  GList *link;
+  gint model_column;
+  PangoFontDescription *font_desc;
+  gint xpad;
+  gint ypad;
+} RowValidateColumn;
+
+typedef struct
+{
+  /* In pixels, without the padding of the cell */
+  gint min_width;
+  gint nat_width;
+  gint height;
+} RowValidateSize;
+
+typedef struct
+{
+  RowValidator *validator;
+  guint generation;
+
+  /* Snapshot of the rows, owned by the job */
+  gint n_rows;
+  gint n_columns;
+  GtkRBNode **nodes;
+  gchar **texts;
+  RowValidateColumn *columns;
+  PangoLanguage *language;
+  PangoDirection base_dir;
+  cairo_font_options_t *font_options;
+  gdouble resolution;
+
+  /* Filled in by the worker, n_columns sizes per row */
+  RowValidateSize *sizes;
+} RowValidateJob;
+
+struct _RowValidator
+{
+  volatile gint ref_count;
+  volatile gint idle_queued;
+
+  /* Jobs done by the workers */
+  GAsyncQueue *results;
+
+  /* Main thread only; tree_view is NULL once the view stopped
+   * validating in threads, so that late results are dropped.
+   */
+  GtkTreeView *tree_view;
+  gint n_pending_jobs;
+};
+
+static GThreadPool *row_validate_pool = NULL;
+static GPrivate row_validate_font_map = G_PRIVATE_INIT (g_object_unref);
+
+static RowValidator *
+row_validator_new (GtkTreeView *tree_view)
+{
+  RowValidator *validator;
+
+  validator = g_slice_new0 (RowValidator);
+  validator->ref_count = 1;
+  validator->results = g_async_queue_new ();
+  validator->tree_view = tree_view;
+
+  return validator;
+}
+
+static RowValidator *
+row_validator_ref (RowValidator *validator)
+{
+  g_atomic_int_inc (&validator->ref_count);
+
+  return validator;
+}
+
+static void
+row_validator_unref (RowValidator *validator)
+{
+  if (g_atomic_int_dec_and_test (&validator->ref_count))
+    {
+      g_async_queue_unref (validator->results);
+      g_slice_free (RowValidator, validator);
+    }
+}
+
+static void
+row_validate_column_clear (RowValidateColumn *column)
+{
+  pango_font_description_free (column->font_desc);
+}
+
+static void
+row_validate_job_free (RowValidateJob *job)
+{
+  gint i;
+
+  for (i = 0; i < job->n_rows * job->n_columns; i++)
+    g_free (job->texts[i]);
+  for (i = 0; i < job->n_columns; i++)
+    row_validate_column_clear (&job->columns[i]);
+  if (job->font_options)
+    cairo_font_options_destroy (job->font_options);
+
+  g_free (job->nodes);
+  g_free (job->texts);
+  g_free (job->columns);
+  g_free (job->sizes);
+
+  row_validator_unref (job->validator);
+
+  g_slice_free (RowValidateJob, job);
+}
+
+/* Whether the job measured the columns that are visible now */
+static gboolean
+row_validate_job_has_columns (GtkTreeView    *tree_view,
+                              RowValidateJob *job)
+{
+  GList *list;
+  gint j = 0;
+
+  for (list = tree_view->priv->columns; list; list = list->next)
+    {
+      if (!gtk_tree_view_column_get_visible (list->data))
+        continue;
+
+      if (j >= job->n_columns ||
+          job->columns[j].link != list ||
+          job->columns[j].column != list->data)
+        return FALSE;
+
+      j++;
+    }
+
+  return j == job->n_columns;
+}
+
+static void
+row_validate_job_finish (GtkTreeView    *tree_view,
+                         RowValidateJob *job)
+{
+  ValidateRowMetrics metrics;
+  gboolean validated_area = FALSE;
+  gint focus_line_width;
+  gint y = -1;
+  gint i, j;
+
+  /* The rows or the columns changed while the job was running */
+  if (job->generation != tree_view->priv->validate_generation ||
+      !row_validate_job_has_columns (tree_view, job))
+    return;
+
+  validate_row_metrics_init (tree_view, &metrics);
+  gtk_widget_style_get (GTK_WIDGET (tree_view),
+                        "focus-line-width", &focus_line_width,
+                        NULL);
+  focus_line_width *= 2;
+
+  for (i = 0; i < job->n_rows; i++)
+    {
+      GtkRBNode *node = job->nodes[i];
+      gint height = 0;
+
+      /* Validated on the main thread in the meantime */
+      if (!GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID) &&
+          !GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
+        continue;
+
+      /* Same sizes as gtk_tree_view_column_cell_get_size() and
+       * validate_row() come up with for a GtkCellRendererText.
+       */
+      for (j = 0; j < job->n_columns; j++)
+        {
+          RowValidateColumn *column = &job->columns[j];
+          RowValidateSize *size = &job->sizes[i * job->n_columns + j];
+          gint original_width;
+
+          original_width = _gtk_tree_view_column_get_requested_width (column->column);
+
+          _gtk_tree_view_column_push_cell_width (column->column,
+                                                 size->min_width + column->xpad * 2 + focus_line_width,
+                                                 size->nat_width + column->xpad * 2 + focus_line_width);
+          _gtk_tree_view_column_push_padding (column->column,
+                                              validate_row_column_padding (tree_view, &metrics,
+                                                                           column->link, 1));
+
+          if (_gtk_tree_view_column_get_requested_width (column->column) > original_width)
+            validated_area = TRUE;
+
+          height = MAX (height, size->height + column->ypad * 2 + focus_line_width +
+                                metrics.vertical_separator);
+          height = MAX (height, metrics.expander_size);
+        }
+
+      if (metrics.draw_hgrid_lines)
+        height += metrics.grid_line_width;
+
+      if (!GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_HEIGHT_MEASURED))
+        {
+          tree_view->priv->measured_height_sum += height;
+          tree_view->priv->n_measured_heights++;
+          GTK_RBNODE_SET_FLAG (node, GTK_RBNODE_HEIGHT_MEASURED);
+        }
+
+      if (height != GTK_RBNODE_GET_HEIGHT (node))
+        {
+          gint offset;
+
+          _gtk_rbtree_node_set_height (tree_view->priv->tree, node, height);
+
+          offset = gtk_tree_view_get_row_y_offset (tree_view, tree_view->priv->tree, node);
+          if (y == -1 || y > offset)
+            y = offset;
+
+          validated_area = TRUE;
+        }
+      _gtk_rbtree_node_mark_valid (tree_view->priv->tree, node);
+    }
+
+  if (validated_area)
+    gtk_tree_view_rows_validated (tree_view, y, TRUE);
+}
+
+static gboolean
+row_validator_idle (gpointer data)
+{
+  RowValidator *validator = data;
+  RowValidateJob *job;
+  GtkTreeView *tree_view;
+
+  g_atomic_int_set (&validator->idle_queued, FALSE);
+
+  while ((job = g_async_queue_try_pop (validator->results)) != NULL)
+    {
+      if (validator->tree_view)
+        {
+          validator->n_pending_jobs--;
+          row_validate_job_finish (validator->tree_view, job);
+        }
+
+      row_validate_job_free (job);
+    }
+
+  /* Go on with the next batch once the workers are done */
+  tree_view = validator->tree_view;
+  if (tree_view && validator->n_pending_jobs == 0 &&
+      tree_view->priv->tree &&
+      GTK_RBNODE_FLAG_SET (tree_view->priv->tree->root, GTK_RBNODE_DESCENDANTS_INVALID))
+    install_presize_handler (tree_view);
+
+  return FALSE;
+}
+
+/* Runs in a worker thread */
+static void
+row_validate_thread (gpointer data,
+                     gpointer user_data)
+{
+  RowValidateJob *job = data;
+  RowValidator *validator;
+  PangoFontMap *font_map;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoRectangle rect;
+  gint i, j;
+
+  /* Once the job is queued the main thread may free it */
+  validator = row_validator_ref (job->validator);
+
+  font_map = g_private_get (&row_validate_font_map);
+  if (font_map == NULL)
+    {
+      font_map = pango_cairo_font_map_new ();
+      g_private_set (&row_validate_font_map, font_map);
+    }
+
+  context = pango_font_map_create_context (font_map);
+  pango_cairo_context_set_font_options (context, job->font_options);
+  pango_cairo_context_set_resolution (context, job->resolution);
+  pango_context_set_language (context, job->language);
+  pango_context_set_base_dir (context, job->base_dir);
+
+  layout = pango_layout_new (context);
+
+  for (j = 0; j < job->n_columns; j++)
+    {
+      pango_layout_set_font_description (layout, job->columns[j].font_desc);
+
+      for (i = 0; i < job->n_rows; i++)
+        {
+          const gchar *text = job->texts[i * job->n_columns + j];
+          RowValidateSize *size = &job->sizes[i * job->n_columns + j];
+
+          pango_layout_set_text (layout, text ? text : "", -1);
+
+          /* Like gtk_cell_renderer_text_get_preferred_width() */
+          pango_layout_get_extents (layout, NULL, &rect);
+          size->min_width = rect.x + PANGO_PIXELS_CEIL (rect.width);
+          size->nat_width = PANGO_PIXELS_CEIL (rect.width);
+
+          pango_layout_get_pixel_size (layout, NULL, &size->height);
+        }
+    }
+
+  g_object_unref (layout);
+  g_object_unref (context);
+
+  g_async_queue_push (validator->results, job);
+
+  if (g_atomic_int_compare_and_exchange (&validator->idle_queued, FALSE, TRUE))
+    gdk_threads_add_idle_full (ROW_VALIDATE_PRIORITY,
+                               row_validator_idle,
+                               row_validator_ref (validator),
+                               (GDestroyNotify) row_validator_unref);
+
+  row_validator_unref (validator);
+}
+
+/* Starts measuring a batch of invalid rows in worker threads. Returns
+ * %TRUE if rows are being measured that way, %FALSE if they need to be
+ * validated on the main thread.
+ */
+static gboolean
+gtk_tree_view_validate_rows_in_thread (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+  PangoContext *context;
+  GArray *columns;
+  GPtrArray *nodes;
+  GPtrArray *texts;
+  GtkRBTree *tree;
+  GtkRBNode *node;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  GList *list;
+  gint n_columns, n_threads, rows_per_job;
+  guint i, j;
+
+  if (priv->row_validator == NULL)
+    return FALSE;
+
+  if (priv->row_validator->n_pending_jobs > 0)
+    return TRUE;
+
+  /* The first rows are measured on the main thread, so that the
+   * other rows get an estimated height to start with.
+   */
+  if (priv->tree == NULL ||
+      !GTK_RBNODE_FLAG_SET (priv->tree->root, GTK_RBNODE_DESCENDANTS_INVALID) ||
+      !priv->is_list ||
+      priv->row_separator_func ||
+      priv->fixed_height_mode ||
+      !priv->fixed_height_check)
+    return FALSE;
+
+  context = gtk_widget_get_pango_context (GTK_WIDGET (tree_view));
+  if (pango_context_get_font_map (context) != pango_cairo_font_map_get_default ())
+    return FALSE;
+
+  columns = g_array_new (FALSE, FALSE, sizeof (RowValidateColumn));
+  g_array_set_clear_func (columns, (GDestroyNotify) row_validate_column_clear);
+  for (list = priv->columns; list; list = list->next)
+    {
+      RowValidateColumn column;
+      GtkCellRenderer *cell;
+
+      if (!gtk_tree_view_column_get_visible (list->data))
+        continue;
+
+      cell = _gtk_tree_view_column_get_text_cell (list->data, &column.model_column);
+      if (cell == NULL ||
+          gtk_tree_model_get_column_type (priv->model, column.model_column) != G_TYPE_STRING)
+        {
+          g_array_free (columns, TRUE);
+          return FALSE;
+        }
+
+      column.column = list->data;
+      column.link = list;
+      column.font_desc = pango_font_description_copy (pango_context_get_font_description (context));
+      pango_font_description_merge (column.font_desc,
+                                    _gtk_cell_renderer_text_get_plain_font (GTK_CELL_RENDERER_TEXT (cell)),
+                                    TRUE);
+      gtk_cell_renderer_get_padding (cell, &column.xpad, &column.ypad);
+      g_array_append_val (columns, column);
+    }
+
+  n_columns = columns->len;
+  if (n_columns == 0)
+    {
+      g_array_free (columns, TRUE);
+      return FALSE;
+    }
+
+  find_first_invalid_node (tree_view, &tree, &node);
+  path = _gtk_tree_path_new_from_rbtree (tree, node);
+  gtk_tree_model_get_iter (priv->model, &iter, path);
+  gtk_tree_path_free (path);
+
+  nodes = g_ptr_array_new ();
+  texts = g_ptr_array_new ();
+
+  while (node != NULL && nodes->len < ROW_VALIDATE_BATCH_SIZE)
+    {
+      if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID) ||
+          GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
+        {
+          /* Rows that aren't loaded get an estimated height */
+          if (!gtk_tree_view_row_is_loaded (tree_view, &iter))
+            break;
+
+          g_ptr_array_add (nodes, node);
+
+          for (j = 0; j < n_columns; j++)
+            {
+              gchar *text;
+
+              gtk_tree_model_get (priv->model, &iter,
+                                  g_array_index (columns, RowValidateColumn, j).model_column, &text,
+                                  -1);
+              g_ptr_array_add (texts, text);
+            }
+        }
+
+      node = _gtk_rbtree_next (tree, node);
+      if (node != NULL && !gtk_tree_model_iter_next (priv->model, &iter))
+        break;
+    }
+
+  if (nodes->len == 0)
+    {
+      g_ptr_array_free (nodes, TRUE);
+      g_ptr_array_free (texts, TRUE);
+      g_array_free (columns, TRUE);
+      return FALSE;
+    }
+
+  if (row_validate_pool == NULL)
+    row_validate_pool = g_thread_pool_new (row_validate_thread, NULL,
+                                           CLAMP (g_get_num_processors () - 1,
+                                                  1, ROW_VALIDATE_MAX_THREADS),
+                                           FALSE, NULL);
+
+  /* One job per worker */
+  n_threads = g_thread_pool_get_max_threads (row_validate_pool);
+  rows_per_job = (nodes->len + n_threads - 1) / n_threads;
+
+  for (i = 0; i < nodes->len; i += rows_per_job)
+    {
+      RowValidateJob *job;
+
+      job = g_slice_new0 (RowValidateJob);
+      job->validator = row_validator_ref (priv->row_validator);
+      job->generation = priv->validate_generation;
+
+      job->n_rows = MIN (rows_per_job, (gint) (nodes->len - i));
+      job->n_columns = n_columns;
+      job->nodes = g_memdup (nodes->pdata + i, job->n_rows * sizeof (GtkRBNode *));
+      job->texts = g_memdup (texts->pdata + i * n_columns,
+                             job->n_rows * n_columns * sizeof (gchar *));
+      job->columns = g_memdup (columns->data, n_columns * sizeof (RowValidateColumn));
+      for (j = 0; j < n_columns; j++)
+        job->columns[j].font_desc = pango_font_description_copy (job->columns[j].font_desc);
+
+      job->language = pango_context_get_language (context);
+      job->base_dir = pango_context_get_base_dir (context);
+      if (pango_cairo_context_get_font_options (context))
+        job->font_options = cairo_font_options_copy (pango_cairo_context_get_font_options (context));
+      job->resolution = pango_cairo_context_get_resolution (context);
+
+      job->sizes = g_new (RowValidateSize, job->n_rows * n_columns);
+
+      priv->row_validator->n_pending_jobs++;
+      g_thread_pool_push (row_validate_pool, job, NULL);
+    }
+
+  /* The jobs own the texts and copies of the fonts now */
+  g_ptr_array_free (nodes, TRUE);
+  g_ptr_array_free (texts, TRUE);
+  g_array_free (columns, TRUE);
+
+  return TRUE;
+}
+
+static void
+gtk_tree_view_stop_threaded_validation (GtkTreeView *tree_view)
+{
+  RowValidator *validator = tree_view->priv->row_validator;
+
+  if (validator == NULL)
+    return;
+
+  /* The rows still being measured stay invalid, so they get
+   * validated on the main thread instead.
+   */
+  validator->tree_view = NULL;
+  row_validator_unref (validator);
+  tree_view->priv->row_validator = NULL;
+}
+
+static gboolean
+do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
+{
+  GtkRBTree *tree = NULL;
+  GtkRBNode *node = NULL;
+  gboolean validated_area = FALSE;
+  gint retval = TRUE;
+  GtkTreePath *path = NULL;
+  GtkTreeIter iter;
+  GTimer *timer;
+  ValidateRowMetrics metrics;
+  gint i = 0;
+
+  gint y = -1;
+  gint prev_height = -1;
+  gboolean fixed_height = TRUE;
+
+  g_assert (tree_view);
+
+  if (prevent_recursion_hack)
+    return FALSE;
+
+  if (tree_view->priv->tree == NULL)
+      return FALSE;
+
+  if (tree_view->priv->fixed_height_mode)
+    {
+      if (tree_view->priv->fixed_height < 0)
+        initialize_fixed_height_mode (tree_view);
+
+      return FALSE;
+    }
+
+  timer = g_timer_new ();
+  g_timer_start (timer);
+
+  validate_row_metrics_init (tree_view, &metrics);
+
+  do
+    {
+      gboolean changed = FALSE;
+
+      if (! GTK_RBNODE_FLAG_SET (tree_view->priv->tree->root, GTK_RBNODE_DESCENDANTS_INVALID))
 	{
 	  retval = FALSE;
 	  goto done;
@@ -6690,43 +7577,12 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 
       if (path == NULL)
 	{
-	  tree = tree_view->priv->tree;
-	  node = tree_view->priv->tree->root;
-
-	  g_assert (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_DESCENDANTS_INVALID));
-
-	  do
-	    {
-	      if (!_gtk_rbtree_is_nil (node->left) &&
-		  GTK_RBNODE_FLAG_SET (node->left, GTK_RBNODE_DESCENDANTS_INVALID))
-		{
-		  node = node->left;
-		}
-              else if (!_gtk_rbtree_is_nil (node->right) &&
-		       GTK_RBNODE_FLAG_SET (node->right, GTK_RBNODE_DESCENDANTS_INVALID))
-		{
-		  node = node->right;
-		}
-	      else if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID) ||
-		       GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
-		{
-		  break;
-		}
-	      else if (node->children != NULL)
-		{
-		  tree = node->children;
-		  node = tree->root;
-		}
-	      else
-		/* RBTree corruption!  All bad */
-		g_assert_not_reached ();
-	    }
-	  while (TRUE);
+	  find_first_invalid_node (tree_view, &tree, &node);
 	  path = _gtk_tree_path_new_from_rbtree (tree, node);
 	  gtk_tree_model_get_iter (tree_view->priv->model, &iter, path);
 	}
 
-      changed = validate_row (tree_view, tree, node, &iter, path);
+      changed = validate_row_with_metrics (tree_view, &metrics, tree, node, &iter, path);
       validated_area = changed || validated_area;
 
       if (changed)
@@ -6754,50 +7610,23 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 
   if (!tree_view->priv->fixed_height_check)
    {
+     /* If all rows so far had the same height, assume the rest will
+      * too; otherwise give the remaining rows the mean height measured
+      * so far until we get to them.
+      */
      if (fixed_height)
        _gtk_rbtree_set_fixed_height (tree_view->priv->tree, prev_height, FALSE);
+     else
+       _gtk_rbtree_set_fixed_height (tree_view->priv->tree,
+                                     gtk_tree_view_get_estimated_row_height (tree_view),
+                                     FALSE);
 
      tree_view->priv->fixed_height_check = 1;
    }
   
  done:
   if (validated_area)
-    {
-      GtkRequisition requisition;
-
-      /* We temporarily guess a size, under the assumption that it will be the
-       * same when we get our next size_allocate.  If we don't do this, we'll be
-       * in an inconsistent state when we call top_row_to_dy. */
-
-      /* FIXME: This is called from size_request, for some reason it is not infinitely
-       * recursing, we cannot call gtk_widget_get_preferred_size() here because that's
-       * not allowed (from inside ->get_preferred_width/height() implementations, one
-       * should call the vfuncs directly). However what is desired here is the full
-       * size including any margins and limited by any alignment (i.e. after 
-       * GtkWidget:adjust_size_request() is called).
-       *
-       * Currently bypassing this but the real solution is to not update the scroll adjustments
-       * untill we've recieved an allocation (never update scroll adjustments from size-requests).
-       */
-      prevent_recursion_hack = TRUE;
-      gtk_tree_view_get_preferred_width (GTK_WIDGET (tree_view), &requisition.width, NULL);
-      gtk_tree_view_get_preferred_height (GTK_WIDGET (tree_view), &requisition.height, NULL);
-      prevent_recursion_hack = FALSE;
-
-      /* If rows above the current position have changed height, this has
-       * affected the current view and thus needs a redraw.
-       */
-      if (y != -1 && y < gtk_adjustment_get_value (tree_view->priv->vadjustment))
-        gtk_widget_queue_draw (GTK_WIDGET (tree_view));
-
-      gtk_adjustment_set_upper (tree_view->priv->hadjustment,
-                                MAX (gtk_adjustment_get_upper (tree_view->priv->hadjustment), requisition.width));
-      gtk_adjustment_set_upper (tree_view->priv->vadjustment,
-                                MAX (gtk_adjustment_get_upper (tree_view->priv->vadjustment), requisition.height));
-
-      if (queue_resize)
-        gtk_widget_queue_resize_no_redraw (GTK_WIDGET (tree_view));
-    }
+    gtk_tree_view_rows_validated (tree_view, y, queue_resize);
 
   if (path) gtk_tree_path_free (path);
   g_timer_destroy (timer);
@@ -6812,6 +7641,7 @@ do_presize_handler (GtkTreeView *tree_view)
     {
       if (tree_view->priv->tree)
 	_gtk_rbtree_column_invalid (tree_view->priv->tree);
+      gtk_tree_view_reset_estimated_row_height (tree_view);
       tree_view->priv->mark_rows_col_dirty = FALSE;
     }
   validate_visible_area (tree_view);
@@ -6859,6 +7689,15 @@ validate_rows (GtkTreeView *tree_view)
       return G_SOURCE_CONTINUE;
     }
 
+  /* row_validator_idle() installs the handler again once the
+   * workers are done.
+   */
+  if (gtk_tree_view_validate_rows_in_thread (tree_view))
+    {
+      tree_view->priv->validate_rows_timer = 0;
+      return G_SOURCE_REMOVE;
+    }
+
   retval = do_validate_rows (tree_view, TRUE);
   
   if (! retval && tree_view->priv->validate_rows_timer)
@@ -7032,6 +7871,7 @@ _gtk_tree_view_install_mark_rows_col_dirty (GtkTreeView *tree_view,
 					    gboolean     install_handler)
 {
   tree_view->priv->mark_rows_col_dirty = TRUE;
+  tree_view->priv->validate_generation++;
 
   if (install_handler)
     install_presize_handler (tree_view);
@@ -8542,6 +9382,7 @@ gtk_tree_view_style_updated (GtkWidget *widget)
 	}
 
       tree_view->priv->fixed_height = -1;
+      gtk_tree_view_reset_estimated_row_height (tree_view);
       _gtk_rbtree_mark_invalid (tree_view->priv->tree);
     }
 }
@@ -8738,6 +9579,8 @@ gtk_tree_view_row_changed (GtkTreeModel *model,
 
   g_return_if_fail (path != NULL || iter != NULL);
 
+  tree_view->priv->validate_generation++;
+
   if (tree_view->priv->cursor_node != NULL)
     cursor_path = _gtk_tree_path_new_from_rbtree (tree_view->priv->cursor_tree,
                                                   tree_view->priv->cursor_node);
@@ -8799,7 +9642,12 @@ gtk_tree_view_row_changed (GtkTreeModel *model,
  done:
   if (!tree_view->priv->fixed_height_mode &&
       gtk_widget_get_realized (GTK_WIDGET (tree_view)))
-    install_presize_handler (tree_view);
+    {
+      if (tree_view->priv->in_bulk_update)
+        tree_view->priv->bulk_presize_pending = TRUE;
+      else
+        install_presize_handler (tree_view);
+    }
   if (free_path)
     gtk_tree_path_free (path);
 }
@@ -8816,7 +9664,7 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
   GtkRBNode *tmpnode = NULL;
   gint depth;
   gint i = 0;
-  gint height;
+  gint height, insert_height;
   gboolean free_path = FALSE;
   gboolean node_visible = TRUE;
 
@@ -8888,30 +9736,63 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
 
   /* ref the node */
   gtk_tree_model_ref_node (tree_view->priv->model, iter);
+  /* Unless we know the height, insert the row with an estimated one.
+   * It stays invalid either way until it gets validated.
+   */
+  if (height > 0)
+    insert_height = height;
+  else
+    insert_height = gtk_tree_view_get_estimated_row_height (tree_view);
+
   if (indices[depth - 1] == 0)
     {
       tmpnode = _gtk_rbtree_find_count (tree, 1);
-      tmpnode = _gtk_rbtree_insert_before (tree, tmpnode, height, FALSE);
+      tmpnode = _gtk_rbtree_insert_before (tree, tmpnode, insert_height, FALSE);
     }
   else
     {
-      tmpnode = _gtk_rbtree_find_count (tree, indices[depth - 1]);
-      tmpnode = _gtk_rbtree_insert_after (tree, tmpnode, height, FALSE);
+      /* Consecutive rows of a bulk update go right after the
+       * previous one, which saves looking it up by index.
+       */
+      if (tree_view->priv->in_bulk_update &&
+          tree_view->priv->bulk_last_node != NULL &&
+          tree == tree_view->priv->tree &&
+          indices[depth - 1] == tree_view->priv->bulk_last_index + 1)
+        tmpnode = tree_view->priv->bulk_last_node;
+      else
+        tmpnode = _gtk_rbtree_find_count (tree, indices[depth - 1]);
+      tmpnode = _gtk_rbtree_insert_after (tree, tmpnode, insert_height, FALSE);
     }
 
   _gtk_tree_view_accessible_add (tree_view, tree, tmpnode);
 
  done:
+  /* Any insertion shifts the indices, so only the row just
+   * inserted can be remembered.
+   */
+  if (tree_view->priv->in_bulk_update && depth == 1 &&
+      node_visible && tree == tree_view->priv->tree && tmpnode != NULL)
+    {
+      tree_view->priv->bulk_last_node = tmpnode;
+      tree_view->priv->bulk_last_index = indices[depth - 1];
+    }
+  else
+    tree_view->priv->bulk_last_node = NULL;
+
   if (height > 0)
     {
       if (tree)
         _gtk_rbtree_node_mark_valid (tree, tmpnode);
 
-      if (node_visible && node_is_visible (tree_view, tree, tmpnode))
+      if (tree_view->priv->in_bulk_update)
+        tree_view->priv->bulk_resize_pending = TRUE;
+      else if (node_visible && node_is_visible (tree_view, tree, tmpnode))
 	gtk_widget_queue_resize (GTK_WIDGET (tree_view));
       else
 	gtk_widget_queue_resize_no_redraw (GTK_WIDGET (tree_view));
     }
+  else if (tree_view->priv->in_bulk_update)
+    tree_view->priv->bulk_presize_pending = TRUE;
   else
     install_presize_handler (tree_view);
   if (free_path)
@@ -9035,6 +9916,9 @@ gtk_tree_view_row_deleted (GtkTreeModel *model,
 
   g_return_if_fail (path != NULL);
 
+  tree_view->priv->validate_generation++;
+  tree_view->priv->bulk_last_node = NULL;
+
   gtk_tree_row_reference_deleted (G_OBJECT (data), path);
 
   if (_gtk_tree_view_find_node (tree_view, path, &tree, &node))
@@ -9136,9 +10020,14 @@ gtk_tree_view_row_deleted (GtkTreeModel *model,
       tree_view->priv->top_row = NULL;
     }
 
-  install_scroll_sync_handler (tree_view);
+  if (tree_view->priv->in_bulk_update)
+    tree_view->priv->bulk_resize_pending = TRUE;
+  else
+    {
+      install_scroll_sync_handler (tree_view);
 
-  gtk_widget_queue_resize (GTK_WIDGET (tree_view));
+      gtk_widget_queue_resize (GTK_WIDGET (tree_view));
+    }
 
   if (cursor_changed)
     {
@@ -9172,6 +10061,9 @@ gtk_tree_view_rows_reordered (GtkTreeModel *model,
   if (len < 2)
     return;
 
+  tree_view->priv->validate_generation++;
+  tree_view->priv->bulk_last_node = NULL;
+
   gtk_tree_row_reference_reordered (G_OBJECT (data),
 				    parent,
 				    iter,
@@ -9207,6 +10099,42 @@ gtk_tree_view_rows_reordered (GtkTreeModel *model,
   gtk_tree_view_dy_to_top_row (tree_view);
 }
 
+/* GtkListStore brackets gtk_list_store_insert_rows() and friends with
+ * these; the rows still arrive one by one, but the relayout is done
+ * once at the end.
+ */
+static void
+gtk_tree_view_begin_bulk_update (GtkListStore *list_store,
+                                 gpointer      data)
+{
+  GtkTreeView *tree_view = GTK_TREE_VIEW (data);
+
+  tree_view->priv->in_bulk_update = TRUE;
+  tree_view->priv->bulk_last_node = NULL;
+}
+
+static void
+gtk_tree_view_end_bulk_update (GtkListStore *list_store,
+                               gpointer      data)
+{
+  GtkTreeView *tree_view = GTK_TREE_VIEW (data);
+  GtkTreeViewPrivate *priv = tree_view->priv;
+
+  priv->in_bulk_update = FALSE;
+  priv->bulk_last_node = NULL;
+
+  if (priv->bulk_resize_pending)
+    {
+      install_scroll_sync_handler (tree_view);
+      gtk_widget_queue_resize (GTK_WIDGET (tree_view));
+    }
+  if (priv->bulk_presize_pending)
+    install_presize_handler (tree_view);
+
+  priv->bulk_resize_pending = FALSE;
+  priv->bulk_presize_pending = FALSE;
+}
+
 
 /* Internal tree functions
  */
@@ -9336,20 +10264,57 @@ gtk_tree_view_build_tree (GtkTreeView *tree_view,
 			  gboolean     recurse)
 {
   GtkRBNode *temp = NULL;
+  GtkRBNode *next = NULL;
   GtkTreePath *path = NULL;
+  gint estimated_height;
+  gint n_rows = 0;
+
+  /* New rows start out invalid with the estimated height */
+  estimated_height = gtk_tree_view_get_estimated_row_height (tree_view);
+
+  /* Building a fresh level is the common case (setting a model or
+   * expanding a row), so create all the nodes in one go instead of
+   * inserting and rebalancing them one by one.
+   */
+  if (_gtk_rbtree_is_nil (tree->root))
+    {
+      GtkTreeIter parent;
+      gint n_children;
+
+      if (depth > 1 &&
+          gtk_tree_model_iter_parent (tree_view->priv->model, &parent, iter))
+        n_children = gtk_tree_model_iter_n_children (tree_view->priv->model, &parent);
+      else
+        n_children = gtk_tree_model_iter_n_children (tree_view->priv->model, NULL);
+
+      if (tree_view->priv->fixed_height > 0)
+        next = _gtk_rbtree_build (tree, n_children, tree_view->priv->fixed_height, TRUE);
+      else
+        next = _gtk_rbtree_build (tree, n_children, estimated_height, FALSE);
+    }
 
   do
     {
       gtk_tree_model_ref_node (tree_view->priv->model, iter);
-      temp = _gtk_rbtree_insert_after (tree, temp, 0, FALSE);
+      n_rows++;
 
-      if (tree_view->priv->fixed_height > 0)
+      if (next)
         {
-          if (GTK_RBNODE_FLAG_SET (temp, GTK_RBNODE_INVALID))
-	    {
-              _gtk_rbtree_node_set_height (tree, temp, tree_view->priv->fixed_height);
-	      _gtk_rbtree_node_mark_valid (tree, temp);
-	    }
+          temp = next;
+          next = _gtk_rbtree_next (tree, next);
+        }
+      else
+        {
+          temp = _gtk_rbtree_insert_after (tree, temp, estimated_height, FALSE);
+
+          if (tree_view->priv->fixed_height > 0)
+            {
+              if (GTK_RBNODE_FLAG_SET (temp, GTK_RBNODE_INVALID))
+                {
+                  _gtk_rbtree_node_set_height (tree, temp, tree_view->priv->fixed_height);
+                  _gtk_rbtree_node_mark_valid (tree, temp);
+                }
+            }
         }
 
       if (tree_view->priv->is_list)
@@ -9389,6 +10354,13 @@ gtk_tree_view_build_tree (GtkTreeView *tree_view,
     }
   while (gtk_tree_model_iter_next (tree_view->priv->model, iter));
 
+  /* The model claimed to have more children than it let us iterate */
+  while (next)
+    {
+      _gtk_rbtree_remove_node (tree, _gtk_rbtree_find_count (tree, n_rows + 1));
+      next = _gtk_rbtree_find_count (tree, n_rows + 1);
+    }
+
   if (path)
     gtk_tree_path_free (path);
 }
@@ -11284,6 +12256,17 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
       g_signal_handlers_disconnect_by_func (tree_view->priv->model,
 					    gtk_tree_view_rows_reordered,
 					    tree_view);
+      g_signal_handlers_disconnect_by_func (tree_view->priv->model,
+					    gtk_tree_view_begin_bulk_update,
+					    tree_view);
+      g_signal_handlers_disconnect_by_func (tree_view->priv->model,
+					    gtk_tree_view_end_bulk_update,
+					    tree_view);
+
+      /* Don't lose work postponed by an unfinished bulk update */
+      if (tree_view->priv->in_bulk_update)
+        gtk_tree_view_end_bulk_update (GTK_LIST_STORE (tree_view->priv->model),
+                                       tree_view);
 
       for (; tmplist; tmplist = tmplist->next)
 	_gtk_tree_view_column_unset_model (tmplist->data,
@@ -11308,12 +12291,15 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
       tree_view->priv->search_column = -1;
       tree_view->priv->fixed_height_check = 0;
       tree_view->priv->fixed_height = -1;
+      tree_view->priv->measured_height_sum = 0;
+      tree_view->priv->n_measured_heights = 0;
       tree_view->priv->dy = tree_view->priv->top_row_dy = 0;
       tree_view->priv->last_button_x = -1;
       tree_view->priv->last_button_y = -1;
     }
 
   tree_view->priv->model = model;
+  tree_view->priv->is_loadable = model != NULL && GTK_IS_TREE_LOADABLE (model);
 
   if (tree_view->priv->model)
     {
@@ -11357,6 +12343,17 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
 			"rows-reordered",
 			G_CALLBACK (gtk_tree_view_rows_reordered),
 			tree_view);
+      if (GTK_IS_LIST_STORE (tree_view->priv->model))
+        {
+          g_signal_connect (tree_view->priv->model,
+                            "begin-bulk-update",
+                            G_CALLBACK (gtk_tree_view_begin_bulk_update),
+                            tree_view);
+          g_signal_connect (tree_view->priv->model,
+                            "end-bulk-update",
+                            G_CALLBACK (gtk_tree_view_end_bulk_update),
+                            tree_view);
+        }
 
       flags = gtk_tree_model_get_flags (tree_view->priv->model);
       if ((flags & GTK_TREE_MODEL_LIST_ONLY) == GTK_TREE_MODEL_LIST_ONLY)
@@ -11813,6 +12810,81 @@ gtk_tree_view_get_activate_on_single_click (GtkTreeView *tree_view)
   return tree_view->priv->activate_on_single_click;
 }
 
+/**
+ * gtk_tree_view_set_threaded_validation:
+ * @tree_view: a #GtkTreeView
+ * @setting: whether to measure offscreen rows in worker threads
+ *
+ * Sets whether @tree_view computes the sizes of the rows that are not
+ * on screen in worker threads. This keeps the main loop responsive and
+ * gets the scrollbars to their final size much sooner when large
+ * models are shown. Rows have an estimated height until their real
+ * size is known.
+ *
+ * Only rows of list models whose visible columns each show the text of
+ * a model column with a plain #GtkCellRendererText are measured that
+ * way: renderers that have cell data functions, attributes other than
+ * #GtkCellRendererText:text or properties like a wrap width or a scale
+ * set, as well as views with a custom font map or a row separator
+ * function, are validated in the main thread even if this is set.
+ *
+ * This has no effect if the Pango version in use is older than 1.32.6,
+ * gtk_tree_view_get_threaded_validation() keeps returning %FALSE then.
+ *
+ * Since: 3.10
+ **/
+void
+gtk_tree_view_set_threaded_validation (GtkTreeView *tree_view,
+                                       gboolean     setting)
+{
+  GtkTreeViewPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TREE_VIEW (tree_view));
+
+  priv = tree_view->priv;
+  setting = setting != FALSE;
+
+  /* Older versions of Pango aren't thread-safe */
+  if (pango_version () < PANGO_VERSION_ENCODE (1, 32, 6))
+    setting = FALSE;
+
+  if (setting == (priv->row_validator != NULL))
+    return;
+
+  if (setting)
+    priv->row_validator = row_validator_new (tree_view);
+  else
+    {
+      gtk_tree_view_stop_threaded_validation (tree_view);
+
+      if (priv->tree &&
+          GTK_RBNODE_FLAG_SET (priv->tree->root, GTK_RBNODE_DESCENDANTS_INVALID))
+        install_presize_handler (tree_view);
+    }
+
+  g_object_notify (G_OBJECT (tree_view), "threaded-validation");
+}
+
+/**
+ * gtk_tree_view_get_threaded_validation:
+ * @tree_view: a #GtkTreeView
+ *
+ * Returns whether the sizes of offscreen rows are computed in worker
+ * threads. This is %FALSE if the Pango version in use doesn't allow
+ * it. See gtk_tree_view_set_threaded_validation().
+ *
+ * Return value: %TRUE if rows are measured in worker threads
+ *
+ * Since: 3.10
+ **/
+gboolean
+gtk_tree_view_get_threaded_validation (GtkTreeView *tree_view)
+{
+  g_return_val_if_fail (GTK_IS_TREE_VIEW (tree_view), FALSE);
+
+  return tree_view->priv->row_validator != NULL;
+}
+
 /* Public Column functions
  */
 
@@ -252,6 +252,11 @@ gboolean               gtk_tree_view_get_activate_on_single_click  (GtkTreeView
 GDK_AVAILABLE_IN_3_8
 void                   gtk_tree_view_set_activate_on_single_click  (GtkTreeView               *tree_view,
 								    gboolean                   single);
+GDK_AVAILABLE_IN_3_10
+void                   gtk_tree_view_set_threaded_validation       (GtkTreeView               *tree_view,
+								    gboolean                   setting);
+GDK_AVAILABLE_IN_3_10
+gboolean               gtk_tree_view_get_threaded_validation       (GtkTreeView               *tree_view);
 
 /* Column funtions */
 GDK_AVAILABLE_IN_ALL
@@ -32,6 +32,7 @@
 #include "gtkarrow.h"
 #include "gtkcellareacontext.h"
 #include "gtkcellareabox.h"
+#include "gtkcellareaboxcontextprivate.h"
 #include "gtkprivate.h"
 #include "gtkintl.h"
 #include "gtktypebuiltins.h"
@@ -3208,3 +3209,62 @@ _gtk_tree_view_column_get_context (GtkTreeViewColumn  *column)
 {
   return column->priv->cell_area_context;
 }
+
+/* Returns the renderer of @column if it is a plain text renderer that
+ * is alone in a #GtkCellAreaBox, gets nothing but its text from the
+ * model, and can be measured from that text and its font alone.
+ * @model_column is set to the column the text comes from.
+ */
+GtkCellRenderer *
+_gtk_tree_view_column_get_text_cell (GtkTreeViewColumn  *column,
+                                     gint               *model_column)
+{
+  GtkTreeViewColumnPrivate *priv = column->priv;
+  GtkCellRenderer *cell;
+  GList *cells;
+  gint width, height;
+
+  if (G_OBJECT_TYPE (priv->cell_area) != GTK_TYPE_CELL_AREA_BOX)
+    return NULL;
+
+  cells = gtk_cell_layout_get_cells (GTK_CELL_LAYOUT (priv->cell_area));
+  cell = (cells && !cells->next) ? cells->data : NULL;
+  g_list_free (cells);
+
+  if (cell == NULL ||
+      G_OBJECT_TYPE (cell) != GTK_TYPE_CELL_RENDERER_TEXT ||
+      !gtk_cell_renderer_get_visible (cell))
+    return NULL;
+
+  gtk_cell_renderer_get_fixed_size (cell, &width, &height);
+  if (width != -1 || height != -1)
+    return NULL;
+
+  if (_gtk_cell_renderer_text_get_plain_font (GTK_CELL_RENDERER_TEXT (cell)) == NULL)
+    return NULL;
+
+  *model_column = _gtk_cell_area_get_text_column (priv->cell_area, cell);
+  if (*model_column < 0)
+    return NULL;
+
+  return cell;
+}
+
+/* Grows the width requested for the cell returned by
+ * _gtk_tree_view_column_get_text_cell(), for sizes that were
+ * measured without going through the cell area.
+ */
+void
+_gtk_tree_view_column_push_cell_width (GtkTreeViewColumn  *column,
+                                       gint                minimum_width,
+                                       gint                natural_width)
+{
+  GtkTreeViewColumnPrivate *priv = column->priv;
+
+  g_signal_handler_block (priv->cell_area_context,
+                          priv->context_changed_signal);
+  _gtk_cell_area_box_context_push_group_width (GTK_CELL_AREA_BOX_CONTEXT (priv->cell_area_context),
+                                               0, minimum_width, natural_width);
+  g_signal_handler_unblock (priv->cell_area_context,
+                            priv->context_changed_signal);
+}
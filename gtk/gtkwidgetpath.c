@@ -20,7 +20,7 @@
 #include <string.h>
 
 #include "gtkwidget.h"
-#include "gtkwidgetpath.h"
+#include "gtkwidgetpathprivate.h"
 #include "gtkstylecontextprivate.h"
 
 /**
@@ -1293,3 +1293,51 @@ gtk_widget_path_has_parent (const GtkWidgetPath *path,
 
   return FALSE;
 }
+
+/**
+ * _gtk_widget_path_iter_add_to_bloom_filter:
+ * @path: a #GtkWidgetPath
+ * @pos: position to add
+ * @filter: the filter to add to
+ *
+ * Adds everything a CSS selector can match on the widget at @pos
+ * to @filter: its type and all its parent types, its name, classes
+ * and regions.
+ **/
+void
+_gtk_widget_path_iter_add_to_bloom_filter (const GtkWidgetPath *path,
+                                           gint                 pos,
+                                           GtkCssBloomFilter   *filter)
+{
+  GtkPathElement *elem;
+  GType type;
+  guint i;
+
+  g_return_if_fail (path != NULL);
+  g_return_if_fail (pos >= 0 && pos < path->elems->len);
+  g_return_if_fail (filter != NULL);
+
+  elem = &g_array_index (path->elems, GtkPathElement, pos);
+
+  for (type = elem->type; type != 0; type = g_type_parent (type))
+    _gtk_css_bloom_filter_add (filter, GTK_CSS_BLOOM_TYPE, type);
+
+  if (elem->name)
+    _gtk_css_bloom_filter_add (filter, GTK_CSS_BLOOM_ID, elem->name);
+
+  if (elem->classes)
+    {
+      for (i = 0; i < elem->classes->len; i++)
+        _gtk_css_bloom_filter_add (filter, GTK_CSS_BLOOM_CLASS, g_array_index (elem->classes, GQuark, i));
+    }
+
+  if (elem->regions)
+    {
+      GHashTableIter iter;
+      gpointer key;
+
+      g_hash_table_iter_init (&iter, elem->regions);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        _gtk_css_bloom_filter_add (filter, GTK_CSS_BLOOM_REGION, GPOINTER_TO_UINT (key));
+    }
+}
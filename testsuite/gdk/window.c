@@ -0,0 +1,111 @@
+#include <gdk/gdk.h>
+
+static gint n_renders;
+
+static void
+render_green (GdkWindow *window,
+              cairo_t   *cr,
+              gpointer   user_data)
+{
+  double x1, y1, x2, y2;
+
+  /* Every call draws a single tile */
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+  g_assert_cmpfloat (x2 - x1, <=, 128);
+  g_assert_cmpfloat (y2 - y1, <=, 128);
+
+  cairo_set_source_rgb (cr, 0, 1, 0);
+  cairo_paint (cr);
+
+  g_atomic_int_inc (&n_renders);
+}
+
+static void
+render_data_free (gpointer data)
+{
+  gboolean *freed = data;
+
+  *freed = TRUE;
+}
+
+static guint32
+get_pixel (cairo_surface_t *surface,
+           int              x,
+           int              y)
+{
+  guchar *data = cairo_image_surface_get_data (surface);
+  int stride = cairo_image_surface_get_stride (surface);
+
+  return *(guint32 *) (data + y * stride + x * 4);
+}
+
+static void
+test_render_func (void)
+{
+  GdkWindowAttr attributes;
+  GdkRectangle rect = { 10, 10, 20, 20 };
+  GdkWindow *window;
+  cairo_surface_t *image;
+  cairo_t *cr;
+  gboolean freed = FALSE;
+
+  attributes.window_type = GDK_WINDOW_OFFSCREEN;
+  attributes.wclass = GDK_INPUT_OUTPUT;
+  attributes.x = 0;
+  attributes.y = 0;
+  attributes.width = 300;
+  attributes.height = 300;
+  attributes.event_mask = GDK_EXPOSURE_MASK;
+
+  window = gdk_window_new (NULL, &attributes, GDK_WA_X | GDK_WA_Y);
+  gdk_window_show (window);
+  gdk_window_process_updates (window, FALSE);
+
+  n_renders = 0;
+  gdk_window_set_render_func (window, render_green, &freed, render_data_free);
+  gdk_window_process_updates (window, FALSE);
+
+  /* 300x300 pixels are split into 3x3 tiles */
+  g_assert_cmpint (n_renders, ==, 9);
+
+  /* and all of them ended up on the window */
+  image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 300, 300);
+  cr = cairo_create (image);
+  cairo_set_source_surface (cr, gdk_offscreen_window_get_surface (window), 0, 0);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+  cairo_surface_flush (image);
+
+  g_assert_cmphex (get_pixel (image, 0, 0), ==, 0xff00ff00);
+  g_assert_cmphex (get_pixel (image, 127, 128), ==, 0xff00ff00);
+  g_assert_cmphex (get_pixel (image, 150, 150), ==, 0xff00ff00);
+  g_assert_cmphex (get_pixel (image, 299, 0), ==, 0xff00ff00);
+  g_assert_cmphex (get_pixel (image, 299, 299), ==, 0xff00ff00);
+  cairo_surface_destroy (image);
+
+  /* Only the invalidated tiles are drawn again */
+  n_renders = 0;
+  gdk_window_invalidate_rect (window, &rect, FALSE);
+  gdk_window_process_updates (window, FALSE);
+  g_assert_cmpint (n_renders, ==, 1);
+
+  /* Unsetting the function frees its data and stops calling it */
+  n_renders = 0;
+  gdk_window_set_render_func (window, NULL, NULL, NULL);
+  g_assert (freed);
+  gdk_window_process_updates (window, FALSE);
+  g_assert_cmpint (n_renders, ==, 0);
+
+  gdk_window_destroy (window);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  gdk_init (&argc, &argv);
+
+  g_test_add_func ("/window/render-func", test_render_func);
+
+  return g_test_run ();
+}
@@ -5551,6 +5551,175 @@ specific_list_store_clear (void)
   gtk_list_store_clear (list);
 }
 
+static gboolean
+specific_refilter_incremental_visible_func (GtkTreeModel *model,
+                                            GtkTreeIter  *iter,
+                                            gpointer      data)
+{
+  gint value;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value < *(gint *) data;
+}
+
+static void
+specific_refilter_incremental (void)
+{
+  GtkTreeStore *tree;
+  GtkTreeModel *filter;
+  GtkTreeIter iter, child;
+  GtkWidget *view G_GNUC_UNUSED;
+  gint threshold = 1000;
+  gint i;
+
+  tree = gtk_tree_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 100; i++)
+    {
+      gtk_tree_store_insert_with_values (tree, &iter, NULL, i, 0, i, -1);
+      gtk_tree_store_insert_with_values (tree, &child, &iter, 0, 0, i, -1);
+    }
+
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (tree), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          specific_refilter_incremental_visible_func,
+                                          &threshold, NULL);
+  view = gtk_tree_view_new_with_model (filter);
+  gtk_tree_view_expand_all (GTK_TREE_VIEW (view));
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 100);
+
+  /* Nothing happens until the main loop runs */
+  threshold = 50;
+  gtk_tree_model_filter_refilter_incremental (GTK_TREE_MODEL_FILTER (filter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 100);
+
+  /* Restart with different criteria before it finished */
+  threshold = 10;
+  gtk_tree_model_filter_refilter_incremental (GTK_TREE_MODEL_FILTER (filter));
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 10);
+  g_assert (gtk_tree_model_get_iter_first (filter, &iter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, &iter), ==, 1);
+
+  /* A synchronous refilter cancels a pending incremental one */
+  threshold = 20;
+  gtk_tree_model_filter_refilter_incremental (GTK_TREE_MODEL_FILTER (filter));
+  gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (filter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 20);
+
+  g_object_unref (filter);
+  g_object_unref (tree);
+}
+
+static gboolean
+specific_streaming_visible_func (GtkTreeModel *model,
+                                 GtkTreeIter  *iter,
+                                 gpointer      data)
+{
+  gint value;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value % 3 != 0;
+}
+
+static void
+specific_streaming_check (GtkTreeModel *filter,
+                          GtkListStore *store)
+{
+  GtkTreeIter iter;
+  gboolean valid;
+  gint n_visible = 0;
+  gint i = 0;
+
+  for (valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+       valid;
+       valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter), i++)
+    {
+      GtkTreePath *c_path, *path, *c_path2;
+      gint value;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      c_path = gtk_tree_path_new_from_indices (i, -1);
+      path = gtk_tree_model_filter_convert_child_path_to_path (GTK_TREE_MODEL_FILTER (filter),
+                                                               c_path);
+
+      if (value % 3 == 0)
+        g_assert (path == NULL);
+      else
+        {
+          g_assert (path != NULL);
+          g_assert_cmpint (gtk_tree_path_get_indices (path)[0], ==, n_visible);
+
+          c_path2 = gtk_tree_model_filter_convert_path_to_child_path (GTK_TREE_MODEL_FILTER (filter),
+                                                                      path);
+          g_assert (gtk_tree_path_compare (c_path, c_path2) == 0);
+
+          gtk_tree_path_free (c_path2);
+          gtk_tree_path_free (path);
+          n_visible++;
+        }
+
+      gtk_tree_path_free (c_path);
+    }
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, n_visible);
+}
+
+static void
+specific_streaming_offsets (void)
+{
+  GtkListStore *store;
+  GtkTreeModel *filter;
+  GtkTreeIter iter;
+  GtkWidget *view G_GNUC_UNUSED;
+  gint i, next = 0;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 30; i++)
+    gtk_list_store_insert_with_values (store, &iter, -1, 0, next++, -1);
+
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          specific_streaming_visible_func,
+                                          NULL, NULL);
+  view = gtk_tree_view_new_with_model (filter);
+
+  /* Append at the tail while trimming the head, with the occasional
+   * change in the middle, so that the pending offset shift of the level
+   * has to move back and forth.
+   */
+  for (i = 0; i < 120; i++)
+    {
+      gtk_list_store_insert_with_values (store, &iter, -1, 0, next++, -1);
+
+      if (i % 2 == 0)
+        {
+          gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+          gtk_list_store_remove (store, &iter);
+        }
+
+      if (i % 7 == 0)
+        gtk_list_store_insert_with_values (store, &iter, 10, 0, next++, -1);
+
+      if (i % 11 == 0)
+        {
+          gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter,
+                                         NULL, 15);
+          gtk_list_store_remove (store, &iter);
+        }
+
+      specific_streaming_check (filter, store);
+    }
+
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
 static void
 specific_sort_ref_leaf_and_remove_ancestor (void)
 {
@@ -7107,6 +7276,10 @@ register_filter_model_tests (void)
                    specific_filter_add_child);
   g_test_add_func ("/TreeModelFilter/specific/list-store-clear",
                    specific_list_store_clear);
+  g_test_add_func ("/TreeModelFilter/specific/refilter-incremental",
+                   specific_refilter_incremental);
+  g_test_add_func ("/TreeModelFilter/specific/streaming-offsets",
+                   specific_streaming_offsets);
   g_test_add_func ("/TreeModelFilter/specific/sort-ref-leaf-and-remove-ancestor",
                    specific_sort_ref_leaf_and_remove_ancestor);
   g_test_add_func ("/TreeModelFilter/specific/ref-leaf-and-remove-ancestor",
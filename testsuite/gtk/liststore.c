@@ -455,6 +455,388 @@ list_store_test_insert_before_NULL (void)
   g_object_unref (store);
 }
 
+static void
+remove_last_row (GtkTreeModel *model,
+                 GtkTreePath  *path,
+                 GtkTreeIter  *iter,
+                 gpointer      data)
+{
+  GtkTreeIter last;
+  gint n;
+
+  g_signal_handlers_disconnect_by_func (model, remove_last_row, data);
+
+  n = gtk_tree_model_iter_n_children (model, NULL);
+  g_assert (gtk_tree_model_iter_nth_child (model, &last, NULL, n - 1));
+  gtk_list_store_remove (GTK_LIST_STORE (model), &last);
+}
+
+static void
+list_store_test_insert_rows (void)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  GValue values[4] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+  gint columns[] = { 0 };
+  gint i, value;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 100, -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 101, -1);
+
+  for (i = 0; i < 4; i++)
+    {
+      g_value_init (&values[i], G_TYPE_INT);
+      g_value_set_int (&values[i], i);
+    }
+
+  gtk_list_store_insert_rows (store, 1, 4, columns, values, 1);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 6);
+
+  g_assert (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter));
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+  g_assert_cmpint (value, ==, 100);
+
+  for (i = 0; i < 4; i++)
+    {
+      g_assert (gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter));
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, i);
+    }
+
+  g_assert (gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter));
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+  g_assert_cmpint (value, ==, 101);
+
+  /* remove the middle rows again */
+  gtk_list_store_remove_rows (store, 1, 4);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 2);
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 1));
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+  g_assert_cmpint (value, ==, 101);
+
+  /* -1 removes everything to the end */
+  gtk_list_store_remove_rows (store, 1, -1);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 1);
+
+  /* A row-inserted handler removes the row the new rows were inserted
+   * in front of; the remaining rows are appended */
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 101, -1);
+  g_signal_connect (store, "row-inserted", G_CALLBACK (remove_last_row), NULL);
+  gtk_list_store_insert_rows (store, 1, 4, columns, values, 1);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 5);
+
+  for (i = 0; i < 4; i++)
+    {
+      g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, i + 1));
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, i);
+    }
+
+  for (i = 0; i < 4; i++)
+    g_value_unset (&values[i]);
+
+  g_object_unref (store);
+}
+
+static void
+append_row (GtkTreeModel *model,
+            GtkTreePath  *path,
+            gpointer      data)
+{
+  gtk_list_store_insert_with_values (GTK_LIST_STORE (model), NULL, -1, 0, 200, -1);
+}
+
+static void
+list_store_test_remove_rows_handler_inserts (void)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  gint i, value;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 5; i++)
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, i, -1);
+
+  /* Every removal appends a row; only the original rows go away */
+  g_signal_connect (store, "row-deleted", G_CALLBACK (append_row), NULL);
+  gtk_list_store_remove_rows (store, 0, -1);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 5);
+
+  g_assert (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter));
+  do
+    {
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, 200);
+    }
+  while (gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter));
+
+  g_object_unref (store);
+}
+
+typedef struct {
+  gint n_changed;
+  gint n_inserted;
+  gint n_deleted;
+  gint n_begin;
+  gint n_end;
+} SignalCounts;
+
+static void
+count_changed (GtkTreeModel *model,
+               GtkTreePath  *path,
+               GtkTreeIter  *iter,
+               SignalCounts *counts)
+{
+  g_assert_cmpint (counts->n_begin, ==, counts->n_end + 1);
+  counts->n_changed++;
+}
+
+static void
+count_inserted (GtkTreeModel *model,
+                GtkTreePath  *path,
+                GtkTreeIter  *iter,
+                SignalCounts *counts)
+{
+  g_assert_cmpint (counts->n_begin, ==, counts->n_end + 1);
+  counts->n_inserted++;
+}
+
+static void
+count_deleted (GtkTreeModel *model,
+               GtkTreePath  *path,
+               SignalCounts *counts)
+{
+  g_assert_cmpint (counts->n_begin, ==, counts->n_end + 1);
+  counts->n_deleted++;
+}
+
+static void
+count_begin (GtkListStore *store,
+             SignalCounts *counts)
+{
+  counts->n_begin++;
+}
+
+static void
+count_end (GtkListStore *store,
+           SignalCounts *counts)
+{
+  counts->n_end++;
+}
+
+static void
+check_values (GtkListStore *store,
+              const gint   *expected,
+              gint          n_expected)
+{
+  GtkTreeIter iter;
+  gint i, value;
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, n_expected);
+
+  for (i = 0; i < n_expected; i++)
+    {
+      g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, i));
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, expected[i]);
+    }
+}
+
+static void
+list_store_test_replace_rows (void)
+{
+  GtkListStore *store;
+  GValue values[3] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+  gint columns[] = { 0 };
+  const SignalCounts no_counts = { 0, };
+  SignalCounts counts = no_counts;
+  gint grown[] = { 0, 10, 11, 12, 3, 4 };
+  gint shrunk[] = { 0, 20, 4 };
+  gint emptied[] = { 0 };
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 5; i++)
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, i, -1);
+
+  for (i = 0; i < 3; i++)
+    {
+      g_value_init (&values[i], G_TYPE_INT);
+      g_value_set_int (&values[i], 10 + i);
+    }
+
+  g_signal_connect (store, "row-changed", G_CALLBACK (count_changed), &counts);
+  g_signal_connect (store, "row-inserted", G_CALLBACK (count_inserted), &counts);
+  g_signal_connect (store, "row-deleted", G_CALLBACK (count_deleted), &counts);
+  g_signal_connect (store, "begin-bulk-update", G_CALLBACK (count_begin), &counts);
+  g_signal_connect (store, "end-bulk-update", G_CALLBACK (count_end), &counts);
+
+  /* Two rows are replaced in place, the third one is inserted */
+  gtk_list_store_replace_rows (store, 1, 2, 3, columns, values, 1);
+  check_values (store, grown, G_N_ELEMENTS (grown));
+  g_assert_cmpint (counts.n_changed, ==, 2);
+  g_assert_cmpint (counts.n_inserted, ==, 1);
+  g_assert_cmpint (counts.n_deleted, ==, 0);
+  g_assert_cmpint (counts.n_begin, ==, 1);
+  g_assert_cmpint (counts.n_end, ==, 1);
+
+  /* One row is replaced in place, the other two are removed */
+  counts = no_counts;
+  g_value_set_int (&values[0], 20);
+  gtk_list_store_replace_rows (store, 1, 4, 1, columns, values, 1);
+  check_values (store, shrunk, G_N_ELEMENTS (shrunk));
+  g_assert_cmpint (counts.n_changed, ==, 1);
+  g_assert_cmpint (counts.n_inserted, ==, 0);
+  g_assert_cmpint (counts.n_deleted, ==, 3);
+  g_assert_cmpint (counts.n_begin, ==, 1);
+  g_assert_cmpint (counts.n_end, ==, 1);
+
+  /* -1 replaces everything to the end */
+  counts = no_counts;
+  gtk_list_store_replace_rows (store, 1, -1, 0, NULL, NULL, 0);
+  check_values (store, emptied, G_N_ELEMENTS (emptied));
+  g_assert_cmpint (counts.n_deleted, ==, 2);
+  g_assert_cmpint (counts.n_begin, ==, 1);
+  g_assert_cmpint (counts.n_end, ==, 1);
+
+  for (i = 0; i < 3; i++)
+    g_value_unset (&values[i]);
+
+  g_object_unref (store);
+}
+
+/* row storage */
+static void
+list_store_test_row_cells (void)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  GObject *object, *value_object;
+  gint value_int;
+  gchar *value_string;
+  gdouble value_double;
+
+  store = gtk_list_store_new (4, G_TYPE_INT, G_TYPE_STRING, G_TYPE_OBJECT, G_TYPE_DOUBLE);
+
+  /* A row without values reads back the defaults */
+  gtk_list_store_append (store, &iter);
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                      0, &value_int, 1, &value_string,
+                      2, &value_object, 3, &value_double,
+                      -1);
+  g_assert_cmpint (value_int, ==, 0);
+  g_assert (value_string == NULL);
+  g_assert (value_object == NULL);
+  g_assert_cmpfloat (value_double, ==, 0.0);
+
+  /* Setting one column leaves the others alone */
+  object = g_object_new (G_TYPE_OBJECT, NULL);
+  g_object_add_weak_pointer (object, (gpointer *) &object);
+  gtk_list_store_set (store, &iter, 2, object, -1);
+  g_object_unref (object);
+  g_assert (object != NULL);
+
+  gtk_list_store_set (store, &iter, 1, "one", 3, 1.5, -1);
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                      0, &value_int, 1, &value_string,
+                      2, &value_object, 3, &value_double,
+                      -1);
+  g_assert_cmpint (value_int, ==, 0);
+  g_assert_cmpstr (value_string, ==, "one");
+  g_assert (value_object == object);
+  g_assert_cmpfloat (value_double, ==, 1.5);
+  g_free (value_string);
+  g_object_unref (value_object);
+
+  /* Removing the row frees its cells */
+  gtk_list_store_remove (store, &iter);
+  g_assert (object == NULL);
+
+  /* So does finalizing the store */
+  object = g_object_new (G_TYPE_OBJECT, NULL);
+  g_object_add_weak_pointer (object, (gpointer *) &object);
+  gtk_list_store_insert_with_values (store, NULL, -1, 1, "two", 2, object, -1);
+  g_object_unref (object);
+  g_assert (object != NULL);
+
+  g_object_unref (store);
+  g_assert (object == NULL);
+}
+
+static void
+get_row_drag_data (GtkClipboard     *clipboard,
+                   GtkSelectionData *selection_data,
+                   guint             info,
+                   gpointer          data)
+{
+  GtkTreePath *path;
+
+  path = gtk_tree_path_new_from_indices (0, -1);
+  g_assert (gtk_tree_set_row_drag_data (selection_data, GTK_TREE_MODEL (data), path));
+  gtk_tree_path_free (path);
+}
+
+static void
+list_store_test_row_copy (void)
+{
+  static const GtkTargetEntry targets[] = {
+    { (gchar *) "GTK_TREE_MODEL_ROW", GTK_TARGET_SAME_APP, 0 }
+  };
+  GtkListStore *store;
+  GtkClipboard *clipboard;
+  GtkSelectionData *selection_data;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  GObject *object, *value_object;
+  gint value_int;
+  gchar *value_string;
+
+  store = gtk_list_store_new (3, G_TYPE_INT, G_TYPE_STRING, G_TYPE_OBJECT);
+
+  object = g_object_new (G_TYPE_OBJECT, NULL);
+  g_object_add_weak_pointer (object, (gpointer *) &object);
+  gtk_list_store_insert_with_values (store, &iter, -1, 0, 7, 1, "seven", 2, object, -1);
+  g_object_unref (object);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 8, -1);
+
+  /* Dropping row 0 at the end copies it */
+  clipboard = gtk_clipboard_get (gdk_atom_intern_static_string ("GTK_TEST_LIST_STORE_ROW"));
+  g_assert (gtk_clipboard_set_with_data (clipboard, targets, G_N_ELEMENTS (targets),
+                                         get_row_drag_data, NULL, store));
+  selection_data = gtk_clipboard_wait_for_contents (clipboard,
+                                                    gdk_atom_intern_static_string ("GTK_TREE_MODEL_ROW"));
+  g_assert (selection_data != NULL);
+
+  path = gtk_tree_path_new_from_indices (2, -1);
+  g_assert (gtk_tree_drag_dest_drag_data_received (GTK_TREE_DRAG_DEST (store), path, selection_data));
+  gtk_tree_path_free (path);
+  gtk_selection_data_free (selection_data);
+  gtk_clipboard_clear (clipboard);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 3);
+
+  /* The copy doesn't share the string with the original */
+  gtk_list_store_set (store, &iter, 1, "changed", -1);
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 2));
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                      0, &value_int, 1, &value_string, 2, &value_object,
+                      -1);
+  g_assert_cmpint (value_int, ==, 7);
+  g_assert_cmpstr (value_string, ==, "seven");
+  g_assert (value_object == object);
+  g_free (value_string);
+  g_object_unref (value_object);
+
+  /* The object stays alive as long as one of the rows refers to it */
+  gtk_list_store_remove_rows (store, 0, 1);
+  g_assert (object != NULL);
+
+  g_object_unref (store);
+  g_assert (object == NULL);
+}
+
 /* setting values */
 static void
 list_store_set_gvalue_to_transform (void)
@@ -1033,6 +1415,16 @@ register_list_store_tests (void)
 		   list_store_test_insert_before);
   g_test_add_func ("/ListStore/insert-before-NULL",
 		   list_store_test_insert_before_NULL);
+  g_test_add_func ("/ListStore/insert-rows",
+		   list_store_test_insert_rows);
+  g_test_add_func ("/ListStore/remove-rows-handler-inserts",
+                   list_store_test_remove_rows_handler_inserts);
+  g_test_add_func ("/ListStore/replace-rows",
+                   list_store_test_replace_rows);
+  g_test_add_func ("/ListStore/row-cells",
+                   list_store_test_row_cells);
+  g_test_add_func ("/ListStore/row-copy",
+                   list_store_test_row_copy);
 
   /* setting values (FIXME) */
   g_test_add_func ("/ListStore/set-gvalue-to-transform",
@@ -0,0 +1,155 @@
+/* GtkPixelCache tests.
+ *
+ * Copyright (C) 2013, Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#include "../../gtk/gtkpixelcacheprivate.h"
+
+static void
+count_draws (cairo_t  *cr,
+             gpointer  user_data)
+{
+  guint *n_draws = user_data;
+
+  (*n_draws)++;
+
+  cairo_set_source_rgb (cr, 1, 0, 0);
+  cairo_paint (cr);
+}
+
+static GdkWindow *
+create_window (GtkWidget **toplevel)
+{
+  *toplevel = gtk_offscreen_window_new ();
+  gtk_widget_show (*toplevel);
+
+  return gtk_widget_get_window (*toplevel);
+}
+
+/* Draws a 100x100 view of a 1000x1000 canvas scrolled to @y */
+static void
+draw_view (GtkPixelCache   *cache,
+           cairo_surface_t *target,
+           GdkWindow       *window,
+           int              y,
+           guint           *n_draws)
+{
+  cairo_rectangle_int_t view_rect = { 0, 0, 100, 100 };
+  cairo_rectangle_int_t canvas_rect = { 0, 0, 1000, 1000 };
+  cairo_t *cr;
+
+  canvas_rect.y = -y;
+
+  cr = cairo_create (target);
+  _gtk_pixel_cache_draw (cache, cr, window, &view_rect, &canvas_rect,
+                         count_draws, n_draws);
+  cairo_destroy (cr);
+}
+
+static void
+test_reuse_tiles (void)
+{
+  GtkWidget *toplevel;
+  GdkWindow *window;
+  GtkPixelCache *cache;
+  cairo_surface_t *target;
+  cairo_rectangle_int_t r = { 0, 0, 10, 10 };
+  cairo_region_t *region;
+  guint n_draws = 0;
+
+  window = create_window (&toplevel);
+  target = gdk_window_create_similar_surface (window, CAIRO_CONTENT_COLOR_ALPHA, 100, 100);
+  cache = _gtk_pixel_cache_new ();
+
+  /* The view and the area around it fit into the first tile */
+  draw_view (cache, target, window, 0, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 1);
+
+  /* Scrolling inside a tile doesn't repaint it */
+  draw_view (cache, target, window, 10, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 1);
+
+  /* Scrolling into the next tile only paints that one */
+  draw_view (cache, target, window, 300, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 2);
+
+  draw_view (cache, target, window, 0, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 2);
+
+  /* Invalidating part of a tile repaints it the next time it is needed */
+  region = cairo_region_create_rectangle (&r);
+  _gtk_pixel_cache_invalidate (cache, region);
+  cairo_region_destroy (region);
+
+  draw_view (cache, target, window, 0, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 3);
+
+  /* Invalidating everything repaints all the tiles in use */
+  _gtk_pixel_cache_invalidate (cache, NULL);
+
+  draw_view (cache, target, window, 300, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 5);
+
+  _gtk_pixel_cache_free (cache);
+  cairo_surface_destroy (target);
+  gtk_widget_destroy (toplevel);
+}
+
+static void
+test_draw_elsewhere (void)
+{
+  GtkWidget *toplevel;
+  GdkWindow *window;
+  GtkPixelCache *cache;
+  cairo_surface_t *target, *recording;
+  guint n_draws = 0;
+
+  window = create_window (&toplevel);
+  target = gdk_window_create_similar_surface (window, CAIRO_CONTENT_COLOR_ALPHA, 100, 100);
+  recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+  cache = _gtk_pixel_cache_new ();
+
+  /* Drawing to a surface the tiles can't be used with draws directly,
+   * without painting the tiles first
+   */
+  draw_view (cache, recording, window, 0, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 1);
+
+  /* so the tiles still need to be painted when they are used */
+  draw_view (cache, target, window, 0, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 2);
+
+  draw_view (cache, target, window, 0, &n_draws);
+  g_assert_cmpuint (n_draws, ==, 2);
+
+  _gtk_pixel_cache_free (cache);
+  cairo_surface_destroy (recording);
+  cairo_surface_destroy (target);
+  gtk_widget_destroy (toplevel);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/pixelcache/reuse-tiles", test_reuse_tiles);
+  g_test_add_func ("/pixelcache/draw-elsewhere", test_draw_elsewhere);
+
+  return g_test_run ();
+}
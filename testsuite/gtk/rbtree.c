@@ -377,6 +377,61 @@ test_insert_before (void)
   _gtk_rbtree_free (tree);
 }
 
+static void
+test_build (void)
+{
+  guint i, n;
+  GtkRBTree *tree;
+  GtkRBNode *node, *child;
+
+  for (i = 0; i <= 100; i++)
+    {
+      tree = _gtk_rbtree_new ();
+
+      node = _gtk_rbtree_build (tree, i, 10, i % 2);
+      _gtk_rbtree_test (tree);
+
+      if (i == 0)
+        {
+          g_assert (node == NULL);
+          g_assert (_gtk_rbtree_is_nil (tree->root));
+          _gtk_rbtree_free (tree);
+          continue;
+        }
+
+      g_assert (node == _gtk_rbtree_first (tree));
+      g_assert (tree->root->count == i);
+      g_assert (tree->root->total_count == i);
+      g_assert (tree->root->offset == i * 10);
+      g_assert (GTK_RBNODE_FLAG_SET (tree->root, GTK_RBNODE_DESCENDANTS_INVALID) == !(i % 2));
+
+      for (n = 0; node; node = _gtk_rbtree_next (tree, node))
+        n++;
+      g_assert (n == i);
+
+      /* build a child tree and check the parents get updated */
+      node = _gtk_rbtree_find_count (tree, i / 2 + 1);
+      node->children = _gtk_rbtree_new ();
+      node->children->parent_tree = tree;
+      node->children->parent_node = node;
+      child = _gtk_rbtree_build (node->children, i, 1, FALSE);
+      g_assert (child != NULL);
+      _gtk_rbtree_test (tree);
+      g_assert (tree->root->count == i);
+      g_assert (tree->root->total_count == 2 * i);
+      g_assert (tree->root->offset == i * 11);
+      g_assert (GTK_RBNODE_FLAG_SET (tree->root, GTK_RBNODE_DESCENDANTS_INVALID));
+
+      /* the result must still be a working tree */
+      _gtk_rbtree_insert_after (tree, node, 1, TRUE);
+      _gtk_rbtree_test (tree);
+      _gtk_rbtree_remove_node (tree, _gtk_rbtree_first (tree));
+      _gtk_rbtree_test (tree);
+
+      _gtk_rbtree_free (tree);
+    }
+}
+
 static void
 test_remove_node (void)
 {
@@ -517,6 +572,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/rbtree/create", test_create);
   g_test_add_func ("/rbtree/insert_after", test_insert_after);
   g_test_add_func ("/rbtree/insert_before", test_insert_before);
+  g_test_add_func ("/rbtree/build", test_build);
   g_test_add_func ("/rbtree/remove_node", test_remove_node);
   g_test_add_func ("/rbtree/remove_root", test_remove_root);
   g_test_add_func ("/rbtree/reorder", test_reorder);
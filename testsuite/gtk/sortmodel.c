@@ -1029,6 +1029,155 @@ sorted_insert (void)
   g_object_unref (ref_model);
 }
 
+static void
+check_string_sort_order (GtkTreeModel *sort_model,
+                         GtkSortType   sort_order)
+{
+  gchar *prev_value = NULL;
+  GtkTreeIter siter;
+
+  g_assert (gtk_tree_model_get_iter_first (sort_model, &siter));
+
+  do
+    {
+      gchar *value;
+
+      /* The sort model sorts NULL like the empty string */
+      gtk_tree_model_get (sort_model, &siter, 0, &value, -1);
+      if (value == NULL)
+        value = g_strdup ("");
+
+      if (prev_value)
+        {
+          if (sort_order == GTK_SORT_ASCENDING)
+            g_assert_cmpint (g_utf8_collate (prev_value, value), <=, 0);
+          else
+            g_assert_cmpint (g_utf8_collate (prev_value, value), >=, 0);
+        }
+
+      g_free (prev_value);
+      prev_value = value;
+    }
+  while (gtk_tree_model_iter_next (sort_model, &siter));
+
+  g_free (prev_value);
+}
+
+static void
+sort_string_column (void)
+{
+  const gchar *strings[] = { "pear", "Apple", NULL, "apple", "\303\251clair",
+                             "banana", "", "Banana", "zebra", "pear" };
+  GtkListStore *store;
+  GtkTreeModel *sort_model;
+  GtkTreeIter iter;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < G_N_ELEMENTS (strings); i++)
+    gtk_list_store_insert_with_values (store, &iter, -1, 0, strings[i], -1);
+
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+  check_string_sort_order (sort_model, GTK_SORT_ASCENDING);
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_DESCENDING);
+  check_string_sort_order (sort_model, GTK_SORT_DESCENDING);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (sort_model, NULL),
+                   ==, G_N_ELEMENTS (strings));
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
+static void
+cache_limit (void)
+{
+  GtkTreeStore *store;
+  GtkTreeModel *sort_model;
+  GtkTreeModelSort *sort;
+  GtkTreeIter iter, child, first_child;
+  gsize root_size, level_size, limit;
+  int i, j;
+
+  store = gtk_tree_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 20; i++)
+    {
+      gtk_tree_store_insert_with_values (store, &iter, NULL, i, 0, i, -1);
+      for (j = 0; j < 50; j++)
+        gtk_tree_store_insert_with_values (store, &child, &iter, j,
+                                           0, 50 - j, -1);
+    }
+
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+  sort = GTK_TREE_MODEL_SORT (sort_model);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+  g_assert_cmpuint (gtk_tree_model_sort_get_cache_limit (sort), ==, 0);
+
+  g_assert (gtk_tree_model_get_iter_first (sort_model, &iter));
+  root_size = gtk_tree_model_sort_get_cache_size (sort);
+  g_assert_cmpuint (root_size, >, 0);
+
+  g_assert (gtk_tree_model_iter_children (sort_model, &child, &iter));
+  level_size = gtk_tree_model_sort_get_cache_size (sort) - root_size;
+  g_assert_cmpuint (level_size, >, 0);
+
+  /* Without a limit, every visited level stays cached */
+  while (gtk_tree_model_iter_next (sort_model, &iter))
+    g_assert (gtk_tree_model_iter_children (sort_model, &child, &iter));
+  g_assert_cmpuint (gtk_tree_model_sort_get_cache_size (sort),
+                    ==, root_size + 20 * level_size);
+
+  limit = root_size + 3 * level_size;
+  gtk_tree_model_sort_set_cache_limit (sort, limit);
+  g_assert_cmpuint (gtk_tree_model_sort_get_cache_limit (sort), ==, limit);
+  g_assert_cmpuint (gtk_tree_model_sort_get_cache_size (sort), <=, limit);
+
+  /* Reading the model never frees levels, so iters into unreferenced
+   * levels stay valid until the main loop runs
+   */
+  g_assert (gtk_tree_model_get_iter_first (sort_model, &iter));
+  g_assert (gtk_tree_model_iter_children (sort_model, &first_child, &iter));
+  do
+    {
+      g_assert (gtk_tree_model_iter_children (sort_model, &child, &iter));
+      check_sort_order (sort_model, GTK_SORT_ASCENDING, NULL);
+    }
+  while (gtk_tree_model_iter_next (sort_model, &iter));
+
+  g_assert_cmpuint (gtk_tree_model_sort_get_cache_size (sort),
+                    ==, root_size + 20 * level_size);
+  g_assert (gtk_tree_model_sort_iter_is_valid (sort, &first_child));
+  gtk_tree_model_get (sort_model, &first_child, 0, &j, -1);
+  g_assert_cmpint (j, ==, 1);
+
+  /* Once it does, the least recently visited levels are freed */
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+  g_assert_cmpuint (gtk_tree_model_sort_get_cache_size (sort), <=, limit);
+
+  /* Referenced levels are never evicted */
+  g_assert (gtk_tree_model_get_iter_first (sort_model, &iter));
+  g_assert (gtk_tree_model_iter_children (sort_model, &child, &iter));
+  gtk_tree_model_ref_node (sort_model, &child);
+
+  gtk_tree_model_sort_set_cache_limit (sort, 1);
+  g_assert_cmpuint (gtk_tree_model_sort_get_cache_size (sort),
+                    ==, root_size + level_size);
+  g_assert (gtk_tree_model_sort_iter_is_valid (sort, &child));
+  check_sort_order (sort_model, GTK_SORT_ASCENDING, "0");
+
+  gtk_tree_model_unref_node (sort_model, &child);
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
 
 static void
 specific_bug_300089 (void)
@@ -1230,6 +1379,10 @@ register_sort_model_tests (void)
                    rows_reordered_two_levels);
   g_test_add_func ("/TreeModelSort/sorted-insert",
                    sorted_insert);
+  g_test_add_func ("/TreeModelSort/sort-string-column",
+                   sort_string_column);
+  g_test_add_func ("/TreeModelSort/cache-limit",
+                   cache_limit);
 
   g_test_add_func ("/TreeModelSort/specific/bug-300089",
                    specific_bug_300089);
@@ -256,6 +256,92 @@ test_match (void)
   g_object_unref (context);
 }
 
+static void
+test_match_descendant (void)
+{
+  GtkStyleContext *context;
+  GtkWidgetPath *path;
+  GtkCssProvider *provider;
+  GError *error;
+  GdkRGBA color;
+  GdkRGBA expected;
+
+  error = NULL;
+  provider = gtk_css_provider_new ();
+
+  context = gtk_style_context_new ();
+
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_WINDOW);
+  gtk_widget_path_append_type (path, GTK_TYPE_BOX);
+  gtk_widget_path_append_type (path, GTK_TYPE_BUTTON);
+  gtk_widget_path_iter_set_name (path, 0, "mywindow");
+  gtk_widget_path_iter_add_class (path, 1, "toolbar");
+  gtk_widget_path_iter_add_region (path, 1, "row", 0);
+  gtk_style_context_set_path (context, path);
+  gtk_widget_path_free (path);
+
+  gtk_style_context_add_provider (context,
+                                  GTK_STYLE_PROVIDER (provider),
+                                  GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  gdk_rgba_parse (&expected, "#fff");
+
+  gtk_css_provider_load_from_data (provider,
+                                   "* { color: #f00 }\n"
+                                   ".menubar GtkButton { color: #000 }\n"
+                                   ".toolbar GtkButton { color: #fff }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context);
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  gtk_css_provider_load_from_data (provider,
+                                   "* { color: #f00 }\n"
+                                   "#otherwindow GtkButton { color: #000 }\n"
+                                   "#mywindow .toolbar GtkButton { color: #fff }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context);
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  gtk_css_provider_load_from_data (provider,
+                                   "* { color: #f00 }\n"
+                                   "column GtkButton { color: #000 }\n"
+                                   "row GtkButton { color: #fff }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context);
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  gtk_css_provider_load_from_data (provider,
+                                   "* { color: #f00 }\n"
+                                   "GtkLabel GtkButton { color: #000 }\n"
+                                   "GtkContainer GtkButton { color: #fff }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context);
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  gtk_css_provider_load_from_data (provider,
+                                   "* { color: #fff }\n"
+                                   ".menubar GtkButton { color: #000 }\n"
+                                   "GtkButton GtkButton { color: #000 }\n"
+                                   "#mywindow #mywindow GtkButton { color: #000 }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context);
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  g_object_unref (provider);
+  g_object_unref (context);
+}
+
 static void
 test_style_property (void)
 {
@@ -343,6 +429,325 @@ test_basic_properties (void)
   g_object_unref (context);
 }
 
+static void
+test_shared_values (void)
+{
+  GtkStyleContext *context1, *context2;
+  GtkWidgetPath *path;
+  GtkCssProvider *provider;
+  GError *error;
+  GdkRGBA color;
+  GdkRGBA expected;
+  cairo_pattern_t *pattern1, *pattern2;
+
+  error = NULL;
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider,
+                                   "GtkButton { color: #f00;\n"
+                                   "            background-image: -gtk-gradient (linear, left top, right top,\n"
+                                   "                                             from (#f00), to (#00f)); }\n"
+                                   "GtkButton.special { color: #00f }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_WINDOW);
+  gtk_widget_path_append_type (path, GTK_TYPE_BUTTON);
+
+  context1 = gtk_style_context_new ();
+  gtk_style_context_set_path (context1, path);
+  context2 = gtk_style_context_new ();
+  gtk_style_context_set_path (context2, path);
+  gtk_widget_path_free (path);
+
+  gdk_rgba_parse (&expected, "#f00");
+  gtk_style_context_get_color (context1, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+  gtk_style_context_get_color (context2, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  /* Gradients are resolved when the values are computed, so getting
+   * the same pattern means the contexts share their values */
+  gtk_style_context_get (context1, GTK_STATE_FLAG_NORMAL,
+                         "background-image", &pattern1, NULL);
+  gtk_style_context_get (context2, GTK_STATE_FLAG_NORMAL,
+                         "background-image", &pattern2, NULL);
+  g_assert (pattern1 != NULL);
+  g_assert (pattern1 == pattern2);
+  cairo_pattern_destroy (pattern2);
+
+  /* Changing one context must not affect the other */
+  gtk_style_context_add_class (context2, "special");
+  gtk_style_context_invalidate (context2);
+
+  gtk_style_context_get (context2, GTK_STATE_FLAG_NORMAL,
+                         "background-image", &pattern2, NULL);
+  g_assert (pattern1 != pattern2);
+  cairo_pattern_destroy (pattern1);
+  cairo_pattern_destroy (pattern2);
+
+  gtk_style_context_get_color (context1, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+  gdk_rgba_parse (&expected, "#00f");
+  gtk_style_context_get_color (context2, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  /* Reloading the provider must not return stale values */
+  gtk_css_provider_load_from_data (provider, "GtkButton { color: #0f0 }", -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context1);
+  gtk_style_context_invalidate (context2);
+
+  gdk_rgba_parse (&expected, "#0f0");
+  gtk_style_context_get_color (context1, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+  gtk_style_context_get_color (context2, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
+                                                GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+  g_object_unref (context1);
+  g_object_unref (context2);
+}
+
+static void
+test_shared_values_reload (void)
+{
+  GtkStyleContext *context;
+  GtkCssProvider *provider;
+  GError *error;
+  GdkRGBA color;
+  GdkRGBA expected;
+
+  error = NULL;
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider, ".reload-test { color: #f00 }", -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  /* Contexts without a path revalidate as soon as the provider changes,
+   * that must not happen from the table of the old provider */
+  context = gtk_style_context_new ();
+  gtk_style_context_add_class (context, "reload-test");
+
+  gdk_rgba_parse (&expected, "#f00");
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  gtk_css_provider_load_from_data (provider, ".reload-test { color: #0f0 }", -1, &error);
+  g_assert_no_error (error);
+
+  gdk_rgba_parse (&expected, "#0f0");
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
+                                                GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+  g_object_unref (context);
+}
+
+static cairo_surface_t *
+render_background (GtkStyleContext *context,
+                   int              width,
+                   int              height)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+  gtk_render_background (context, cr, 0, 0, width, height);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  return surface;
+}
+
+static guint32
+get_pixel (cairo_surface_t *surface,
+           int              x,
+           int              y)
+{
+  guchar *data = cairo_image_surface_get_data (surface);
+  int stride = cairo_image_surface_get_stride (surface);
+
+  return *(guint32 *) (data + y * stride + x * 4);
+}
+
+static void
+test_background_cache (void)
+{
+  GtkStyleContext *context1, *context2;
+  GtkWidgetPath *path;
+  GtkCssProvider *provider;
+  cairo_surface_t *surface1, *surface2;
+  GError *error;
+  int i;
+
+  error = NULL;
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider,
+                                   "GtkButton { border-radius: 0;\n"
+                                   "            box-shadow: none;\n"
+                                   "            background-color: transparent;\n"
+                                   "            background-image: -gtk-gradient (linear, left top, right top,\n"
+                                   "                                             from (#f00), to (#00f)); }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_WINDOW);
+  gtk_widget_path_append_type (path, GTK_TYPE_BUTTON);
+
+  context1 = gtk_style_context_new ();
+  gtk_style_context_set_path (context1, path);
+  context2 = gtk_style_context_new ();
+  gtk_style_context_set_path (context2, path);
+  gtk_widget_path_free (path);
+
+  /* Contexts sharing their values get the same background */
+  surface1 = render_background (context1, 50, 20);
+  surface2 = render_background (context2, 50, 20);
+  for (i = 0; i < 50; i++)
+    g_assert_cmphex (get_pixel (surface1, i, 10), ==, get_pixel (surface2, i, 10));
+  g_assert_cmphex ((get_pixel (surface1, 0, 10) >> 16) & 0xff, >, 0xf0);
+  g_assert_cmphex (get_pixel (surface1, 49, 10) & 0xff, >, 0xf0);
+  cairo_surface_destroy (surface1);
+  cairo_surface_destroy (surface2);
+
+  /* Other sizes are rendered again, not stretched */
+  surface1 = render_background (context1, 100, 20);
+  g_assert_cmphex ((get_pixel (surface1, 0, 10) >> 16) & 0xff, >, 0xf0);
+  g_assert_cmphex (get_pixel (surface1, 99, 10) & 0xff, >, 0xf0);
+  g_assert_cmphex ((get_pixel (surface1, 49, 10) >> 16) & 0xff, >, 0x70);
+  cairo_surface_destroy (surface1);
+
+  /* Changing the style must not reuse the old background */
+  gtk_css_provider_load_from_data (provider,
+                                   "GtkButton { border-radius: 0;\n"
+                                   "            box-shadow: none;\n"
+                                   "            background-color: transparent;\n"
+                                   "            background-image: -gtk-gradient (linear, left top, right top,\n"
+                                   "                                             from (#0f0), to (#0f0)); }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context1);
+
+  surface1 = render_background (context1, 50, 20);
+  g_assert_cmphex (get_pixel (surface1, 0, 10), ==, 0xff00ff00);
+  g_assert_cmphex (get_pixel (surface1, 49, 10), ==, 0xff00ff00);
+  cairo_surface_destroy (surface1);
+
+  gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
+                                                GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+  g_object_unref (context1);
+  g_object_unref (context2);
+}
+
+static void
+assert_widget_color (GtkWidget   *widget,
+                     const gchar *spec)
+{
+  GtkStyleContext *context;
+  GdkRGBA color, expected;
+
+  context = gtk_widget_get_style_context (widget);
+  gtk_style_context_get_color (context, gtk_widget_get_state_flags (widget), &color);
+  gdk_rgba_parse (&expected, spec);
+  g_assert (gdk_rgba_equal (&color, &expected));
+}
+
+static void
+test_descendant_restyle (void)
+{
+  GtkCssProvider *provider;
+  GtkWidget *window, *box, *label, *event_box, *nested, *other_box, *other;
+  GError *error;
+
+  error = NULL;
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider,
+                                   "GtkLabel { color: #f00 }\n"
+                                   "GtkBox.test:prelight GtkLabel { color: #0f0 }",
+                                   -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  /* window
+   * +- other_box
+   * |  +- other
+   * +- box.test
+   *    +- label
+   *    +- event_box
+   *       +- nested
+   */
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  other_box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_style_context_add_class (gtk_widget_get_style_context (box), "test");
+  label = gtk_label_new ("child");
+  event_box = gtk_event_box_new ();
+  nested = gtk_label_new ("grandchild");
+  other = gtk_label_new ("other");
+
+  gtk_container_add (GTK_CONTAINER (window), other_box);
+  gtk_container_add (GTK_CONTAINER (other_box), other);
+  gtk_container_add (GTK_CONTAINER (other_box), box);
+  gtk_container_add (GTK_CONTAINER (box), label);
+  gtk_container_add (GTK_CONTAINER (box), event_box);
+  gtk_container_add (GTK_CONTAINER (event_box), nested);
+  gtk_widget_show_all (window);
+  gtk_test_widget_wait_for_draw (window);
+
+  assert_widget_color (label, "#f00");
+  assert_widget_color (nested, "#f00");
+  assert_widget_color (other, "#f00");
+
+  /* Restyling for the state of the box must not skip the labels
+   * below it, whose color depends on that state */
+  gtk_widget_set_state_flags (box, GTK_STATE_FLAG_PRELIGHT, FALSE);
+  gtk_test_widget_wait_for_draw (window);
+
+  assert_widget_color (label, "#0f0");
+  assert_widget_color (nested, "#0f0");
+  assert_widget_color (other, "#f00");
+
+  gtk_widget_unset_state_flags (box, GTK_STATE_FLAG_PRELIGHT);
+  gtk_test_widget_wait_for_draw (window);
+
+  assert_widget_color (label, "#f00");
+  assert_widget_color (nested, "#f00");
+
+  /* Same for the state of an ancestor that didn't have any children
+   * caring about it before */
+  gtk_style_context_remove_class (gtk_widget_get_style_context (box), "test");
+  gtk_style_context_add_class (gtk_widget_get_style_context (other_box), "test");
+  gtk_test_widget_wait_for_draw (window);
+  gtk_widget_set_state_flags (other_box, GTK_STATE_FLAG_PRELIGHT, FALSE);
+  gtk_test_widget_wait_for_draw (window);
+
+  assert_widget_color (other, "#0f0");
+  assert_widget_color (nested, "#0f0");
+
+  gtk_widget_destroy (window);
+  gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
+                                                GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -352,8 +757,13 @@ main (int argc, char *argv[])
   g_test_add_func ("/style/parse/selectors", test_parse_selectors);
   g_test_add_func ("/style/path", test_path);
   g_test_add_func ("/style/match", test_match);
+  g_test_add_func ("/style/match/descendant", test_match_descendant);
   g_test_add_func ("/style/style-property", test_style_property);
   g_test_add_func ("/style/basic", test_basic_properties);
+  g_test_add_func ("/style/shared-values", test_shared_values);
+  g_test_add_func ("/style/shared-values/reload", test_shared_values_reload);
+  g_test_add_func ("/style/background-cache", test_background_cache);
+  g_test_add_func ("/style/descendant-restyle", test_descendant_restyle);
 
   return g_test_run ();
 }
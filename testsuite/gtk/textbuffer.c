@@ -1299,6 +1299,159 @@ test_fill_empty (void)
   g_object_unref (buffer);
 }
 
+static gboolean
+append_chunk (const gchar *text,
+              gsize        len,
+              gpointer     user_data)
+{
+  GString *str = user_data;
+
+  g_string_append_len (str, text, len);
+
+  return str->len < 16;
+}
+
+static void
+test_foreach_chunk (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *invisible;
+  GtkTextIter start, end;
+  GdkPixbuf *pixbuf;
+  GOutputStream *stream;
+  GString *str;
+  gchar *text;
+  gboolean res;
+  GError *error = NULL;
+
+  buffer = gtk_text_buffer_new (NULL);
+  invisible = gtk_text_buffer_create_tag (buffer, NULL, "invisible", TRUE, NULL);
+
+  gtk_text_buffer_set_text (buffer, "First line\nSecond line\n\303\200 third", -1);
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 6);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 11);
+  gtk_text_buffer_apply_tag (buffer, invisible, &start, &end);
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, 1, 1);
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  gtk_text_buffer_insert_pixbuf (buffer, &start, pixbuf);
+  g_object_unref (pixbuf);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+
+  /* The callback stops the iteration past 16 bytes */
+  str = g_string_new (NULL);
+  res = gtk_text_buffer_foreach_chunk (buffer, &start, &end, TRUE,
+                                       append_chunk, str);
+  g_assert (!res);
+  g_assert_cmpuint (str->len, >=, 16);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert (strncmp (text, str->str, str->len) == 0);
+  g_free (text);
+  g_string_free (str, TRUE);
+
+  stream = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+  res = gtk_text_buffer_write_to_stream (buffer, &start, &end, FALSE,
+                                         stream, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (res);
+  g_assert (g_output_stream_write (stream, "", 1, NULL, NULL) == 1);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, FALSE);
+  g_assert_cmpstr (text, ==,
+                   g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (stream)));
+  g_assert_cmpstr (text, ==, "First Second line\n\303\200 third");
+  g_free (text);
+  g_object_unref (stream);
+
+  g_object_unref (buffer);
+}
+
+static void
+count_insertions (GtkTextBuffer *buffer,
+                  GtkTextIter   *iter,
+                  const gchar   *text,
+                  gint           len,
+                  gint          *n_insertions)
+{
+  (*n_insertions)++;
+}
+
+static void
+count_user_actions (GtkTextBuffer *buffer,
+                    gint          *n_user_actions)
+{
+  (*n_user_actions)++;
+}
+
+static void
+check_in_user_action (GtkTextBuffer *buffer,
+                      GtkTextIter   *start,
+                      GtkTextIter   *end,
+                      gint          *n_user_actions)
+{
+  g_assert_cmpint (*n_user_actions, ==, 1);
+}
+
+static void
+test_append_lines (void)
+{
+  const gchar *lines[] = { "one", "two", "three", "four", NULL };
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+  gint n_insertions = 0;
+  gint n_begins = 0, n_ends = 0;
+  gchar *text;
+
+  buffer = gtk_text_buffer_new (NULL);
+  g_signal_connect (buffer, "insert-text",
+                    G_CALLBACK (count_insertions), &n_insertions);
+  g_signal_connect (buffer, "begin-user-action",
+                    G_CALLBACK (count_user_actions), &n_begins);
+  g_signal_connect (buffer, "end-user-action",
+                    G_CALLBACK (count_user_actions), &n_ends);
+
+  gtk_text_buffer_append_lines (buffer, lines, 2, 0);
+  gtk_text_buffer_append_lines (buffer, lines + 2, -1, 0);
+  g_assert_cmpint (n_insertions, ==, 2);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 4);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "one\ntwo\nthree\nfour");
+  g_free (text);
+
+  g_assert_cmpint (n_begins, ==, 2);
+  g_assert_cmpint (n_ends, ==, 2);
+
+  /* Drop the oldest lines beyond the cap, in the same user action */
+  n_begins = n_ends = 0;
+  g_signal_connect (buffer, "delete-range",
+                    G_CALLBACK (check_in_user_action), &n_begins);
+  gtk_text_buffer_append_lines (buffer, lines, 1, 4);
+  g_assert_cmpint (n_begins, ==, 1);
+  g_assert_cmpint (n_ends, ==, 1);
+  g_signal_handlers_disconnect_by_func (buffer, check_in_user_action, &n_begins);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "two\nthree\nfour\none");
+  g_free (text);
+
+  /* A batch larger than the cap only keeps its last lines */
+  gtk_text_buffer_append_lines (buffer, lines, -1, 2);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 2);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "three\nfour");
+  g_free (text);
+
+  /* An empty last line is reused */
+  gtk_text_buffer_set_text (buffer, "zero\n", -1);
+  gtk_text_buffer_append_lines (buffer, lines, 1, 0);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "zero\none");
+  g_free (text);
+
+  g_object_unref (buffer);
+}
+
 static void
 test_tag (void)
 {
@@ -1336,6 +1489,8 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Get and Set", test_get_set);
   g_test_add_func ("/TextBuffer/Fill and Empty", test_fill_empty);
   g_test_add_func ("/TextBuffer/Tag", test_tag);
+  g_test_add_func ("/TextBuffer/Foreach chunk", test_foreach_chunk);
+  g_test_add_func ("/TextBuffer/Append lines", test_append_lines);
   
   return g_test_run();
 }
@@ -175,6 +175,17 @@ test_search (void)
   check_found_backward ("This is some foo\nfoo text", "foo\nfoo", 0, 13, 20, "foo\nfoo");
   check_not_found ("This is some foo\nfoo text", "Foo\nfoo", 0);
 
+  /* needle ending with the line terminator */
+  check_found_forward ("This is some foo\nfoo text", "foo\n", 0, 13, 17, "foo\n");
+  check_found_backward ("This is some foo\nfoo text", "foo\n", 0, 13, 17, "foo\n");
+  check_found_forward ("This is some Foo\nfoo text", "foo\n",
+                       GTK_TEXT_SEARCH_CASE_INSENSITIVE, 13, 17, "Foo\n");
+  check_found_backward ("This is some Foo\nfoo text", "foo\n",
+                        GTK_TEXT_SEARCH_CASE_INSENSITIVE, 13, 17, "Foo\n");
+  check_found_forward ("foo\r\nbar", "foo\r\n", 0, 0, 5, "foo\r\n");
+  check_found_backward ("foo\r\nbar", "foo\r\n", 0, 0, 5, "foo\r\n");
+  check_not_found ("This is some\ntext foo", "foo\n", 0);
+
   /* check also that different composition of utf8 characters
      (e.g. accented letters) match */
 
@@ -267,6 +278,80 @@ test_search_caseless (void)
   check_found_backward ("This is some \303\200\n\303\200 text", "a\314\200\na\314\200", flags, 13, 16, "\303\200\n\303\200");
 }
 
+static void
+check_found_all (const gchar        *haystack,
+                 const gchar        *needle,
+                 GtkTextSearchFlags  flags,
+                 const gint         *expected_offsets,
+                 guint               n_expected)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter start;
+  GArray *matches;
+  guint i;
+
+  buffer = gtk_text_buffer_new (NULL);
+
+  gtk_text_buffer_set_text (buffer, haystack, -1);
+
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  matches = gtk_text_iter_forward_search_all (&start, needle, flags, NULL);
+  g_assert_cmpuint (matches->len, ==, n_expected);
+  for (i = 0; i < matches->len; i++)
+    g_assert_cmpint (gtk_text_iter_get_offset (&g_array_index (matches, GtkTextIter, i)),
+                     ==, expected_offsets[i]);
+  g_array_unref (matches);
+
+  g_object_unref (buffer);
+}
+
+static void
+test_search_all (void)
+{
+  const gint simple[] = { 0, 3, 8, 11, 12, 15 };
+  const gint overlapping[] = { 0, 2, 2, 4 };
+  const gint caseless[] = { 5, 8, 9, 12, 13, 16, 17, 18 };
+  const gint lines[] = { 2, 7 };
+  const gint line_ends[] = { 0, 3, 3, 6 };
+
+  check_found_all ("foo bar foo\nfoo", "foo", 0, simple, G_N_ELEMENTS (simple));
+  check_found_all ("aaaaa", "aa", 0, overlapping, G_N_ELEMENTS (overlapping));
+  check_found_all ("aaaaa", "b", 0, NULL, 0);
+  check_found_all ("Some Foo foo\nFOO \303\200", "foo", GTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                   caseless, 6);
+  check_found_all ("Some Foo foo\nFOO \303\200", "\303\240", GTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                   caseless + 6, 2);
+  check_found_all ("ab\ncd\nef", "\ncd\ne", 0, lines, G_N_ELEMENTS (lines));
+  check_found_all ("ab\nab\nab", "ab\n", 0, line_ends, G_N_ELEMENTS (line_ends));
+}
+
+static void
+test_search_long_needle (void)
+{
+  GString *haystack;
+  gint i;
+
+  /* Exercise the skip tables with needles sharing prefixes and
+   * suffixes with the text around them.
+   */
+  haystack = g_string_new (NULL);
+  for (i = 0; i < 200; i++)
+    g_string_append (haystack, "abcabdabe");
+  g_string_append (haystack, "abcabdabf");
+  g_string_append (haystack, "\nabcabdabe");
+
+  check_found_forward (haystack->str, "abdabf", 0, 1803, 1809, "abdabf");
+  check_found_backward (haystack->str, "abdabf", 0, 1803, 1809, "abdabf");
+  check_found_forward (haystack->str, "ABDABF", GTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                       1803, 1809, "abdabf");
+  check_found_backward (haystack->str, "ABCABDABF", GTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                        1800, 1809, "abcabdabf");
+  check_found_backward (haystack->str, "cabdabe", 0, 1812, 1819, "cabdabe");
+  check_not_found (haystack->str, "abdabg", 0);
+
+  g_string_free (haystack, TRUE);
+}
+
 static void
 test_forward_to_tag_toggle (void)
 {
@@ -327,6 +412,8 @@ main (int argc, char** argv)
   g_test_add_func ("/TextIter/Search Full Buffer", test_full_buffer);
   g_test_add_func ("/TextIter/Search", test_search);
   g_test_add_func ("/TextIter/Search Caseless", test_search_caseless);
+  g_test_add_func ("/TextIter/Search All", test_search_all);
+  g_test_add_func ("/TextIter/Search Long Needle", test_search_long_needle);
   g_test_add_func ("/TextIter/Forward To Tag Toggle", test_forward_to_tag_toggle);
 
   return g_test_run();
@@ -0,0 +1,236 @@
+/* GtkTextView tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+static GtkWidget *
+create_view (GtkTextBuffer *buffer,
+             gboolean       threaded)
+{
+  GtkWidget *window, *view;
+
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 300, 300);
+
+  view = gtk_text_view_new_with_buffer (buffer);
+  gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (view), GTK_WRAP_WORD);
+  gtk_text_view_set_threaded_validation (GTK_TEXT_VIEW (view), threaded);
+
+  gtk_container_add (GTK_CONTAINER (window), view);
+  gtk_widget_show_all (window);
+
+  return view;
+}
+
+static gboolean
+timeout_cb (gpointer data)
+{
+  gboolean *timed_out = data;
+
+  *timed_out = TRUE;
+
+  return FALSE;
+}
+
+static void
+test_threaded_validation (void)
+{
+  GtkTextBuffer *buffer;
+  GtkWidget *view, *threaded_view;
+  GtkAdjustment *vadj, *threaded_vadj;
+  GString *text;
+  gboolean timed_out = FALSE;
+  guint timeout_id;
+  gint i;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < 5000; i++)
+    g_string_append_printf (text, "Line %d of a text long enough to be wrapped "
+                            "over more than one line of the view %d\n", i, i * i);
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, text->str, text->len);
+  g_string_free (text, TRUE);
+
+  view = create_view (buffer, FALSE);
+  threaded_view = create_view (buffer, TRUE);
+  g_assert (!gtk_text_view_get_threaded_validation (GTK_TEXT_VIEW (view)));
+
+  /* The setting only sticks if Pango is thread-safe */
+  if (pango_version () >= PANGO_VERSION_ENCODE (1, 32, 6))
+    g_assert (gtk_text_view_get_threaded_validation (GTK_TEXT_VIEW (threaded_view)));
+  else
+    g_assert (!gtk_text_view_get_threaded_validation (GTK_TEXT_VIEW (threaded_view)));
+
+  vadj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (view));
+  threaded_vadj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (threaded_view));
+
+  /* Once all the results from the worker threads are merged, both
+   * views must agree on the size of the text.
+   */
+  timeout_id = g_timeout_add_seconds (30, timeout_cb, &timed_out);
+  while (!timed_out &&
+         (gtk_events_pending () ||
+          gtk_adjustment_get_upper (vadj) != gtk_adjustment_get_upper (threaded_vadj)))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (!timed_out);
+  g_source_remove (timeout_id);
+
+  gtk_widget_destroy (gtk_widget_get_toplevel (view));
+  gtk_widget_destroy (gtk_widget_get_toplevel (threaded_view));
+  g_object_unref (buffer);
+}
+
+static GtkWidget *
+create_scrolled_view (GtkTextBuffer *buffer)
+{
+  GtkWidget *window, *sw, *view;
+
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 300, 300);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+
+  view = gtk_text_view_new_with_buffer (buffer);
+  gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (view), GTK_WRAP_WORD);
+  gtk_container_add (GTK_CONTAINER (sw), view);
+
+  gtk_widget_show_all (window);
+  gtk_test_widget_wait_for_draw (window);
+
+  return view;
+}
+
+static void
+check_same_layout (GtkTextView *view,
+                   GtkTextView *reference,
+                   gint         n_lines)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter iter;
+  GdkRectangle rect, reference_rect;
+  gint y, height, reference_y, reference_height;
+  gint i;
+
+  buffer = gtk_text_view_get_buffer (view);
+
+  for (i = 0; i < n_lines; i++)
+    {
+      gtk_text_buffer_get_iter_at_line (buffer, &iter, i);
+      gtk_text_view_get_line_yrange (view, &iter, &y, &height);
+      gtk_text_view_get_line_yrange (reference, &iter, &reference_y, &reference_height);
+      g_assert_cmpint (y, ==, reference_y);
+      g_assert_cmpint (height, ==, reference_height);
+
+      if (!gtk_text_iter_ends_line (&iter))
+        gtk_text_iter_forward_to_line_end (&iter);
+      gtk_text_view_get_iter_location (view, &iter, &rect);
+      gtk_text_view_get_iter_location (reference, &iter, &reference_rect);
+      g_assert_cmpint (rect.x, ==, reference_rect.x);
+      g_assert_cmpint (rect.y, ==, reference_rect.y);
+    }
+}
+
+static void
+test_evicted_line_displays (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkWidget *view, *reference;
+  GtkAdjustment *vadj;
+  GtkTextIter start, end;
+  GString *text;
+  gdouble value;
+  gint y, height, short_height;
+  gint i;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < 1000; i++)
+    g_string_append_printf (text, "Line %d\n", i);
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, text->str, text->len);
+  g_string_free (text, TRUE);
+  tag = gtk_text_buffer_create_tag (buffer, NULL, "scale", 2.0, NULL);
+
+  view = create_scrolled_view (buffer);
+  vadj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (view));
+  g_assert_cmpfloat (gtk_adjustment_get_page_size (vadj), >, 0);
+
+  /* Scroll through many more lines than the line display cache
+   * holds, so the displays of the first lines get evicted.
+   */
+  for (value = 0;
+       value < gtk_adjustment_get_upper (vadj) - gtk_adjustment_get_page_size (vadj);
+       value += gtk_adjustment_get_page_size (vadj) / 2)
+    {
+      gtk_adjustment_set_value (vadj, value);
+      gtk_test_widget_wait_for_draw (gtk_widget_get_toplevel (view));
+    }
+  g_assert_cmpint (gtk_adjustment_get_value (vadj), >, 0);
+
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 0);
+  gtk_text_view_get_line_yrange (GTK_TEXT_VIEW (view), &start, &y, &short_height);
+
+  /* Make line 5 wrap */
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 5);
+  gtk_text_iter_forward_to_line_end (&end);
+  gtk_text_buffer_insert (buffer, &end,
+                          " is now long enough to be wrapped over more than "
+                          "one line of the view, and then some more", -1);
+
+  /* Delete line 10 */
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 10);
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 11);
+  gtk_text_buffer_delete (buffer, &start, &end);
+
+  /* Make line 20 taller */
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 20);
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 21);
+  gtk_text_buffer_apply_tag (buffer, tag, &start, &end);
+
+  gtk_adjustment_set_value (vadj, 0);
+  gtk_test_widget_wait_for_draw (gtk_widget_get_toplevel (view));
+
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 5);
+  gtk_text_view_get_line_yrange (GTK_TEXT_VIEW (view), &start, &y, &height);
+  g_assert_cmpint (height, >, short_height);
+
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 20);
+  gtk_text_view_get_line_yrange (GTK_TEXT_VIEW (view), &start, &y, &height);
+  g_assert_cmpint (height, >, short_height);
+
+  /* A view that never scrolled lays the edited lines out the same */
+  reference = create_scrolled_view (buffer);
+  check_same_layout (GTK_TEXT_VIEW (view), GTK_TEXT_VIEW (reference), 40);
+
+  gtk_widget_destroy (gtk_widget_get_toplevel (view));
+  gtk_widget_destroy (gtk_widget_get_toplevel (reference));
+  g_object_unref (buffer);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/TextView/threaded-validation", test_threaded_validation);
+  g_test_add_func ("/TextView/evicted-line-displays", test_evicted_line_displays);
+
+  return g_test_run ();
+}
@@ -226,6 +226,444 @@ test_row_separator_height (void)
   gtk_widget_destroy (tree_view);
 }
 
+static gint
+get_row_height (GtkTreeView *tree_view,
+                gint         row)
+{
+  GtkTreePath *path;
+  GdkRectangle rect;
+
+  path = gtk_tree_path_new_from_indices (row, -1);
+  gtk_tree_view_get_background_area (tree_view, path, NULL, &rect);
+  gtk_tree_path_free (path);
+
+  return rect.height;
+}
+
+static void
+test_estimated_row_height (void)
+{
+  GtkListStore *store;
+  GtkWidget *window, *sw, *tree_view;
+  GtkCellRenderer *cell;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  gint vertical_separator;
+  gint i;
+
+  /* A few small rows followed by many tall ones, so the rows that
+   * are not measured yet start out with a height that is too small.
+   */
+  store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
+  for (i = 0; i < 2000; i++)
+    gtk_list_store_insert_with_values (store, &iter, i,
+                                       0, "Row content",
+                                       1, i < 10 ? 20 : 60,
+                                       -1);
+
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 200, 200);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+
+  tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  cell = gtk_cell_renderer_text_new ();
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view),
+                                               0, "Test", cell,
+                                               "text", 0,
+                                               "height", 1,
+                                               NULL);
+  gtk_container_add (GTK_CONTAINER (sw), tree_view);
+  gtk_widget_show_all (window);
+  gtk_test_widget_wait_for_draw (window);
+
+  gtk_widget_style_get (tree_view,
+                        "vertical-separator", &vertical_separator,
+                        NULL);
+
+  g_assert_cmpint (get_row_height (GTK_TREE_VIEW (tree_view), 0), ==, 20 + vertical_separator);
+  g_assert_cmpint (get_row_height (GTK_TREE_VIEW (tree_view), 1999), >, 0);
+
+  /* Once the last rows are scrolled into view they get their real height */
+  path = gtk_tree_path_new_from_indices (1999, -1);
+  gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (tree_view), path, NULL, FALSE, 0.0, 0.0);
+  gtk_tree_path_free (path);
+  gtk_test_widget_wait_for_draw (window);
+
+  for (i = 1995; i < 2000; i++)
+    g_assert_cmpint (get_row_height (GTK_TREE_VIEW (tree_view), i), ==, 60 + vertical_separator);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+static void
+check_rows_contiguous (GtkTreeView *tree_view,
+                       gint         n_rows)
+{
+  GtkTreePath *path;
+  GdkRectangle rect;
+  gint i, y = 0;
+
+  for (i = 0; i < n_rows; i++)
+    {
+      path = gtk_tree_path_new_from_indices (i, -1);
+      gtk_tree_view_get_background_area (tree_view, path, NULL, &rect);
+      gtk_tree_path_free (path);
+
+      g_assert_cmpint (rect.height, >, 0);
+      if (i > 0)
+        g_assert_cmpint (rect.y, ==, y);
+      y = rect.y + rect.height;
+    }
+
+  g_assert_cmpint (get_row_height (tree_view, n_rows), ==, 0);
+}
+
+static void
+check_cursor (GtkTreeView *tree_view,
+              gint         row)
+{
+  GtkTreePath *path;
+
+  gtk_tree_view_get_cursor (tree_view, &path, NULL);
+  g_assert (path != NULL);
+  g_assert_cmpint (gtk_tree_path_get_indices (path)[0], ==, row);
+  gtk_tree_path_free (path);
+}
+
+static void
+test_bulk_update (void)
+{
+  GtkListStore *store;
+  GtkWidget *window, *sw, *tree_view;
+  GtkTreePath *path;
+  GValue values[100] = { G_VALUE_INIT, };
+  gint columns[] = { 0 };
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < 20; i++)
+    gtk_list_store_insert_with_values (store, NULL, i, 0, "Row content", -1);
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    {
+      g_value_init (&values[i], G_TYPE_STRING);
+      g_value_set_string (&values[i], i % 7 ? "Bulk row" : "Bulk\nrow");
+    }
+
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 200, 200);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+
+  tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view),
+                                               0, "Test",
+                                               gtk_cell_renderer_text_new (),
+                                               "text", 0,
+                                               NULL);
+  gtk_container_add (GTK_CONTAINER (sw), tree_view);
+  gtk_widget_show_all (window);
+  gtk_test_widget_wait_for_draw (window);
+
+  path = gtk_tree_path_new_from_indices (10, -1);
+  gtk_tree_view_set_cursor (GTK_TREE_VIEW (tree_view), path, NULL, FALSE);
+  gtk_tree_path_free (path);
+
+  /* Rows inserted in front of the cursor move it along */
+  gtk_list_store_insert_rows (store, 5, 100, columns, values, 1);
+  gtk_test_widget_wait_for_draw (window);
+  check_rows_contiguous (GTK_TREE_VIEW (tree_view), 120);
+  check_cursor (GTK_TREE_VIEW (tree_view), 110);
+
+  gtk_list_store_insert_rows (store, 0, 3, columns, values, 1);
+  gtk_list_store_insert_rows (store, -1, 3, columns, values, 1);
+  gtk_test_widget_wait_for_draw (window);
+  check_rows_contiguous (GTK_TREE_VIEW (tree_view), 126);
+  check_cursor (GTK_TREE_VIEW (tree_view), 113);
+
+  gtk_list_store_replace_rows (store, 100, 20, 50, columns, values, 1);
+  gtk_test_widget_wait_for_draw (window);
+  check_rows_contiguous (GTK_TREE_VIEW (tree_view), 156);
+
+  gtk_list_store_remove_rows (store, 8, 100);
+  gtk_test_widget_wait_for_draw (window);
+  check_rows_contiguous (GTK_TREE_VIEW (tree_view), 56);
+
+  gtk_list_store_remove_rows (store, 0, -1);
+  gtk_test_widget_wait_for_draw (window);
+  check_rows_contiguous (GTK_TREE_VIEW (tree_view), 0);
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    g_value_unset (&values[i]);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+static GtkWidget *
+create_threaded_view (GtkTreeModel *model,
+                      gboolean      threaded)
+{
+  GtkWidget *window, *sw, *tree_view;
+  gint i;
+
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 200, 200);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+
+  tree_view = gtk_tree_view_new_with_model (model);
+  gtk_tree_view_set_threaded_validation (GTK_TREE_VIEW (tree_view), threaded);
+  for (i = 0; i < 2; i++)
+    gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view),
+                                                 i, "Test",
+                                                 gtk_cell_renderer_text_new (),
+                                                 "text", i,
+                                                 NULL);
+  gtk_container_add (GTK_CONTAINER (sw), tree_view);
+  gtk_widget_show_all (window);
+
+  return tree_view;
+}
+
+static gboolean
+row_heights_match (GtkTreeView *tree_view,
+                   GtkTreeView *other,
+                   gint         n_rows)
+{
+  gint i;
+
+  for (i = 0; i < n_rows; i++)
+    if (get_row_height (tree_view, i) != get_row_height (other, i))
+      return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+timeout_cb (gpointer data)
+{
+  gboolean *timed_out = data;
+
+  *timed_out = TRUE;
+
+  return FALSE;
+}
+
+/* Once all the results from the worker threads are merged, both
+ * views must agree on the size of every row.
+ */
+static void
+wait_for_row_heights (GtkWidget *tree_view,
+                      GtkWidget *other,
+                      gint       n_rows)
+{
+  gboolean timed_out = FALSE;
+  guint timeout_id;
+
+  timeout_id = g_timeout_add_seconds (60, timeout_cb, &timed_out);
+  while (!timed_out &&
+         (gtk_events_pending () ||
+          !row_heights_match (GTK_TREE_VIEW (tree_view), GTK_TREE_VIEW (other), n_rows)))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (!timed_out);
+  g_source_remove (timeout_id);
+}
+
+static void
+test_threaded_validation (void)
+{
+  GtkListStore *store;
+  GtkWidget *tree_view, *threaded_view;
+  GtkTreeIter iter;
+  gint width, threaded_width;
+  gchar *text;
+  gint i;
+
+  /* Some rows are taller and wider than the others, so rows that were
+   * only given the estimated height don't match the measured ones.
+   */
+  store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_STRING);
+  for (i = 0; i < 5000; i++)
+    {
+      if (i % 97 == 13)
+        text = g_strdup_printf ("Row %d\nwith a second line that is a lot longer", i);
+      else
+        text = g_strdup_printf ("Row %d", i);
+
+      gtk_list_store_insert_with_values (store, &iter, i,
+                                         0, text,
+                                         1, i % 5 ? "Text" : NULL,
+                                         -1);
+      g_free (text);
+    }
+
+  tree_view = create_threaded_view (GTK_TREE_MODEL (store), FALSE);
+  threaded_view = create_threaded_view (GTK_TREE_MODEL (store), TRUE);
+  g_assert (!gtk_tree_view_get_threaded_validation (GTK_TREE_VIEW (tree_view)));
+
+  /* The setting only sticks if Pango is thread-safe */
+  if (pango_version () >= PANGO_VERSION_ENCODE (1, 32, 6))
+    g_assert (gtk_tree_view_get_threaded_validation (GTK_TREE_VIEW (threaded_view)));
+  else
+    g_assert (!gtk_tree_view_get_threaded_validation (GTK_TREE_VIEW (threaded_view)));
+
+  wait_for_row_heights (tree_view, threaded_view, 5000);
+
+  gtk_widget_get_preferred_width (tree_view, &width, NULL);
+  gtk_widget_get_preferred_width (threaded_view, &threaded_width, NULL);
+  g_assert_cmpint (width, ==, threaded_width);
+
+  /* Rows changed later are measured again */
+  gtk_list_store_set (store, &iter, 0, "A last row\nthat is now two lines tall", -1);
+  wait_for_row_heights (tree_view, threaded_view, 5000);
+  g_assert_cmpint (get_row_height (GTK_TREE_VIEW (threaded_view), 4999), >,
+                   get_row_height (GTK_TREE_VIEW (threaded_view), 4998));
+
+  gtk_widget_destroy (gtk_widget_get_toplevel (tree_view));
+  gtk_widget_destroy (gtk_widget_get_toplevel (threaded_view));
+  g_object_unref (store);
+}
+
+/* A list store whose rows are loaded when the view asks for them */
+typedef GtkListStore      TestLoadableStore;
+typedef GtkListStoreClass TestLoadableStoreClass;
+
+static void test_loadable_store_loadable_init (GtkTreeLoadableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestLoadableStore, test_loadable_store, GTK_TYPE_LIST_STORE,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_LOADABLE,
+                                                test_loadable_store_loadable_init))
+
+static gint n_load_rows_calls = 0;
+
+static gboolean
+test_loadable_store_row_is_loaded (GtkTreeLoadable *loadable,
+                                   GtkTreeIter     *iter)
+{
+  gboolean loaded;
+
+  gtk_tree_model_get (GTK_TREE_MODEL (loadable), iter, 1, &loaded, -1);
+
+  return loaded;
+}
+
+static void
+test_loadable_store_load_rows (GtkTreeLoadable *loadable,
+                               GtkTreePath     *start_path,
+                               GtkTreePath     *end_path)
+{
+  GtkTreeIter iter;
+  gint i;
+
+  n_load_rows_calls++;
+
+  for (i = gtk_tree_path_get_indices (start_path)[0];
+       i <= gtk_tree_path_get_indices (end_path)[0];
+       i++)
+    {
+      gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (loadable), &iter, NULL, i);
+      gtk_list_store_set (GTK_LIST_STORE (loadable), &iter,
+                          0, "Row content", 1, TRUE, -1);
+    }
+}
+
+static void
+test_loadable_store_loadable_init (GtkTreeLoadableIface *iface)
+{
+  iface->row_is_loaded = test_loadable_store_row_is_loaded;
+  iface->load_rows = test_loadable_store_load_rows;
+}
+
+static void
+test_loadable_store_class_init (TestLoadableStoreClass *klass)
+{
+}
+
+static void
+test_loadable_store_init (TestLoadableStore *store)
+{
+  GType types[] = { G_TYPE_STRING, G_TYPE_BOOLEAN };
+
+  gtk_list_store_set_column_types (store, G_N_ELEMENTS (types), types);
+}
+
+static void
+test_loadable_cell_data_func (GtkTreeViewColumn *column,
+                              GtkCellRenderer   *cell,
+                              GtkTreeModel      *model,
+                              GtkTreeIter       *iter,
+                              gpointer           data)
+{
+  gchar *text;
+  gboolean loaded;
+
+  gtk_tree_model_get (model, iter, 0, &text, 1, &loaded, -1);
+
+  /* The view must not ask for the contents of unloaded rows */
+  g_assert (loaded);
+
+  g_object_set (cell, "text", text, NULL);
+  g_free (text);
+}
+
+static void
+test_loadable_model (void)
+{
+  GtkTreeModel *model;
+  GtkWidget *window, *tree_view;
+  GtkTreeIter iter;
+  GtkTreePath *path;
+  GdkRectangle rect;
+  gint i;
+
+  model = g_object_new (test_loadable_store_get_type (), NULL);
+  for (i = 0; i < 1000; i++)
+    gtk_list_store_insert_with_values (GTK_LIST_STORE (model), &iter, i,
+                                       1, FALSE, -1);
+
+  g_assert (!gtk_tree_loadable_row_is_loaded (GTK_TREE_LOADABLE (model), &iter));
+
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 200, 200);
+
+  tree_view = gtk_tree_view_new_with_model (model);
+  gtk_tree_view_insert_column_with_data_func (GTK_TREE_VIEW (tree_view),
+                                              0, "Test",
+                                              gtk_cell_renderer_text_new (),
+                                              test_loadable_cell_data_func,
+                                              NULL, NULL);
+
+  gtk_container_add (GTK_CONTAINER (window), tree_view);
+  gtk_widget_show_all (window);
+
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  /* Drawing the unloaded rows asked the model for the visible range */
+  g_assert_cmpint (n_load_rows_calls, >, 0);
+
+  gtk_tree_model_get_iter_first (model, &iter);
+  g_assert (gtk_tree_loadable_row_is_loaded (GTK_TREE_LOADABLE (model), &iter));
+
+  /* Rows far outside the visible range stay unloaded */
+  gtk_tree_model_iter_nth_child (model, &iter, NULL, 999);
+  g_assert (!gtk_tree_loadable_row_is_loaded (GTK_TREE_LOADABLE (model), &iter));
+
+  /* and are sized like the rows measured so far */
+  path = gtk_tree_path_new_from_indices (999, -1);
+  gtk_tree_view_get_background_area (GTK_TREE_VIEW (tree_view),
+                                     path, NULL, &rect);
+  gtk_tree_path_free (path);
+  g_assert_cmpint (rect.height, >, 0);
+
+  gtk_widget_destroy (window);
+  g_object_unref (model);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -238,6 +676,14 @@ main (int    argc,
                    test_select_collapsed_row);
   g_test_add_func ("/TreeView/sizing/row-separator-height",
                    test_row_separator_height);
+  g_test_add_func ("/TreeView/sizing/estimated-row-height",
+                   test_estimated_row_height);
+  g_test_add_func ("/TreeView/loadable/load-visible-rows",
+                   test_loadable_model);
+  g_test_add_func ("/TreeView/sizing/threaded-validation",
+                   test_threaded_validation);
+  g_test_add_func ("/TreeView/sizing/bulk-update",
+                   test_bulk_update);
 
   return g_test_run ();
 }